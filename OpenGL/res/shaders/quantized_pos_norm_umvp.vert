@@ -0,0 +1,44 @@
+#version 330 core
+
+/* Same as pos_norm_umvp.vert, for vertices compressed by MeshQuantizer */
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec2 normal;
+
+out vec3 passFragViewSpacePos;
+out vec3 passNormal;
+out vec3 passLightViewSpacePos;
+
+uniform mat4 u_View;
+uniform mat4 u_ModelView;
+uniform mat4 u_MVP;
+uniform vec3 u_LightPosition;
+uniform vec3 u_DequantOffset;
+uniform vec3 u_DequantScale;
+
+/* Octahedral normal decoding, the lower hemisphere is folded over the upper one */
+vec3 decodeOctahedral(vec2 e)
+{
+	vec3 n = vec3(e.xy, 1.0f - abs(e.x) - abs(e.y));
+	float t = max(-n.z, 0.0f);
+	n.x += n.x >= 0.0f ? -t : t;
+	n.y += n.y >= 0.0f ? -t : t;
+	return normalize(n);
+}
+
+void main()
+{
+	/* Positions are stored in [-1, 1] relative to the mesh bounding box */
+	vec4 posToVec4 = vec4(u_DequantOffset + u_DequantScale * position, 1.0f);
+	gl_Position = u_MVP * posToVec4;
+
+	/* Compute position of the vertex in view space */
+	vec4 fragViewSpacePos = u_ModelView * posToVec4;
+	/* N.B. fragViewSpacePos.w is 1 by construction */
+	passFragViewSpacePos = fragViewSpacePos.xyz;
+
+	/* Transform normal so that it is still ortogonal to the surface */
+	/* N.B. Beware of ill-conditioned matrices */
+	passNormal = mat3(transpose(inverse(u_ModelView))) * decodeOctahedral(normal);
+
+	passLightViewSpacePos = vec3(u_View * vec4(u_LightPosition, 1.0f));
+}
@@ -0,0 +1,17 @@
+#version 330 core
+
+/* Same as texture2D_pos3D.vert, for vertices compressed by MeshQuantizer */
+layout(location = 0) in vec3 position;
+layout(location = 2) in vec2 texCoord;
+
+out vec2 v_TexCoord;
+
+uniform mat4 u_MVP;
+uniform vec3 u_DequantOffset;
+uniform vec3 u_DequantScale;
+
+void main()
+{
+	gl_Position = u_MVP * vec4(u_DequantOffset + u_DequantScale * position, 1.0f);
+	v_TexCoord = texCoord;
+}
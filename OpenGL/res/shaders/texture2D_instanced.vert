@@ -0,0 +1,15 @@
+#version 330 core
+
+layout(location = 0) in vec3 position;
+layout(location = 2) in vec2 texCoord;
+layout(location = 3) in mat4 model;
+
+out vec2 v_TexCoord;
+
+uniform mat4 u_ViewProj;
+
+void main()
+{
+	gl_Position = u_ViewProj * model * vec4(position, 1.0f);
+	v_TexCoord = texCoord;
+}
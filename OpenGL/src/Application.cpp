@@ -22,11 +22,23 @@
 	SOFTWARE.
 */
 #include <iostream>
-#include <mutex>
+#include <chrono>
+#include <string>
+#include <memory>
+#include <cstdlib>
+#include <algorithm>
+#include <atomic>
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
 #include "Camera.h"
+#include "JobSystem.h"
+#include "Framebuffer.h"
+#include "Benchmark.h"
+#include "RenderThread.h"
+#include "InputQueue.h"
+#include "FramePacer.h"
+#include "FrameCapture.h"
 #include "SceneHelloImGui.h"
 #include "SceneClearColor.h"
 #include "SceneHelloTriangle.h"
@@ -35,6 +47,8 @@
 #include "ScenePerspectiveProjection.h"
 #include "SceneCamera.h"
 #include "SceneLight.h"
+#include "SceneVertexQuantization.h"
+#include "SceneStress.h"
 #include "exercises/SceneTwoTriangles.h"
 #include "exercises/SceneMixedTexture.h"
 
@@ -43,6 +57,7 @@
 #include "imgui/imgui_impl_opengl3.h"
 
 void processUserInput(GLFWwindow* window, float deltaTime);
+void processInputEvents();
 void FramebufferSizeCallback(GLFWwindow* window, int width, int height);
 void CursorPosCallback(GLFWwindow* window, double xpos, double ypos);
 void ScrollCallback(GLFWwindow* window, double xoffset, double yoffset);
@@ -50,12 +65,73 @@ void ScrollCallback(GLFWwindow* window, double xoffset, double yoffset);
 static constexpr int WINDOW_WIDTH = 720;
 static constexpr int WINDOW_HEIGHT = 540;
 
+/* Scenes update at this rate whatever the frame rate, the time of slow frames is caught up to MAX_UPDATES_PER_FRAME steps */
+static constexpr double FIXED_UPDATE_STEP = 1.0 / 60.0;
+static constexpr unsigned int MAX_UPDATES_PER_FRAME = 5;
+
+static constexpr unsigned int HEADLESS_FRAMES_DEFAULT = 600;
+static constexpr float HEADLESS_DELTA_TIME_DEFAULT = 1.0f / 60.0f;
+
+/*
+	Command line: [--render-thread] [--pacing vsync|adaptive|uncapped|limited] [--fps N] [--frames-in-flight N] [--scene-cache MB] [--no-prewarm] [--capture path]
+	or --headless "<scene name>" [--frames N] [--delta seconds] [--egl] [--capture path] [--golden prefix] [--tolerance N]
+	or --benchmark [--warmup N] [--frames N] [--delta seconds] [--json path] [--csv path] [--baseline path] [--threshold ratio] [--egl]
+*/
+struct RunOptions
+{
+	bool headless = false;
+	std::string sceneName;
+	unsigned int frames = HEADLESS_FRAMES_DEFAULT;
+	float deltaTime = HEADLESS_DELTA_TIME_DEFAULT;
+	bool useEGL = false;
+	/* Interactive runs only: scenes are updated on the main thread while the previous frame is submitted on another */
+	bool renderThread = false;
+	FramePacer::Mode pacing = FramePacer::VSYNC;
+	float targetFPS = 60.0f;
+	unsigned int maxFramesInFlight = 2;
+	/* Scenes left are kept for the next visit within this budget, 0 deletes them */
+	unsigned int sceneCacheMegabytes = 256;
+	bool prewarm = true;
+	/* Frames written as numbered PNGs with this prefix, or to a Y4M video when it ends in .y4m */
+	std::string capturePath;
+	/* Headless runs only: the PNGs captured are compared with the ones with this prefix */
+	std::string goldenPrefix;
+	int goldenTolerance = 0;
+
+	/* Every registered scene, results written to json and csv, compared with the baseline csv when there is one */
+	bool benchmark = false;
+	unsigned int warmupFrames = Benchmark::Settings().warmupFrames;
+	std::string jsonPath = "benchmark.json";
+	std::string csvPath = "benchmark.csv";
+	std::string baselinePath;
+	float regressionThreshold = Benchmark::Settings().regressionThreshold;
+};
+
+bool ParseRunOptions(int argc, char** argv, RunOptions& options);
+int RunHeadless(scene::SceneMenu& menu, const RunOptions& options);
+int RunBenchmark(scene::SceneMenu& menu, const RunOptions& options);
+bool InterfaceInUse();
+
 Camera MainCamera(glm::vec3(0.0f, 0.0f, 10.0f), (float)WINDOW_WIDTH / (float)WINDOW_HEIGHT);
-std::mutex cameraMutex;
 bool useMainCamera = false;
-
-int main() {
+glm::vec2 cursorPosition(0.0f, 0.0f);
+/* Filled by the window callbacks, emptied by the updates */
+InputQueue inputQueue;
+/* glfwGetTime of the oldest input applied since the last frame was submitted, 0 if none */
+double frameInputTimestamp = 0.0;
+/* Set by the resize callback, which may run while the render thread holds the context, applied once the frame has it */
+std::atomic<int> framebufferWidth(0);
+std::atomic<int> framebufferHeight(0);
+std::atomic<bool> viewportChanged(false);
+
+int main(int argc, char** argv) {
 	GLFWwindow* window;
+	int exitCode = 0;
+
+	RunOptions options;
+	if (!ParseRunOptions(argc, argv, options)) {
+		return -1;
+	}
 
 	/* Initialize glfw library */
 	if (!glfwInit()) {
@@ -67,6 +143,15 @@ int main() {
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
 	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
+	/* Headless runs still need a context: the window exists but is never shown, scenes draw to an offscreen framebuffer */
+	if (options.headless || options.benchmark) {
+		glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	}
+	/* Only the context creation changes, GLFW 3.2 still needs a display for the hidden window */
+	if (options.useEGL) {
+		glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+	}
+
 	/* Create a windowed mode window and its OpenGL context */
 	window = glfwCreateWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "Welcome to OpenGL!", NULL, NULL);
 	if (!window) {
@@ -81,9 +166,6 @@ int main() {
 	/* Set the callback to be invoked when the framebuffer of the specified window is resized */
 	glfwSetFramebufferSizeCallback(window, FramebufferSizeCallback);
 
-	/* Enable v-sync */
-	glfwSwapInterval(1);
-
 	/* Initialize GLAD library */
 	if (!gladLoadGLLoader((GLADloadproc) glfwGetProcAddress)) {
 		std::cout << "Failed to initialize OpenGL context" << std::endl;
@@ -91,6 +173,9 @@ int main() {
 		return -1;
 	}
 
+	/* Start the workers now, the main thread owns the first queue */
+	JobSystem::Get();
+
 	/* Setup Dear ImGui */
 	IMGUI_CHECKVERSION();
 	ImGui::CreateContext();
@@ -118,6 +203,7 @@ int main() {
 		const float r = 0.2f, g = 0.3f, b = 0.8f, a = 1.0f;
 		Camera* const pMainCamera = &MainCamera;
 		bool* const pUseMainCamera = &useMainCamera;
+		const glm::vec2* const pCursorPosition = &cursorPosition;
 		menu->RegisterScene<scene::SceneHelloImGui>(scene::SceneHelloImGui::name);
 		menu->RegisterScene<scene::SceneClearColor>(scene::SceneClearColor::name, r, g, b, a);
 		menu->RegisterScene<scene::SceneHelloTriangle>(scene::SceneHelloTriangle::name);
@@ -125,58 +211,170 @@ int main() {
 		menu->RegisterScene<scene::SceneBasicSquare>(scene::SceneBasicSquare::name);
 		menu->RegisterScene<scene::SceneTexture2D>(scene::SceneTexture2D::name, WINDOW_WIDTH, WINDOW_HEIGHT);
 		menu->RegisterScene<scene::SceneMixedTexture>(scene::SceneMixedTexture::name);
-		menu->RegisterScene<scene::ScenePerspectiveProjection>(scene::ScenePerspectiveProjection::name, WINDOW_WIDTH, WINDOW_HEIGHT);
+		menu->RegisterScene<scene::ScenePerspectiveProjection>(scene::ScenePerspectiveProjection::name, WINDOW_WIDTH, WINDOW_HEIGHT, pCursorPosition);
 		menu->RegisterScene<scene::SceneCamera>(scene::SceneCamera::name, pMainCamera, pUseMainCamera);
 		menu->RegisterScene<scene::SceneLight>(scene::SceneLight::name, pMainCamera, pUseMainCamera);
+		menu->RegisterScene<scene::SceneVertexQuantization>(scene::SceneVertexQuantization::name, WINDOW_WIDTH, WINDOW_HEIGHT);
+		menu->RegisterScene<scene::SceneStress>(scene::SceneStress::name, WINDOW_WIDTH, WINDOW_HEIGHT);
+
+		if (options.benchmark) {
+			exitCode = RunBenchmark(*menu, options);
+		} else if (options.headless) {
+			exitCode = RunHeadless(*menu, options);
+		} else {
+			/* Doubles: a float timestamp loses the milliseconds after a few hours of uptime */
+			double lastFrameTimestamp = glfwGetTime();
+			double accumulator = 0.0;
+
+			/* Scenes are built while the menu is shown, switching to them later is immediate */
+			menu->SetCacheBudget((long long)options.sceneCacheMegabytes * 1024 * 1024);
+			menu->SetPrewarm(options.prewarm);
+
+			/* Sets the swap interval, v-sync by default */
+			FramePacer framePacer(options.pacing, options.targetFPS, options.maxFramesInFlight);
+			ImVec2 pacerPosition(0.0f, menuSize.y);
+
+			/* The whole window, interface included, at the size it has now */
+			std::unique_ptr<FrameCapture> frameCapture;
+			if (!options.capturePath.empty()) {
+				int width, height;
+				glfwGetFramebufferSize(window, &width, &height);
+				const float captureFPS = FramePacer::LIMITED == options.pacing ? options.targetFPS : 60.0f;
+				frameCapture = std::make_unique<FrameCapture>(options.capturePath, width, height, (unsigned int)(captureFPS + 0.5f));
+			}
 
-		float deltaTime = 0.0f;
-		float lastFrameTimestamp = (float)glfwGetTime();
-
-		/* Loop until the user closes the window */
-		while (!glfwWindowShouldClose(window))
-		{
-			float currentFrameTimestamp = (float)glfwGetTime();
-			deltaTime = currentFrameTimestamp - lastFrameTimestamp;
-			lastFrameTimestamp = currentFrameTimestamp;
-
-			/* React to user input */
-			processUserInput(window, deltaTime);
-
-			/* Start the Dear ImGui frame */
-			ImGui_ImplOpenGL3_NewFrame();
-			ImGui_ImplGlfw_NewFrame();
-			ImGui::NewFrame();
+			/* Snapshots alternate: one is recorded while the render thread draws the other */
+			std::unique_ptr<RenderThread> renderThread;
+			FrameSnapshot snapshots[2];
+			unsigned int backSnapshot = 0;
+			if (options.renderThread) {
+				renderThread = std::make_unique<RenderThread>(window);
+			}
 
-			/* Take input from mouse */
+			/* Take input from mouse, after ImGui installed its own callbacks: the scroll one forwards to it */
 			glfwSetCursorPosCallback(window, CursorPosCallback);
 			glfwSetScrollCallback(window, ScrollCallback);
 
-			if (currentScene) {
-				currentScene->OnUpdate(deltaTime);
-				currentScene->OnRender();
+			/* Loop until the user closes the window */
+			while (!glfwWindowShouldClose(window))
+			{
+				framePacer.BeginFrame();
+
+				double currentFrameTimestamp = glfwGetTime();
+				double frameTime = currentFrameTimestamp - lastFrameTimestamp;
+				lastFrameTimestamp = currentFrameTimestamp;
+
+				/* After a long stall the simulation slows down instead of spiraling into ever longer catch-ups */
+				accumulator += std::min(frameTime, MAX_UPDATES_PER_FRAME * FIXED_UPDATE_STEP);
+				unsigned int updatesCount = 0;
+				while (accumulator >= FIXED_UPDATE_STEP) {
+					accumulator -= FIXED_UPDATE_STEP;
+					++updatesCount;
+				}
 
-				ImGui::SetNextWindowPos(menuPosition);
-				ImGui::SetNextWindowSize(menuSize);
+				for (unsigned int update = 0; update < updatesCount; ++update) {
+					/* React to user input */
+					processUserInput(window, (float)FIXED_UPDATE_STEP);
+					if (currentScene) {
+						currentScene->OnUpdate((float)FIXED_UPDATE_STEP);
+					}
+				}
 
-				ImGui::Begin(currentScene->GetName().c_str());
-				if (currentScene != menu && ImGui::Button("Return to Menu")) {
-					delete currentScene;
-					currentScene = menu;
-				} else {
-					currentScene->OnImGuiRender();
+				/* What is left of the accumulator places the frame between the last two updates */
+				const float alpha = (float)(accumulator / FIXED_UPDATE_STEP);
+
+				/* Recorded while the render thread is still drawing the previous snapshot */
+				FrameSnapshot* snapshot = nullptr;
+				if (renderThread) {
+					snapshot = &snapshots[backSnapshot];
+					snapshot->Reset();
+					if (!currentScene || !currentScene->OnSnapshot(*snapshot, alpha)) {
+						snapshot = nullptr;
+					}
+					renderThread->AcquireContext();
+				}
+				if (viewportChanged.exchange(false)) {
+					GLCheckErrorCall(glViewport(0, 0, framebufferWidth.load(), framebufferHeight.load()));
+				}
+				const scene::AbstractScene* snapshotScene = currentScene;
+
+				/* Start the Dear ImGui frame */
+				ImGui_ImplOpenGL3_NewFrame();
+				ImGui_ImplGlfw_NewFrame();
+				ImGui::NewFrame();
+
+				if (currentScene) {
+					/* What the scene allocates or frees is charged to it, the menu cache weighs scenes with it */
+					Renderer::MemoryScope memoryScope(menu->GetActiveMemoryAccount());
+					if (!snapshot) {
+						currentScene->OnRender(alpha);
+					}
+
+					ImGui::SetNextWindowPos(menuPosition);
+					ImGui::SetNextWindowSize(menuSize);
+
+					ImGui::Begin(currentScene->GetName().c_str());
+					if (currentScene != menu && ImGui::Button("Return to Menu")) {
+						menu->ReleaseScene(currentScene);
+						currentScene = menu;
+					} else {
+						currentScene->OnImGuiRender();
+					}
+					ImGui::End();
 				}
-				ImGui::End();
-			}
 
-			/* ImGui Rendering */
-			ImGui::Render();
-			ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+				ImGui::SetNextWindowPos(pacerPosition, ImGuiCond_FirstUseEver);
+				ImGui::SetNextWindowCollapsed(true, ImGuiCond_FirstUseEver);
+				framePacer.OnImGuiRender();
+
+				/* ImGui Rendering */
+				ImGui::Render();
+
+				if (renderThread) {
+					/* The interface may have rebuilt or deleted what the snapshot points to, it is recorded again */
+					if (snapshot && (currentScene != snapshotScene || InterfaceInUse())) {
+						Renderer::MemoryScope memoryScope(menu->GetActiveMemoryAccount());
+						snapshot->Reset();
+						if (!currentScene->OnSnapshot(*snapshot, alpha)) {
+							snapshot = nullptr;
+							currentScene->OnRender(alpha);
+						}
+					}
+					renderThread->ReleaseContext();
+
+					/* ImGui draw data stays valid until the next frame starts, after the render thread is done with it */
+					renderThread->Submit([snapshot, capture = frameCapture.get()]() {
+						if (snapshot) {
+							snapshot->Execute();
+						}
+						ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+						if (capture) {
+							capture->Capture(0);
+						}
+					}, [&framePacer, inputTimestamp = frameInputTimestamp]() {
+						/* Same place as without the render thread: the fence follows the swap */
+						framePacer.EndFrame(inputTimestamp);
+					});
+					backSnapshot = 1 - backSnapshot;
+				} else {
+					ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+					if (frameCapture) {
+						frameCapture->Capture(0);
+					}
+
+					/* Swap front and back buffers */
+					glfwSwapBuffers(window);
+					framePacer.EndFrame(frameInputTimestamp);
+				}
+				frameInputTimestamp = 0.0;
 
-			/* Swap front and back buffers */
-			glfwSwapBuffers(window);
+				/* Poll for and process events */
+				glfwPollEvents();
+			}
 
-			/* Poll for and process events */
-			glfwPollEvents();
+			/* The scenes are deleted on this thread, the context comes back here */
+			renderThread.reset();
+			frameCapture.reset();
 		}
 
 		if (menu != currentScene) {
@@ -199,7 +397,190 @@ int main() {
 	*/
 	glfwTerminate();
 
-	return 0;
+	return exitCode;
+}
+
+bool ParseRunOptions(int argc, char** argv, RunOptions& options)
+{
+	for (int i = 1; i < argc; ++i) {
+		const std::string argument = argv[i];
+		const bool hasValue = i + 1 < argc;
+		if ("--headless" == argument && hasValue) {
+			options.headless = true;
+			options.sceneName = argv[++i];
+		} else if ("--frames" == argument && hasValue) {
+			options.frames = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+		} else if ("--delta" == argument && hasValue) {
+			options.deltaTime = std::strtof(argv[++i], nullptr);
+		} else if ("--egl" == argument) {
+			options.useEGL = true;
+		} else if ("--render-thread" == argument) {
+			options.renderThread = true;
+		} else if ("--pacing" == argument && hasValue) {
+			const std::string mode = argv[++i];
+			if ("vsync" == mode) {
+				options.pacing = FramePacer::VSYNC;
+			} else if ("adaptive" == mode) {
+				options.pacing = FramePacer::ADAPTIVE_VSYNC;
+			} else if ("uncapped" == mode) {
+				options.pacing = FramePacer::UNCAPPED;
+			} else if ("limited" == mode) {
+				options.pacing = FramePacer::LIMITED;
+			} else {
+				std::cout << "Unknown pacing mode " << mode << std::endl;
+				return false;
+			}
+		} else if ("--fps" == argument && hasValue) {
+			options.targetFPS = std::strtof(argv[++i], nullptr);
+		} else if ("--frames-in-flight" == argument && hasValue) {
+			options.maxFramesInFlight = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+		} else if ("--scene-cache" == argument && hasValue) {
+			options.sceneCacheMegabytes = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+		} else if ("--no-prewarm" == argument) {
+			options.prewarm = false;
+		} else if ("--capture" == argument && hasValue) {
+			options.capturePath = argv[++i];
+		} else if ("--golden" == argument && hasValue) {
+			options.goldenPrefix = argv[++i];
+		} else if ("--tolerance" == argument && hasValue) {
+			options.goldenTolerance = std::atoi(argv[++i]);
+		} else if ("--benchmark" == argument) {
+			options.benchmark = true;
+		} else if ("--warmup" == argument && hasValue) {
+			options.warmupFrames = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+		} else if ("--json" == argument && hasValue) {
+			options.jsonPath = argv[++i];
+		} else if ("--csv" == argument && hasValue) {
+			options.csvPath = argv[++i];
+		} else if ("--baseline" == argument && hasValue) {
+			options.baselinePath = argv[++i];
+		} else if ("--threshold" == argument && hasValue) {
+			options.regressionThreshold = std::strtof(argv[++i], nullptr);
+		} else {
+			std::cout << "Unknown argument " << argument << '\n';
+			std::cout << "Usage: " << argv[0] << " [--render-thread] [--pacing vsync|adaptive|uncapped|limited] [--fps N] [--frames-in-flight N]"
+				<< " [--scene-cache MB] [--no-prewarm] [--capture path]\n";
+			std::cout << "       " << argv[0] << " --headless \"<scene name>\" [--frames N] [--delta seconds] [--egl]"
+				<< " [--capture path] [--golden prefix] [--tolerance N]\n";
+			std::cout << "       " << argv[0] << " --benchmark [--warmup N] [--frames N] [--delta seconds] [--json path] [--csv path]"
+				<< " [--baseline path] [--threshold ratio] [--egl]" << std::endl;
+			return false;
+		}
+	}
+	/* Golden images are compared pixel by pixel, a video would have to be decoded first */
+	if (!options.goldenPrefix.empty() && (options.capturePath.empty() || FrameCapture::PNG != FrameCapture::GetFormat(options.capturePath))) {
+		std::cout << "--golden needs PNG frames, give a --capture prefix not ending in .y4m" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+int RunHeadless(scene::SceneMenu& menu, const RunOptions& options)
+{
+	scene::AbstractScene* headlessScene = menu.CreateScene(options.sceneName);
+	if (!headlessScene) {
+		std::cout << "Unknown scene \"" << options.sceneName << "\", the registered ones are:\n";
+		for (const std::string& name : menu.GetSceneNames()) {
+			std::cout << "  " << name << '\n';
+		}
+		std::cout << std::endl;
+		return -1;
+	}
+
+	/* The hidden window may have no pixels at all, scenes draw here instead */
+	Framebuffer framebuffer(WINDOW_WIDTH, WINDOW_HEIGHT);
+	if (!framebuffer.IsComplete()) {
+		std::cout << "Failed to create the offscreen framebuffer" << std::endl;
+		delete headlessScene;
+		return -1;
+	}
+	framebuffer.Bind();
+
+	std::unique_ptr<FrameCapture> frameCapture;
+	if (!options.capturePath.empty()) {
+		const unsigned int captureFPS = options.deltaTime > 0.0f ? (unsigned int)(1.0f / options.deltaTime + 0.5f) : 60;
+		frameCapture = std::make_unique<FrameCapture>(options.capturePath, WINDOW_WIDTH, WINDOW_HEIGHT, captureFPS);
+	}
+
+	auto start = std::chrono::high_resolution_clock::now();
+	for (unsigned int frame = 0; frame < options.frames; ++frame) {
+		/* Scenes animated with glfwGetTime follow the simulated time too, every run renders the same frames */
+		glfwSetTime(frame * (double)options.deltaTime);
+		headlessScene->OnUpdate(options.deltaTime);
+		/* One update per frame, the frame shows exactly the last one */
+		headlessScene->OnRender(1.0f);
+		if (frameCapture) {
+			frameCapture->Capture(framebuffer.GetRendererID());
+		}
+	}
+	/* The last frames are still being read back and written */
+	frameCapture.reset();
+	GLCheckErrorCall(glFinish());
+	auto end = std::chrono::high_resolution_clock::now();
+
+	float milliseconds = std::chrono::duration<float, std::milli>(end - start).count();
+	std::cout << "Headless run of " << options.sceneName << ": " << options.frames << " frames in " << milliseconds << " ms, "
+		<< milliseconds / std::max(1u, options.frames) << " ms/frame" << std::endl;
+
+	delete headlessScene;
+	Framebuffer::Unbind();
+
+	if (options.goldenPrefix.empty()) {
+		return 0;
+	}
+	std::cout << "Comparing with " << options.goldenPrefix << ", tolerance " << options.goldenTolerance << std::endl;
+	unsigned int mismatches = FrameCapture::CompareWithGolden(options.capturePath, options.goldenPrefix, options.frames, options.goldenTolerance);
+	std::cout << mismatches << " frame(s) differ" << std::endl;
+	return mismatches ? 1 : 0;
+}
+
+int RunBenchmark(scene::SceneMenu& menu, const RunOptions& options)
+{
+	/* Read first, the baseline may be the file about to be overwritten */
+	std::vector<BenchmarkResult> baseline;
+	if (!options.baselinePath.empty() && !Benchmark::ReadCSV(options.baselinePath, baseline)) {
+		return -1;
+	}
+
+	Benchmark::Settings settings;
+	settings.warmupFrames = options.warmupFrames;
+	settings.frames = options.frames;
+	settings.deltaTime = options.deltaTime;
+	settings.regressionThreshold = options.regressionThreshold;
+	settings.width = WINDOW_WIDTH;
+	settings.height = WINDOW_HEIGHT;
+
+	Benchmark benchmark(settings, MainCamera, useMainCamera);
+	if (!benchmark.RunAll(menu)) {
+		return -1;
+	}
+	benchmark.WriteJSON(options.jsonPath);
+	benchmark.WriteCSV(options.csvPath);
+
+	if (options.baselinePath.empty()) {
+		return 0;
+	}
+	std::cout << "Comparing with " << options.baselinePath << ", threshold " << options.regressionThreshold * 100.0f << "%" << std::endl;
+	unsigned int regressions = benchmark.CompareWithBaseline(baseline);
+	std::cout << regressions << " scene(s) regressed" << std::endl;
+	return regressions ? 1 : 0;
+}
+
+bool InterfaceInUse()
+{
+	/* Widgets change things while they are held and when they are released, or while they have the keyboard */
+	const ImGuiIO& io = ImGui::GetIO();
+	if (io.WantCaptureKeyboard || ImGui::IsAnyItemActive()) {
+		return true;
+	}
+	if (io.WantCaptureMouse) {
+		for (int button = 0; button < IM_ARRAYSIZE(io.MouseDown); ++button) {
+			if (ImGui::IsMouseDown(button) || ImGui::IsMouseReleased(button)) {
+				return true;
+			}
+		}
+	}
+	return false;
 }
 
 void processUserInput(GLFWwindow* window, float deltaTime) {
@@ -207,8 +588,9 @@ void processUserInput(GLFWwindow* window, float deltaTime) {
 		glfwSetWindowShouldClose(window, true);
 	}
 
+	processInputEvents();
+
 	if (useMainCamera) {
-		cameraMutex.lock();
 		if (GLFW_PRESS == glfwGetKey(window, GLFW_KEY_W)) {
 			MainCamera.ProcessKeyboard(Camera::MovementDirection::FORWARD, deltaTime);
 		}
@@ -221,40 +603,61 @@ void processUserInput(GLFWwindow* window, float deltaTime) {
 		if (GLFW_PRESS == glfwGetKey(window, GLFW_KEY_A)) {
 			MainCamera.ProcessKeyboard(Camera::MovementDirection::LEFT, deltaTime);
 		}
-		cameraMutex.unlock();
+	}
+}
+
+void processInputEvents()
+{
+	static bool cursorKnown = false;
+
+	/* Everything queued since the last update becomes a single change of the camera */
+	glm::vec2 cursorOffset(0.0f, 0.0f);
+	float scrollOffset = 0.0f;
+	InputEvent event;
+	while (inputQueue.Pop(event)) {
+		if (0.0 == frameInputTimestamp) {
+			frameInputTimestamp = event.timestamp;
+		}
+		switch (event.type) {
+		case InputEvent::CURSOR_MOVED:
+			if (cursorKnown) {
+				cursorOffset.x += event.x - cursorPosition.x;
+				cursorOffset.y += cursorPosition.y - event.y; /* Y screen coordinates returned by glfw are reversed */
+			}
+			/* Kept for picking, in window coordinates */
+			cursorPosition = glm::vec2(event.x, event.y);
+			cursorKnown = true;
+			break;
+		case InputEvent::SCROLLED:
+			scrollOffset += event.y;
+			break;
+		}
+	}
+
+	if (useMainCamera) {
+		if (0.0f != cursorOffset.x || 0.0f != cursorOffset.y) {
+			MainCamera.ProcessMouseMovement(cursorOffset.x, cursorOffset.y);
+		}
+		if (0.0f != scrollOffset) {
+			MainCamera.ProcessMouseScroll(scrollOffset);
+		}
 	}
 }
 
 void FramebufferSizeCallback(GLFWwindow* window, int width, int height) {
-	GLCheckErrorCall(glViewport(0, 0, width, height));
+	framebufferWidth.store(width);
+	framebufferHeight.store(height);
+	viewportChanged.store(true);
 }
 
 void CursorPosCallback(GLFWwindow* window, double xpos, double ypos)
 {
-	if (useMainCamera) {
-		float fxpos = (float)xpos;
-		float fypos = (float)ypos;
-		static float lastMouseX = fxpos;
-		static float lastMouseY = fypos;
-
-		float xoffset = fxpos - lastMouseX;
-		float yoffset = -fypos + lastMouseY; /* Y screen coordinates returned by glfw are reversed */
-		lastMouseX = fxpos;
-		lastMouseY = fypos;
-
-		cameraMutex.lock();
-		MainCamera.ProcessMouseMovement(xoffset, yoffset);
-		cameraMutex.unlock();
-	}
+	inputQueue.Push({ InputEvent::CURSOR_MOVED, glfwGetTime(), (float)xpos, (float)ypos });
 }
 
 void ScrollCallback(GLFWwindow* window, double xoffset, double yoffset)
 {
 	ImGui_ImplGlfw_ScrollCallback(window, xoffset, yoffset);
 
-	if (useMainCamera) {
-		cameraMutex.lock();
-		MainCamera.ProcessMouseScroll((float)yoffset);
-		cameraMutex.unlock();
-	}
+	inputQueue.Push({ InputEvent::SCROLLED, glfwGetTime(), (float)xoffset, (float)yoffset });
 }
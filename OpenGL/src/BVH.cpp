@@ -0,0 +1,451 @@
+#include "BVH.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+#include "JobSystem.h"
+
+namespace {
+
+	/* Distance along the ray to the box, or infinity when missed */
+	inline float IntersectRay(const AABB& box, const glm::vec3& origin, const glm::vec3& inverseDirection, float maxDistance)
+	{
+		glm::vec3 t0 = (box.min - origin) * inverseDirection;
+		glm::vec3 t1 = (box.max - origin) * inverseDirection;
+		glm::vec3 tNear = glm::min(t0, t1);
+		glm::vec3 tFar = glm::max(t0, t1);
+		float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+		float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, maxDistance));
+		return enter <= exit ? enter : std::numeric_limits<float>::infinity();
+	}
+
+	enum FrustumTest {
+		OUTSIDE,
+		INTERSECTING,
+		INSIDE
+	};
+
+	inline FrustumTest TestFrustum(const Frustum& frustum, const AABB& box)
+	{
+		glm::vec3 center = box.GetCenter();
+		glm::vec3 extent = box.GetExtent();
+		FrustumTest result = INSIDE;
+		for (const glm::vec4& plane : frustum.planes) {
+			float distance = glm::dot(glm::vec3(plane), center) + plane.w;
+			float projectedExtent = glm::dot(glm::abs(glm::vec3(plane)), extent);
+			if (distance < -projectedExtent) {
+				return OUTSIDE;
+			}
+			if (distance < projectedExtent) {
+				result = INTERSECTING;
+			}
+		}
+		return result;
+	}
+
+	inline bool OverlapsSphere(const AABB& box, const glm::vec3& center, float radius)
+	{
+		glm::vec3 closest = glm::clamp(center, box.min, box.max);
+		glm::vec3 offset = closest - center;
+		return glm::dot(offset, offset) <= radius * radius;
+	}
+
+}
+
+AABB AABB::Empty()
+{
+	const float infinity = std::numeric_limits<float>::infinity();
+	return { glm::vec3(infinity), glm::vec3(-infinity) };
+}
+
+AABB AABB::FromSphere(const glm::vec3& center, float radius)
+{
+	return { center - glm::vec3(radius), center + glm::vec3(radius) };
+}
+
+void AABB::Grow(const glm::vec3& point)
+{
+	min = glm::min(min, point);
+	max = glm::max(max, point);
+}
+
+void AABB::Grow(const AABB& box)
+{
+	min = glm::min(min, box.min);
+	max = glm::max(max, box.max);
+}
+
+float AABB::GetSurfaceArea() const
+{
+	glm::vec3 size = max - min;
+	return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+BVH::BVH() : m_NodesUsed(0), m_NodesCount(0)
+{
+}
+
+void BVH::Build(const std::vector<AABB>& boxes, bool parallel)
+{
+	const unsigned int count = (unsigned int)boxes.size();
+
+	m_References.resize(count);
+	for (unsigned int i = 0; i < count; ++i) {
+		m_References[i] = { boxes[i], boxes[i].GetCenter(), i };
+	}
+
+	/* A binary tree with count leaves has 2 * count - 1 nodes, room is made upfront so jobs never reallocate */
+	m_Nodes.resize(std::max(1u, 2 * count));
+	m_Parents.resize(m_Nodes.size());
+	m_ObjectsLeaves.resize(count);
+	m_ChangedObjects.clear();
+	m_ObjectsChanged.assign(count, 0);
+
+	m_NodesCount = 0;
+	if (0 != count) {
+		m_NodesUsed = 1;
+		m_Parents[0] = 0;
+		BuildNode(0, 0, count, 0, parallel);
+		m_NodesCount = m_NodesUsed;
+	}
+
+	m_Objects.resize(count);
+	m_Boxes.resize(count);
+	m_Slots.resize(count);
+	for (unsigned int i = 0; i < count; ++i) {
+		m_Objects[i] = m_References[i].object;
+		m_Boxes[i] = m_References[i].box;
+		m_Slots[m_Objects[i]] = i;
+	}
+}
+
+void BVH::BuildNode(unsigned int node, unsigned int first, unsigned int count, unsigned int depth, bool parallel)
+{
+	AABB bounds = AABB::Empty();
+	AABB centersBounds = AABB::Empty();
+	for (unsigned int i = first; i < first + count; ++i) {
+		bounds.Grow(m_References[i].box);
+		centersBounds.Grow(m_References[i].center);
+	}
+	m_Nodes[node] = { bounds, first, count, 0 };
+
+	unsigned int leftCount;
+	if (count <= 1 || depth + 1 >= MAX_DEPTH || !FindSplit(first, count, bounds, centersBounds, leftCount)) {
+		for (unsigned int i = first; i < first + count; ++i) {
+			m_ObjectsLeaves[m_References[i].object] = node;
+		}
+		return;
+	}
+
+	/* Children are always allocated after their parent, refitting in reverse order visits children first */
+	unsigned int left = m_NodesUsed.fetch_add(2);
+	m_Parents[left] = node;
+	m_Parents[left + 1] = node;
+	m_Nodes[node].left = left;
+
+	/* The halves touch disjoint ranges of m_References and disjoint nodes */
+	if (parallel && count >= PARALLEL_MIN_OBJECTS) {
+		/* One range per half, the waiting thread builds one while an idle worker steals the other */
+		JobSystem::Get().ParallelFor(2, 1, [&](unsigned int begin, unsigned int end) {
+			for (unsigned int child = begin; child < end; ++child) {
+				if (0 == child) {
+					BuildNode(left, first, leftCount, depth + 1, true);
+				} else {
+					BuildNode(left + 1, first + leftCount, count - leftCount, depth + 1, true);
+				}
+			}
+		});
+	} else {
+		BuildNode(left, first, leftCount, depth + 1, false);
+		BuildNode(left + 1, first + leftCount, count - leftCount, depth + 1, false);
+	}
+}
+
+bool BVH::FindSplit(unsigned int first, unsigned int count, const AABB& bounds, const AABB& centersBounds, unsigned int& leftCount)
+{
+	Reference* references = m_References.data() + first;
+	const glm::vec3 extent = centersBounds.max - centersBounds.min;
+
+	/* Bins of the three axes are filled in the same pass */
+	AABB binsBounds[3][BINS_COUNT];
+	unsigned int binsCounts[3][BINS_COUNT] = {};
+	glm::vec3 binScale;
+	for (int axis = 0; axis < 3; ++axis) {
+		for (AABB& binBounds : binsBounds[axis]) {
+			binBounds = AABB::Empty();
+		}
+		binScale[axis] = extent[axis] > 0.0f ? BINS_COUNT / extent[axis] : 0.0f;
+	}
+
+	for (unsigned int i = 0; i < count; ++i) {
+		glm::vec3 position = (references[i].center - centersBounds.min) * binScale;
+		for (int axis = 0; axis < 3; ++axis) {
+			unsigned int bin = std::min(BINS_COUNT - 1, (unsigned int)position[axis]);
+			binsBounds[axis][bin].Grow(references[i].box);
+			++binsCounts[axis][bin];
+		}
+	}
+
+	/* Cost of testing every object, against visiting two children and testing their objects */
+	float bestCost = (float)count;
+	int bestAxis = -1;
+	unsigned int bestBin = 0;
+	const float inverseArea = 1.0f / std::max(bounds.GetSurfaceArea(), std::numeric_limits<float>::min());
+
+	for (int axis = 0; axis < 3; ++axis) {
+		if (extent[axis] <= 0.0f) {
+			continue;
+		}
+
+		/* Sweep from the right to get the cost of every right side, then from the left */
+		float rightAreas[BINS_COUNT];
+		unsigned int rightCounts[BINS_COUNT];
+		AABB rightBounds = AABB::Empty();
+		unsigned int rightCount = 0;
+		for (unsigned int bin = BINS_COUNT - 1; bin > 0; --bin) {
+			rightBounds.Grow(binsBounds[axis][bin]);
+			rightCount += binsCounts[axis][bin];
+			rightAreas[bin] = rightCount ? rightBounds.GetSurfaceArea() : 0.0f;
+			rightCounts[bin] = rightCount;
+		}
+
+		AABB leftBounds = AABB::Empty();
+		unsigned int leftSideCount = 0;
+		for (unsigned int bin = 1; bin < BINS_COUNT; ++bin) {
+			leftBounds.Grow(binsBounds[axis][bin - 1]);
+			leftSideCount += binsCounts[axis][bin - 1];
+			if (0 == leftSideCount || 0 == rightCounts[bin]) {
+				continue;
+			}
+
+			float cost = TRAVERSAL_COST + (leftBounds.GetSurfaceArea() * leftSideCount + rightAreas[bin] * rightCounts[bin]) * inverseArea;
+			if (cost < bestCost) {
+				bestCost = cost;
+				bestAxis = axis;
+				bestBin = bin;
+			}
+		}
+	}
+
+	if (bestAxis < 0) {
+		if (count <= MAX_LEAF_OBJECTS) {
+			return false;
+		}
+		/* No split cheaper than a leaf, or every center in the same spot, still too many objects for a leaf */
+		int axis = 0;
+		if (extent.y > extent[axis]) axis = 1;
+		if (extent.z > extent[axis]) axis = 2;
+		std::nth_element(references, references + count / 2, references + count,
+			[axis](const Reference& a, const Reference& b) { return a.center[axis] < b.center[axis]; });
+		leftCount = count / 2;
+		return true;
+	}
+
+	const float axisMin = centersBounds.min[bestAxis];
+	const float axisScale = binScale[bestAxis];
+	Reference* middle = std::partition(references, references + count, [=](const Reference& reference) {
+		return std::min(BINS_COUNT - 1, (unsigned int)((reference.center[bestAxis] - axisMin) * axisScale)) < bestBin;
+	});
+	leftCount = (unsigned int)(middle - references);
+	return true;
+}
+
+void BVH::SetBox(unsigned int object, const AABB& box)
+{
+	m_Boxes[m_Slots[object]] = box;
+	if (!m_ObjectsChanged[object]) {
+		m_ObjectsChanged[object] = 1;
+		m_ChangedObjects.push_back(object);
+	}
+}
+
+void BVH::RefitNode(unsigned int node)
+{
+	Node& current = m_Nodes[node];
+	if (0 != current.left) {
+		current.bounds = m_Nodes[current.left].bounds;
+		current.bounds.Grow(m_Nodes[current.left + 1].bounds);
+		return;
+	}
+
+	current.bounds = AABB::Empty();
+	for (unsigned int i = current.first; i < current.first + current.count; ++i) {
+		current.bounds.Grow(m_Boxes[i]);
+	}
+}
+
+unsigned int BVH::Refit()
+{
+	if (m_ChangedObjects.empty()) {
+		return 0;
+	}
+
+	unsigned int visited = 0;
+	if (m_ChangedObjects.size() * 8 > m_Boxes.size()) {
+		/* Too many paths to the root, one pass over all the nodes is cheaper */
+		for (unsigned int node = m_NodesCount; node-- > 0; ) {
+			RefitNode(node);
+		}
+		visited = m_NodesCount;
+	} else {
+		/* Walk up from each leaf until a node does not change, the rest of the path is already right */
+		for (unsigned int object : m_ChangedObjects) {
+			unsigned int node = m_ObjectsLeaves[object];
+			while (true) {
+				AABB previous = m_Nodes[node].bounds;
+				RefitNode(node);
+				++visited;
+				if (previous == m_Nodes[node].bounds || 0 == node) {
+					break;
+				}
+				node = m_Parents[node];
+			}
+		}
+	}
+
+	for (unsigned int object : m_ChangedObjects) {
+		m_ObjectsChanged[object] = 0;
+	}
+	m_ChangedObjects.clear();
+
+	return visited;
+}
+
+unsigned int BVH::QueryFrustum(const Frustum& frustum, std::vector<unsigned int>& result) const
+{
+	result.clear();
+	if (0 == m_NodesCount) {
+		return 0;
+	}
+
+	unsigned int stack[MAX_DEPTH + 1];
+	unsigned int stackSize = 0;
+	stack[stackSize++] = 0;
+
+	while (stackSize > 0) {
+		const Node& node = m_Nodes[stack[--stackSize]];
+		FrustumTest test = TestFrustum(frustum, node.bounds);
+		if (OUTSIDE == test) {
+			continue;
+		}
+
+		/* All the objects below are visible, no need to test them */
+		if (INSIDE == test) {
+			result.insert(result.end(), m_Objects.begin() + node.first, m_Objects.begin() + node.first + node.count);
+			continue;
+		}
+
+		if (0 != node.left) {
+			stack[stackSize++] = node.left + 1;
+			stack[stackSize++] = node.left;
+			continue;
+		}
+
+		for (unsigned int i = node.first; i < node.first + node.count; ++i) {
+			if (OUTSIDE != TestFrustum(frustum, m_Boxes[i])) {
+				result.push_back(m_Objects[i]);
+			}
+		}
+	}
+
+	return (unsigned int)result.size();
+}
+
+unsigned int BVH::QueryRange(const glm::vec3& center, float radius, std::vector<unsigned int>& result) const
+{
+	result.clear();
+	if (0 == m_NodesCount) {
+		return 0;
+	}
+
+	unsigned int stack[MAX_DEPTH + 1];
+	unsigned int stackSize = 0;
+	stack[stackSize++] = 0;
+
+	while (stackSize > 0) {
+		const Node& node = m_Nodes[stack[--stackSize]];
+		if (!OverlapsSphere(node.bounds, center, radius)) {
+			continue;
+		}
+
+		if (0 != node.left) {
+			stack[stackSize++] = node.left + 1;
+			stack[stackSize++] = node.left;
+			continue;
+		}
+
+		for (unsigned int i = node.first; i < node.first + node.count; ++i) {
+			if (OverlapsSphere(m_Boxes[i], center, radius)) {
+				result.push_back(m_Objects[i]);
+			}
+		}
+	}
+
+	return (unsigned int)result.size();
+}
+
+unsigned int BVH::RayCast(const glm::vec3& origin, const glm::vec3& direction, float& distance) const
+{
+	unsigned int hit = INVALID_OBJECT;
+	if (0 == m_NodesCount) {
+		return hit;
+	}
+
+	const glm::vec3 inverseDirection = 1.0f / direction;
+	const float infinity = std::numeric_limits<float>::infinity();
+
+	unsigned int stack[MAX_DEPTH + 1];
+	unsigned int stackSize = 0;
+	if (IntersectRay(m_Nodes[0].bounds, origin, inverseDirection, distance) < infinity) {
+		stack[stackSize++] = 0;
+	}
+
+	while (stackSize > 0) {
+		const Node& node = m_Nodes[stack[--stackSize]];
+
+		if (0 == node.left) {
+			for (unsigned int i = node.first; i < node.first + node.count; ++i) {
+				float objectDistance = IntersectRay(m_Boxes[i], origin, inverseDirection, distance);
+				if (objectDistance < distance) {
+					distance = objectDistance;
+					hit = m_Objects[i];
+				}
+			}
+			continue;
+		}
+
+		/* The nearer child is visited first, its hits prune the farther one */
+		float leftDistance = IntersectRay(m_Nodes[node.left].bounds, origin, inverseDirection, distance);
+		float rightDistance = IntersectRay(m_Nodes[node.left + 1].bounds, origin, inverseDirection, distance);
+		unsigned int nearChild = node.left, farChild = node.left + 1;
+		if (rightDistance < leftDistance) {
+			std::swap(leftDistance, rightDistance);
+			std::swap(nearChild, farChild);
+		}
+		if (rightDistance < infinity) {
+			stack[stackSize++] = farChild;
+		}
+		if (leftDistance < infinity) {
+			stack[stackSize++] = nearChild;
+		}
+	}
+
+	return hit;
+}
+
+unsigned int BVH::GetDepth() const
+{
+	unsigned int depth = 0;
+	for (unsigned int node = 1; node < m_NodesCount; ++node) {
+		if (0 != m_Nodes[node].left) {
+			continue;
+		}
+		unsigned int leafDepth = 0;
+		for (unsigned int current = node; 0 != current; current = m_Parents[current]) {
+			++leafDepth;
+		}
+		depth = std::max(depth, leafDepth);
+	}
+	return depth;
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <vector>
+#include <atomic>
+#include "glm/glm.hpp"
+
+#include "FrustumCulling.h"
+
+struct AABB
+{
+	glm::vec3 min;
+	glm::vec3 max;
+
+	/* Inverted box, growing it by anything gives that thing */
+	static AABB Empty();
+	static AABB FromSphere(const glm::vec3& center, float radius);
+
+	void Grow(const glm::vec3& point);
+	void Grow(const AABB& box);
+	inline glm::vec3 GetCenter() const { return 0.5f * (min + max); }
+	inline glm::vec3 GetExtent() const { return 0.5f * (max - min); }
+	float GetSurfaceArea() const;
+	inline bool operator==(const AABB& other) const { return min == other.min && max == other.max; }
+};
+
+/*
+	Bounding volume hierarchy over object boxes, objects are referenced by their index in the boxes given to Build().
+	The tree is built top down with the surface area heuristic evaluated on a few bins per axis,
+	the two halves of the large nodes are built as separate jobs of the shared JobSystem.
+	Moving objects only refit the boxes on the path to the root, the tree keeps its topology:
+	after big changes Build() again to get the quality back.
+*/
+class BVH
+{
+public:
+	static constexpr unsigned int INVALID_OBJECT = 0xFFFFFFFF;
+
+	BVH();
+
+	/* parallel false builds everything on the calling thread */
+	void Build(const std::vector<AABB>& boxes, bool parallel = true);
+
+	/* Changes are applied by the next Refit() */
+	void SetBox(unsigned int object, const AABB& box);
+	/* Returns the number of nodes visited */
+	unsigned int Refit();
+
+	/* Each of these clears result, fills it with the objects found and returns their count */
+	unsigned int QueryFrustum(const Frustum& frustum, std::vector<unsigned int>& result) const;
+	unsigned int QueryRange(const glm::vec3& center, float radius, std::vector<unsigned int>& result) const;
+
+	/* Closest object box hit closer than distance, distance is updated to the hit */
+	unsigned int RayCast(const glm::vec3& origin, const glm::vec3& direction, float& distance) const;
+
+	inline unsigned int GetObjectsCount() const { return (unsigned int)m_Boxes.size(); }
+	inline unsigned int GetNodesCount() const { return m_NodesCount; }
+	unsigned int GetDepth() const;
+
+private:
+	/* Objects of a node are the contiguous range [first, first + count) of m_Objects, internal nodes included */
+	struct Node
+	{
+		AABB bounds;
+		unsigned int first;
+		unsigned int count;
+		/* Children are left and left + 1, 0 for leaves since the root is nobody's child */
+		unsigned int left;
+	};
+
+	static constexpr unsigned int BINS_COUNT = 16;
+	static constexpr unsigned int MAX_LEAF_OBJECTS = 8;
+	/* Cost of visiting a node, relative to testing an object */
+	static constexpr float TRAVERSAL_COST = 1.0f;
+	/* Deeper trees do not fit the traversal stack */
+	static constexpr unsigned int MAX_DEPTH = 64;
+	/* Smaller nodes are not worth a job */
+	static constexpr unsigned int PARALLEL_MIN_OBJECTS = 32768;
+
+	/* The build moves these around instead of indices, so that every pass reads memory in order */
+	struct Reference
+	{
+		AABB box;
+		glm::vec3 center;
+		unsigned int object;
+	};
+
+	void BuildNode(unsigned int node, unsigned int first, unsigned int count, unsigned int depth, bool parallel);
+	/* Returns false when the node should stay a leaf, otherwise the number of objects going left */
+	bool FindSplit(unsigned int first, unsigned int count, const AABB& bounds, const AABB& centersBounds, unsigned int& leftCount);
+	void RefitNode(unsigned int node);
+
+	std::vector<Reference> m_References;
+	/* Objects and their boxes in tree order, leaves read them contiguously */
+	std::vector<unsigned int> m_Objects;
+	std::vector<AABB> m_Boxes;
+	/* Position of each object in m_Objects */
+	std::vector<unsigned int> m_Slots;
+
+	std::vector<Node> m_Nodes;
+	std::vector<unsigned int> m_Parents;
+	std::vector<unsigned int> m_ObjectsLeaves;
+	std::atomic<unsigned int> m_NodesUsed;
+	unsigned int m_NodesCount;
+
+	std::vector<unsigned int> m_ChangedObjects;
+	std::vector<unsigned char> m_ObjectsChanged;
+};
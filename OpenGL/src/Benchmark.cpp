@@ -0,0 +1,322 @@
+#include "Benchmark.h"
+
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <iostream>
+#include <algorithm>
+
+#include "Renderer.h"
+#include "Framebuffer.h"
+
+/* Column prefixes of the CSV, in the order of the stats in BenchmarkResult */
+static const char* const METRIC_NAMES[] = { "cpu_ms", "gpu_ms", "draw_calls" };
+static const char* const STAT_NAMES[] = { "p50", "p95", "p99", "max", "mean" };
+
+static BenchmarkStats BenchmarkResult::* const METRICS[] = { &BenchmarkResult::cpu, &BenchmarkResult::gpu, &BenchmarkResult::drawCalls };
+static float BenchmarkStats::* const STATS[] = { &BenchmarkStats::p50, &BenchmarkStats::p95, &BenchmarkStats::p99, &BenchmarkStats::max, &BenchmarkStats::mean };
+static constexpr unsigned int METRICS_COUNT = sizeof(METRICS) / sizeof(METRICS[0]);
+static constexpr unsigned int STATS_COUNT = sizeof(STATS) / sizeof(STATS[0]);
+
+BenchmarkStats BenchmarkStats::FromSamples(std::vector<float> samples)
+{
+	BenchmarkStats stats;
+	if (samples.empty()) {
+		return stats;
+	}
+
+	std::sort(samples.begin(), samples.end());
+	auto percentile = [&samples](float p) {
+		size_t rank = (size_t)std::ceil(p * samples.size());
+		return samples[std::max<size_t>(rank, 1) - 1];
+	};
+	stats.p50 = percentile(0.50f);
+	stats.p95 = percentile(0.95f);
+	stats.p99 = percentile(0.99f);
+	stats.max = samples.back();
+
+	double sum = 0.0;
+	for (float sample : samples) {
+		sum += sample;
+	}
+	stats.mean = (float)(sum / samples.size());
+	return stats;
+}
+
+Benchmark::Benchmark(const Settings& settings, Camera& camera, const bool& useCamera)
+	: m_Settings(settings), m_Camera(camera), m_UseCamera(useCamera)
+{
+	GLCheckErrorCall(glGenQueries(TIMESTAMP_LATENCY * 2, m_Timestamps));
+	for (unsigned int i = 0; i < TIMESTAMP_LATENCY; ++i) {
+		m_PendingFrames[i] = -1;
+	}
+}
+
+Benchmark::~Benchmark()
+{
+	GLCheckErrorCall(glDeleteQueries(TIMESTAMP_LATENCY * 2, m_Timestamps));
+}
+
+bool Benchmark::RunAll(const scene::SceneMenu& menu)
+{
+	for (const std::string& name : menu.GetSceneNames()) {
+		if (!Run(menu, name)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+const BenchmarkResult* Benchmark::Run(const scene::SceneMenu& menu, const std::string& sceneName)
+{
+	/* Before the scene exists: scenes using the camera read it in their constructor */
+	m_Camera.ResetToDefaults();
+
+	scene::AbstractScene* benchmarkScene = menu.CreateScene(sceneName);
+	if (!benchmarkScene) {
+		std::cout << "Unknown scene \"" << sceneName << "\"" << std::endl;
+		return nullptr;
+	}
+
+	Framebuffer framebuffer(m_Settings.width, m_Settings.height);
+	if (!framebuffer.IsComplete()) {
+		std::cout << "Failed to create the benchmark framebuffer" << std::endl;
+		delete benchmarkScene;
+		return nullptr;
+	}
+	framebuffer.Bind();
+
+	std::vector<float> cpuMilliseconds;
+	std::vector<float> gpuMilliseconds(m_Settings.frames, 0.0f);
+	std::vector<float> drawCalls;
+	cpuMilliseconds.reserve(m_Settings.frames);
+	drawCalls.reserve(m_Settings.frames);
+
+	const unsigned int totalFrames = m_Settings.warmupFrames + m_Settings.frames;
+	for (unsigned int frame = 0; frame < totalFrames; ++frame) {
+		const bool measured = frame >= m_Settings.warmupFrames;
+		const unsigned int measuredFrame = frame - m_Settings.warmupFrames;
+		const unsigned int slot = frame % TIMESTAMP_LATENCY;
+		if (measured && -1 != m_PendingFrames[slot]) {
+			ReadTimestamps(slot, true, gpuMilliseconds);
+		}
+
+		/* Same simulated time and camera path on every run */
+		glfwSetTime(frame * (double)m_Settings.deltaTime);
+		if (m_UseCamera) {
+			MoveCamera(frame);
+		}
+
+		Renderer::ResetDrawCalls();
+		auto start = std::chrono::high_resolution_clock::now();
+		if (measured) {
+			GLCheckErrorCall(glQueryCounter(m_Timestamps[slot * 2], GL_TIMESTAMP));
+		}
+
+		benchmarkScene->OnUpdate(m_Settings.deltaTime);
+		benchmarkScene->OnRender(1.0f);
+
+		if (measured) {
+			GLCheckErrorCall(glQueryCounter(m_Timestamps[slot * 2 + 1], GL_TIMESTAMP));
+			/* glFlush keeps the GPU busy without waiting for it, like a buffer swap would */
+			GLCheckErrorCall(glFlush());
+			auto end = std::chrono::high_resolution_clock::now();
+
+			m_PendingFrames[slot] = (int)measuredFrame;
+			cpuMilliseconds.push_back(std::chrono::duration<float, std::milli>(end - start).count());
+			drawCalls.push_back((float)Renderer::GetDrawCalls());
+		}
+
+		/* Collect whatever is already available */
+		for (unsigned int i = 0; i < TIMESTAMP_LATENCY; ++i) {
+			if (-1 != m_PendingFrames[i]) {
+				ReadTimestamps(i, false, gpuMilliseconds);
+			}
+		}
+	}
+	for (unsigned int i = 0; i < TIMESTAMP_LATENCY; ++i) {
+		if (-1 != m_PendingFrames[i]) {
+			ReadTimestamps(i, true, gpuMilliseconds);
+		}
+	}
+
+	delete benchmarkScene;
+	Framebuffer::Unbind();
+
+	BenchmarkResult result;
+	result.scene = sceneName;
+	result.frames = m_Settings.frames;
+	result.cpu = BenchmarkStats::FromSamples(cpuMilliseconds);
+	result.gpu = BenchmarkStats::FromSamples(gpuMilliseconds);
+	result.drawCalls = BenchmarkStats::FromSamples(drawCalls);
+	m_Results.push_back(result);
+
+	std::cout << "Benchmark " << sceneName << ": CPU p50 " << result.cpu.p50 << " ms, p99 " << result.cpu.p99
+		<< " ms, GPU p50 " << result.gpu.p50 << " ms, p99 " << result.gpu.p99 << " ms, "
+		<< result.drawCalls.mean << " draw calls" << std::endl;
+	return &m_Results.back();
+}
+
+void Benchmark::MoveCamera(unsigned int frame)
+{
+	m_Camera.ProcessMouseMovement(CAMERA_TURN_PER_FRAME, 0.0f);
+
+	const bool forward = 0 == (frame / CAMERA_STROKE_FRAMES) % 2;
+	m_Camera.ProcessKeyboard(forward ? Camera::MovementDirection::FORWARD : Camera::MovementDirection::BACKWARD, m_Settings.deltaTime);
+}
+
+bool Benchmark::ReadTimestamps(unsigned int slot, bool wait, std::vector<float>& gpuMilliseconds)
+{
+	if (!wait) {
+		GLint available = 0;
+		GLCheckErrorCall(glGetQueryObjectiv(m_Timestamps[slot * 2 + 1], GL_QUERY_RESULT_AVAILABLE, &available));
+		if (!available) {
+			return false;
+		}
+	}
+
+	GLuint64 begin = 0, end = 0;
+	GLCheckErrorCall(glGetQueryObjectui64v(m_Timestamps[slot * 2], GL_QUERY_RESULT, &begin));
+	GLCheckErrorCall(glGetQueryObjectui64v(m_Timestamps[slot * 2 + 1], GL_QUERY_RESULT, &end));
+	gpuMilliseconds[m_PendingFrames[slot]] = (float)((end - begin) / 1.0e6);
+	m_PendingFrames[slot] = -1;
+	return true;
+}
+
+bool Benchmark::WriteJSON(const std::string& path) const
+{
+	std::ofstream file(path);
+	if (!file) {
+		std::cout << "Cannot write " << path << std::endl;
+		return false;
+	}
+
+	file << "{\n\t\"warmupFrames\": " << m_Settings.warmupFrames << ",\n\t\"deltaTime\": " << m_Settings.deltaTime << ",\n\t\"scenes\": [\n";
+	for (size_t i = 0; i < m_Results.size(); ++i) {
+		const BenchmarkResult& result = m_Results[i];
+		file << "\t\t{\n\t\t\t\"name\": \"" << result.scene << "\",\n\t\t\t\"frames\": " << result.frames;
+		for (unsigned int metric = 0; metric < METRICS_COUNT; ++metric) {
+			file << ",\n\t\t\t\"" << METRIC_NAMES[metric] << "\": { ";
+			for (unsigned int stat = 0; stat < STATS_COUNT; ++stat) {
+				file << (stat ? ", " : "") << '"' << STAT_NAMES[stat] << "\": " << (result.*METRICS[metric]).*STATS[stat];
+			}
+			file << " }";
+		}
+		file << "\n\t\t}" << (i + 1 < m_Results.size() ? "," : "") << '\n';
+	}
+	file << "\t]\n}\n";
+	return true;
+}
+
+bool Benchmark::WriteCSV(const std::string& path) const
+{
+	std::ofstream file(path);
+	if (!file) {
+		std::cout << "Cannot write " << path << std::endl;
+		return false;
+	}
+
+	file << "scene,frames";
+	for (unsigned int metric = 0; metric < METRICS_COUNT; ++metric) {
+		for (unsigned int stat = 0; stat < STATS_COUNT; ++stat) {
+			file << ',' << METRIC_NAMES[metric] << '_' << STAT_NAMES[stat];
+		}
+	}
+	file << '\n';
+
+	for (const BenchmarkResult& result : m_Results) {
+		file << result.scene << ',' << result.frames;
+		for (unsigned int metric = 0; metric < METRICS_COUNT; ++metric) {
+			for (unsigned int stat = 0; stat < STATS_COUNT; ++stat) {
+				file << ',' << (result.*METRICS[metric]).*STATS[stat];
+			}
+		}
+		file << '\n';
+	}
+	return true;
+}
+
+bool Benchmark::ReadCSV(const std::string& path, std::vector<BenchmarkResult>& results)
+{
+	std::ifstream file(path);
+	std::string line;
+	if (!file || !std::getline(file, line)) {
+		std::cout << "Cannot read " << path << std::endl;
+		return false;
+	}
+
+	/* Columns are found by name, a baseline written before a column was added still loads */
+	std::vector<std::string> header;
+	std::stringstream headerStream(line);
+	std::string column;
+	while (std::getline(headerStream, column, ',')) {
+		header.push_back(column);
+	}
+
+	results.clear();
+	while (std::getline(file, line)) {
+		if (line.empty()) {
+			continue;
+		}
+
+		BenchmarkResult result;
+		std::stringstream lineStream(line);
+		std::string value;
+		for (size_t i = 0; i < header.size() && std::getline(lineStream, value, ','); ++i) {
+			if ("scene" == header[i]) {
+				result.scene = value;
+			} else if ("frames" == header[i]) {
+				result.frames = (unsigned int)std::strtoul(value.c_str(), nullptr, 10);
+			}
+			for (unsigned int metric = 0; metric < METRICS_COUNT; ++metric) {
+				for (unsigned int stat = 0; stat < STATS_COUNT; ++stat) {
+					if (header[i] == std::string(METRIC_NAMES[metric]) + '_' + STAT_NAMES[stat]) {
+						(result.*METRICS[metric]).*STATS[stat] = std::strtof(value.c_str(), nullptr);
+					}
+				}
+			}
+		}
+		results.push_back(result);
+	}
+	return true;
+}
+
+unsigned int Benchmark::CompareWithBaseline(const std::vector<BenchmarkResult>& baseline) const
+{
+	unsigned int regressions = 0;
+	for (const BenchmarkResult& result : m_Results) {
+		auto previous = std::find_if(baseline.begin(), baseline.end(),
+			[&result](const BenchmarkResult& candidate) { return candidate.scene == result.scene; });
+		if (baseline.end() == previous) {
+			std::cout << "  " << result.scene << ": not in the baseline" << std::endl;
+			continue;
+		}
+		const BenchmarkResult& before = *previous;
+
+		/* Times are compared on the p50 and the p95, the max of a single run is too noisy */
+		bool regressed = false;
+		for (unsigned int metric = 0; metric < 2; ++metric) {
+			for (unsigned int stat = 0; stat < 2; ++stat) {
+				float now = (result.*METRICS[metric]).*STATS[stat];
+				float then = (before.*METRICS[metric]).*STATS[stat];
+				if (now - then > REGRESSION_MIN_MILLISECONDS && now > then * (1.0f + m_Settings.regressionThreshold)) {
+					std::cout << "  REGRESSION " << result.scene << ": " << METRIC_NAMES[metric] << '_' << STAT_NAMES[stat]
+						<< ' ' << then << " -> " << now << " (+" << (now / std::max(then, 1e-6f) - 1.0f) * 100.0f << "%)" << std::endl;
+					regressed = true;
+				}
+			}
+		}
+		/* Draw calls do not depend on timing, any increase is a change in behavior */
+		if (result.drawCalls.mean > before.drawCalls.mean) {
+			std::cout << "  REGRESSION " << result.scene << ": draw calls " << before.drawCalls.mean << " -> " << result.drawCalls.mean << std::endl;
+			regressed = true;
+		}
+
+		if (regressed) {
+			++regressions;
+		}
+	}
+	return regressions;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Scene.h"
+#include "Camera.h"
+
+/* Percentiles of the samples of a run, nearest rank */
+struct BenchmarkStats
+{
+	float p50 = 0.0f;
+	float p95 = 0.0f;
+	float p99 = 0.0f;
+	float max = 0.0f;
+	float mean = 0.0f;
+
+	static BenchmarkStats FromSamples(std::vector<float> samples);
+};
+
+struct BenchmarkResult
+{
+	std::string scene;
+	unsigned int frames = 0;
+	/* Milliseconds per frame */
+	BenchmarkStats cpu;
+	BenchmarkStats gpu;
+	BenchmarkStats drawCalls;
+};
+
+/*
+	Runs scenes offscreen for a fixed number of frames with the same simulated time and the same
+	camera path every time, so that two runs of the same build give comparable numbers.
+	The frames rendered while warming up are not measured: they absorb shader compilation,
+	first uploads and driver caches. GPU time comes from timestamps read back a few frames later.
+*/
+class Benchmark
+{
+public:
+	struct Settings
+	{
+		unsigned int warmupFrames = 60;
+		unsigned int frames = 600;
+		float deltaTime = 1.0f / 60.0f;
+		/* Relative slowdown of the p50 or p95 above which a scene is a regression */
+		float regressionThreshold = 0.1f;
+		int width = 720;
+		int height = 540;
+	};
+
+	/* The camera follows a scripted path in the scenes turning useCamera on */
+	Benchmark(const Settings& settings, Camera& camera, const bool& useCamera);
+	~Benchmark();
+
+	/* Every scene registered in the menu, one after the other */
+	bool RunAll(const scene::SceneMenu& menu);
+	/* Null when the scene is not registered */
+	const BenchmarkResult* Run(const scene::SceneMenu& menu, const std::string& sceneName);
+
+	inline const std::vector<BenchmarkResult>& GetResults() const { return m_Results; }
+
+	bool WriteJSON(const std::string& path) const;
+	bool WriteCSV(const std::string& path) const;
+	static bool ReadCSV(const std::string& path, std::vector<BenchmarkResult>& results);
+
+	/* Prints the scenes slower than in the baseline CSV, returns how many there are */
+	unsigned int CompareWithBaseline(const std::vector<BenchmarkResult>& baseline) const;
+
+private:
+	/* Frames between a timestamp and its read back, the ring never stalls unless the GPU is this far behind */
+	static constexpr unsigned int TIMESTAMP_LATENCY = 8;
+	/* Differences below this are noise whatever the threshold says */
+	static constexpr float REGRESSION_MIN_MILLISECONDS = 0.05f;
+	/* Camera path: turns at a constant rate while going back and forth along its front */
+	static constexpr float CAMERA_TURN_PER_FRAME = 2.0f;
+	static constexpr unsigned int CAMERA_STROKE_FRAMES = 120;
+
+	void MoveCamera(unsigned int frame);
+	/* Stores the GPU time of the frame in slot, waiting for it if asked to */
+	bool ReadTimestamps(unsigned int slot, bool wait, std::vector<float>& gpuMilliseconds);
+
+	const Settings m_Settings;
+	Camera& m_Camera;
+	const bool& m_UseCamera;
+
+	unsigned int m_Timestamps[TIMESTAMP_LATENCY * 2];
+	/* Measured frame each slot of the ring is waiting for, -1 when free */
+	int m_PendingFrames[TIMESTAMP_LATENCY];
+
+	std::vector<BenchmarkResult> m_Results;
+};
@@ -37,6 +37,11 @@ glm::mat4 Camera::GetPerspectiveProjMatrix()
 	return glm::perspective<float>(glm::radians(m_FOV), m_AspectRatio, 0.1f, 100.0f);
 }
 
+Frustum Camera::GetFrustum()
+{
+	return FrustumCulling::ExtractFrustum(GetPerspectiveProjMatrix() * GetViewMatrix());
+}
+
 void Camera::SetAspectRatio(float aspectRatio)
 {
 	this->m_AspectRatio = aspectRatio;
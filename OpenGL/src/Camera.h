@@ -4,6 +4,8 @@
 #include "glm/gtc/matrix_transform.hpp"
 #include <GLFW/glfw3.h>
 
+#include "FrustumCulling.h"
+
 class Camera
 {
 public:
@@ -20,6 +22,8 @@ public:
 	glm::vec3 GetPosition();
 	glm::mat4 GetViewMatrix();
 	glm::mat4 GetPerspectiveProjMatrix();
+	/* World space planes of the view volume, for culling */
+	Frustum GetFrustum();
 
 	void SetAspectRatio(float aspectRatio);
 	void SetConstrainToGround(bool constrainToGround);
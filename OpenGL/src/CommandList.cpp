@@ -0,0 +1,169 @@
+#include "CommandList.h"
+
+#include "Renderer.h"
+
+CommandList::CommandList()
+{
+	this->Reset();
+}
+
+void CommandList::Reset()
+{
+	m_Commands.clear();
+	m_UniformData.clear();
+	m_CommandsCount = 0;
+	m_DrawsCount = 0;
+	m_TextureBindsCount = 0;
+
+	m_Shader = nullptr;
+	m_VertexArray = nullptr;
+	for (unsigned int slot = 0; slot < TEXTURE_SLOTS; ++slot) {
+		m_Textures[slot] = nullptr;
+	}
+}
+
+void CommandList::BindShader(Shader& shader)
+{
+	if (m_Shader != &shader) {
+		Push(BindShaderCommand{ Type::BIND_SHADER, &shader });
+		m_Shader = &shader;
+	}
+}
+
+void CommandList::BindVertexArray(const VertexArray& va)
+{
+	if (m_VertexArray != &va) {
+		Push(BindVertexArrayCommand{ Type::BIND_VERTEX_ARRAY, &va });
+		m_VertexArray = &va;
+	}
+}
+
+void CommandList::BindTexture(const Texture& texture, unsigned int slot)
+{
+	if (m_Textures[slot] != &texture) {
+		Push(BindTextureCommand{ Type::BIND_TEXTURE, slot, &texture });
+		m_Textures[slot] = &texture;
+		++m_TextureBindsCount;
+	}
+}
+
+unsigned int CommandList::AllocateUniform(const float* values, unsigned int count)
+{
+	const unsigned int offset = (unsigned int)m_UniformData.size();
+	m_UniformData.insert(m_UniformData.end(), values, values + count);
+	return offset;
+}
+
+void CommandList::SetUniformMatrix4(const char* name, const glm::mat4& matrix)
+{
+	Push(SetUniformCommand{ Type::SET_UNIFORM_MATRIX4, AllocateUniform(&matrix[0][0], 16), name });
+}
+
+void CommandList::SetUniform4f(const char* name, const glm::vec4& value)
+{
+	Push(SetUniformCommand{ Type::SET_UNIFORM_4F, AllocateUniform(&value[0], 4), name });
+}
+
+void CommandList::SetBufferData(VertexBuffer& vb, const float* data, size_t count)
+{
+	const size_t offset = m_UniformData.size();
+	m_UniformData.insert(m_UniformData.end(), data, data + count);
+	Push(SetBufferDataCommand{ Type::SET_BUFFER_DATA, offset, count, &vb });
+}
+
+void CommandList::BindInstanceBuffer(VertexArray& va, const VertexBuffer& vb, const VertexBufferLayout& layout, GLuint firstIndex, size_t offset)
+{
+	/* Changes the bound vertex array */
+	Push(BindInstanceBufferCommand{ Type::BIND_INSTANCE_BUFFER, firstIndex, offset, &va, &vb, &layout });
+	m_VertexArray = &va;
+}
+
+void CommandList::DrawIndexed(const IndexBuffer& ib, unsigned int count, unsigned int firstIndex, unsigned int instanceCount)
+{
+	Push(DrawIndexedCommand{ Type::DRAW_INDEXED, ib.GetType(), ib.GetIndexSize(), 0 != count ? count : ib.GetCount(), firstIndex, instanceCount });
+	++m_DrawsCount;
+}
+
+void CommandList::Execute() const
+{
+	/* Last shader bound by this list, uniforms are set on it */
+	Shader* shader = nullptr;
+
+	const unsigned char* command = m_Commands.data();
+	const unsigned char* end = command + m_Commands.size();
+	while (command < end) {
+		Type type;
+		std::memcpy(&type, command, sizeof(Type));
+
+		switch (type) {
+		case Type::BIND_SHADER: {
+			BindShaderCommand bind;
+			std::memcpy(&bind, command, sizeof(bind));
+			shader = bind.shader;
+			shader->Use();
+			command += AlignedSize<BindShaderCommand>();
+			break;
+		}
+		case Type::BIND_VERTEX_ARRAY: {
+			BindVertexArrayCommand bind;
+			std::memcpy(&bind, command, sizeof(bind));
+			bind.va->Bind();
+			command += AlignedSize<BindVertexArrayCommand>();
+			break;
+		}
+		case Type::BIND_TEXTURE: {
+			BindTextureCommand bind;
+			std::memcpy(&bind, command, sizeof(bind));
+			bind.texture->Bind(bind.slot);
+			command += AlignedSize<BindTextureCommand>();
+			break;
+		}
+		case Type::SET_UNIFORM_MATRIX4: {
+			SetUniformCommand set;
+			std::memcpy(&set, command, sizeof(set));
+			glm::mat4 matrix;
+			std::memcpy(&matrix[0][0], &m_UniformData[set.value], sizeof(matrix));
+			shader->SetUniformMatrix4fv(set.name, matrix);
+			command += AlignedSize<SetUniformCommand>();
+			break;
+		}
+		case Type::SET_UNIFORM_4F: {
+			SetUniformCommand set;
+			std::memcpy(&set, command, sizeof(set));
+			const float* value = &m_UniformData[set.value];
+			shader->SetUniform4f(set.name, value[0], value[1], value[2], value[3]);
+			command += AlignedSize<SetUniformCommand>();
+			break;
+		}
+		case Type::SET_BUFFER_DATA: {
+			SetBufferDataCommand set;
+			std::memcpy(&set, command, sizeof(set));
+			/* The GPU may still read the previous content, it gets new storage instead of a sync */
+			set.vb->Orphan(set.vb->GetSize());
+			set.vb->SetData(&m_UniformData[set.data], 0, set.count * sizeof(float));
+			command += AlignedSize<SetBufferDataCommand>();
+			break;
+		}
+		case Type::BIND_INSTANCE_BUFFER: {
+			BindInstanceBufferCommand bind;
+			std::memcpy(&bind, command, sizeof(bind));
+			bind.va->AddInstanceBuffer(*bind.vb, *bind.layout, bind.firstIndex, bind.offset);
+			command += AlignedSize<BindInstanceBufferCommand>();
+			break;
+		}
+		case Type::DRAW_INDEXED: {
+			DrawIndexedCommand draw;
+			std::memcpy(&draw, command, sizeof(draw));
+			const GLvoid* offset = reinterpret_cast<const GLvoid*>((size_t)draw.firstIndex * draw.indexSize);
+			if (1 == draw.instanceCount) {
+				GLCheckErrorCall(glDrawElements(GL_TRIANGLES, draw.count, draw.indexType, offset));
+			} else {
+				GLCheckErrorCall(glDrawElementsInstanced(GL_TRIANGLES, draw.count, draw.indexType, offset, draw.instanceCount));
+			}
+			Renderer::AddDrawCalls();
+			command += AlignedSize<DrawIndexedCommand>();
+			break;
+		}
+		}
+	}
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <vector>
+#include <cstring>
+#include <type_traits>
+#include "glm/glm.hpp"
+
+#include "Shader.h"
+#include "Texture.h"
+#include "VertexArray.h"
+#include "IndexBuffer.h"
+
+/*
+	Draw commands recorded without touching the graphics API, so any thread can fill a list
+	while only the context thread replays it with Execute. Commands are small structs packed
+	one after the other in a byte stream, uniform values and buffer data go to a separate linear allocator:
+	resetting a list keeps its memory, so recording the same frame again does not allocate.
+	Binding again what is already bound is filtered while recording.
+	Everything referenced must stay alive until the list is executed.
+*/
+class CommandList
+{
+public:
+	CommandList();
+
+	void Reset();
+
+	void BindShader(Shader& shader);
+	void BindVertexArray(const VertexArray& va);
+	void BindTexture(const Texture& texture, unsigned int slot = 0);
+	/* The name must outlive the list, like the UNIFORM_ constants */
+	void SetUniformMatrix4(const char* name, const glm::mat4& matrix);
+	void SetUniform4f(const char* name, const glm::vec4& value);
+	/* Orphans vb and fills its beginning with a copy of the count floats of data, taken now */
+	void SetBufferData(VertexBuffer& vb, const float* data, size_t count);
+	/* See VertexArray::AddInstanceBuffer, the layout must outlive the list */
+	void BindInstanceBuffer(VertexArray& va, const VertexBuffer& vb, const VertexBufferLayout& layout, GLuint firstIndex, size_t offset);
+	/* Triangles from the indices [firstIndex, firstIndex + count) of ib, count 0 draws all of them */
+	void DrawIndexed(const IndexBuffer& ib, unsigned int count = 0, unsigned int firstIndex = 0, unsigned int instanceCount = 1);
+
+	/* Context thread only, commands run in recording order */
+	void Execute() const;
+
+	inline unsigned int GetCommandsCount() const { return m_CommandsCount; }
+	inline unsigned int GetDrawsCount() const { return m_DrawsCount; }
+	inline unsigned int GetTextureBindsCount() const { return m_TextureBindsCount; }
+	inline size_t GetSize() const { return m_Commands.size() + m_UniformData.size() * sizeof(float); }
+
+private:
+	enum class Type : unsigned char {
+		BIND_SHADER,
+		BIND_VERTEX_ARRAY,
+		BIND_TEXTURE,
+		SET_UNIFORM_MATRIX4,
+		SET_UNIFORM_4F,
+		SET_BUFFER_DATA,
+		BIND_INSTANCE_BUFFER,
+		DRAW_INDEXED
+	};
+
+	/* Every command starts with its type, the stream is read back by switching on it */
+	struct BindShaderCommand { Type type; Shader* shader; };
+	struct BindVertexArrayCommand { Type type; const VertexArray* va; };
+	struct BindTextureCommand { Type type; unsigned int slot; const Texture* texture; };
+	/* value is an offset in m_UniformData */
+	struct SetUniformCommand { Type type; unsigned int value; const char* name; };
+	/* data is an offset in m_UniformData */
+	struct SetBufferDataCommand { Type type; size_t data; size_t count; VertexBuffer* vb; };
+	struct BindInstanceBufferCommand { Type type; GLuint firstIndex; size_t offset; VertexArray* va; const VertexBuffer* vb; const VertexBufferLayout* layout; };
+	struct DrawIndexedCommand { Type type; GLenum indexType; unsigned int indexSize; unsigned int count; unsigned int firstIndex; unsigned int instanceCount; };
+
+	/* Commands are padded to the alignment of their pointers, every one starts aligned */
+	static constexpr size_t COMMAND_ALIGNMENT = alignof(void*);
+	static constexpr unsigned int TEXTURE_SLOTS = 16;
+
+	template<typename Command>
+	void Push(const Command& command)
+	{
+		static_assert(std::is_trivially_copyable<Command>::value, "Commands are copied as bytes");
+		const size_t offset = m_Commands.size();
+		m_Commands.resize(offset + AlignedSize<Command>());
+		std::memcpy(m_Commands.data() + offset, &command, sizeof(Command));
+		++m_CommandsCount;
+	}
+
+	template<typename Command>
+	static constexpr size_t AlignedSize()
+	{
+		return (sizeof(Command) + COMMAND_ALIGNMENT - 1) & ~(COMMAND_ALIGNMENT - 1);
+	}
+
+	unsigned int AllocateUniform(const float* values, unsigned int count);
+
+	std::vector<unsigned char> m_Commands;
+	std::vector<float> m_UniformData;
+	unsigned int m_CommandsCount;
+	unsigned int m_DrawsCount;
+	unsigned int m_TextureBindsCount;
+
+	/* State bound by the commands recorded so far */
+	const Shader* m_Shader;
+	const VertexArray* m_VertexArray;
+	const Texture* m_Textures[TEXTURE_SLOTS];
+};
@@ -0,0 +1,207 @@
+#include "EntityStore.h"
+
+#include <cmath>
+
+namespace {
+
+	template<typename T>
+	inline void MoveLast(std::vector<T>& component, unsigned int index)
+	{
+		component[index] = component.back();
+		component.pop_back();
+	}
+
+	/*
+		q += dt / 2 * (0, w) * q, then normalized. No branches and no calls, restrict tells the compiler
+		the arrays do not overlap, so the loop is vectorized without run-time alias checks.
+	*/
+	void IntegrateRotations(unsigned int count, float halfDelta,
+		float* __restrict qx, float* __restrict qy, float* __restrict qz, float* __restrict qw,
+		const float* __restrict wx, const float* __restrict wy, const float* __restrict wz)
+	{
+		for (unsigned int i = 0; i < count; ++i) {
+			float x = qx[i], y = qy[i], z = qz[i], w = qw[i];
+			float dx = halfDelta * (wx[i] * w + wy[i] * z - wz[i] * y);
+			float dy = halfDelta * (wy[i] * w + wz[i] * x - wx[i] * z);
+			float dz = halfDelta * (wz[i] * w + wx[i] * y - wy[i] * x);
+			float dw = -halfDelta * (wx[i] * x + wy[i] * y + wz[i] * z);
+			x += dx;
+			y += dy;
+			z += dz;
+			w += dw;
+			float inverseLength = 1.0f / std::sqrt(x * x + y * y + z * z + w * w);
+			qx[i] = x * inverseLength;
+			qy[i] = y * inverseLength;
+			qz[i] = z * inverseLength;
+			qw[i] = w * inverseLength;
+		}
+	}
+
+}
+
+EntityStore::EntityStore()
+{
+}
+
+EntityStore::Entity EntityStore::Create(const glm::vec3& position, const glm::quat& rotation, float entityScale,
+	unsigned int entityMesh, unsigned int entityMaterial)
+{
+	Entity entity;
+	if (!m_FreeEntities.empty()) {
+		entity = m_FreeEntities.back();
+		m_FreeEntities.pop_back();
+	} else {
+		entity = (Entity)m_Indices.size();
+		m_Indices.push_back(0);
+	}
+
+	m_Indices[entity] = this->GetCount();
+	m_Entities.push_back(entity);
+
+	positionX.push_back(position.x);
+	positionY.push_back(position.y);
+	positionZ.push_back(position.z);
+	rotationX.push_back(rotation.x);
+	rotationY.push_back(rotation.y);
+	rotationZ.push_back(rotation.z);
+	rotationW.push_back(rotation.w);
+	angularVelocityX.push_back(0.0f);
+	angularVelocityY.push_back(0.0f);
+	angularVelocityZ.push_back(0.0f);
+	scale.push_back(entityScale);
+	mesh.push_back(entityMesh);
+	material.push_back(entityMaterial);
+	bounds.Add(position, 0.0f);
+
+	return entity;
+}
+
+void EntityStore::Destroy(Entity entity)
+{
+	unsigned int index = m_Indices[entity];
+
+	/* The last entity fills the hole, the arrays stay dense */
+	MoveLast(positionX, index);
+	MoveLast(positionY, index);
+	MoveLast(positionZ, index);
+	MoveLast(rotationX, index);
+	MoveLast(rotationY, index);
+	MoveLast(rotationZ, index);
+	MoveLast(rotationW, index);
+	MoveLast(angularVelocityX, index);
+	MoveLast(angularVelocityY, index);
+	MoveLast(angularVelocityZ, index);
+	MoveLast(scale, index);
+	MoveLast(mesh, index);
+	MoveLast(material, index);
+	MoveLast(bounds.centerX, index);
+	MoveLast(bounds.centerY, index);
+	MoveLast(bounds.centerZ, index);
+	MoveLast(bounds.radius, index);
+
+	Entity moved = m_Entities.back();
+	MoveLast(m_Entities, index);
+	m_Indices[moved] = index;
+
+	m_FreeEntities.push_back(entity);
+}
+
+void EntityStore::Reserve(unsigned int count)
+{
+	positionX.reserve(count);
+	positionY.reserve(count);
+	positionZ.reserve(count);
+	rotationX.reserve(count);
+	rotationY.reserve(count);
+	rotationZ.reserve(count);
+	rotationW.reserve(count);
+	angularVelocityX.reserve(count);
+	angularVelocityY.reserve(count);
+	angularVelocityZ.reserve(count);
+	scale.reserve(count);
+	mesh.reserve(count);
+	material.reserve(count);
+	bounds.Reserve(count);
+	m_Entities.reserve(count);
+	m_Indices.reserve(count);
+}
+
+void EntityStore::Clear()
+{
+	positionX.clear();
+	positionY.clear();
+	positionZ.clear();
+	rotationX.clear();
+	rotationY.clear();
+	rotationZ.clear();
+	rotationW.clear();
+	angularVelocityX.clear();
+	angularVelocityY.clear();
+	angularVelocityZ.clear();
+	scale.clear();
+	mesh.clear();
+	material.clear();
+	bounds.Clear();
+	m_Entities.clear();
+	m_Indices.clear();
+	m_FreeEntities.clear();
+}
+
+void EntityStore::SetPosition(unsigned int index, const glm::vec3& position)
+{
+	positionX[index] = position.x;
+	positionY[index] = position.y;
+	positionZ[index] = position.z;
+}
+
+void EntityStore::SetRotation(unsigned int index, const glm::quat& rotation)
+{
+	rotationX[index] = rotation.x;
+	rotationY[index] = rotation.y;
+	rotationZ[index] = rotation.z;
+	rotationW[index] = rotation.w;
+}
+
+void EntityStore::SetAngularVelocity(unsigned int index, const glm::vec3& angularVelocity)
+{
+	angularVelocityX[index] = angularVelocity.x;
+	angularVelocityY[index] = angularVelocity.y;
+	angularVelocityZ[index] = angularVelocity.z;
+}
+
+void EntityStore::Integrate(float deltaTime)
+{
+	IntegrateRotations(this->GetCount(), 0.5f * deltaTime,
+		rotationX.data(), rotationY.data(), rotationZ.data(), rotationW.data(),
+		angularVelocityX.data(), angularVelocityY.data(), angularVelocityZ.data());
+}
+
+void EntityStore::ComputeWorldMatrices(std::vector<glm::mat4>& worldMatrices) const
+{
+	const unsigned int count = this->GetCount();
+	worldMatrices.resize(count);
+
+	for (unsigned int i = 0; i < count; ++i) {
+		float x = rotationX[i], y = rotationY[i], z = rotationZ[i], w = rotationW[i];
+		float s = scale[i];
+
+		/* Rotation matrix of a unit quaternion, columns scaled */
+		glm::mat4& m = worldMatrices[i];
+		m[0] = glm::vec4(s * (1.0f - 2.0f * (y * y + z * z)), s * 2.0f * (x * y + w * z), s * 2.0f * (x * z - w * y), 0.0f);
+		m[1] = glm::vec4(s * 2.0f * (x * y - w * z), s * (1.0f - 2.0f * (x * x + z * z)), s * 2.0f * (y * z + w * x), 0.0f);
+		m[2] = glm::vec4(s * 2.0f * (x * z + w * y), s * 2.0f * (y * z - w * x), s * (1.0f - 2.0f * (x * x + y * y)), 0.0f);
+		m[3] = glm::vec4(positionX[i], positionY[i], positionZ[i], 1.0f);
+	}
+}
+
+void EntityStore::UpdateBounds(const std::vector<float>& meshesRadii)
+{
+	const unsigned int count = this->GetCount();
+
+	bounds.centerX = positionX;
+	bounds.centerY = positionY;
+	bounds.centerZ = positionZ;
+	for (unsigned int i = 0; i < count; ++i) {
+		bounds.radius[i] = scale[i] * meshesRadii[mesh[i]];
+	}
+}
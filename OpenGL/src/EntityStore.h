@@ -0,0 +1,63 @@
+#pragma once
+
+#include <vector>
+#include "glm/glm.hpp"
+#include "glm/gtc/quaternion.hpp"
+
+#include "FrustumCulling.h"
+
+/*
+	Per-object state as dense structure of arrays, one float per array per entity.
+	Entities are packed at the front of the arrays, destroying one moves the last entity in its slot,
+	so loops run over [0, GetCount()) without holes and the compiler can vectorize them.
+	Handles stay valid when the entities move, GetIndex() gives the current slot.
+*/
+class EntityStore
+{
+public:
+	typedef unsigned int Entity;
+	static constexpr Entity INVALID_ENTITY = 0xFFFFFFFF;
+
+	EntityStore();
+
+	Entity Create(const glm::vec3& position, const glm::quat& rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f), float entityScale = 1.0f,
+		unsigned int entityMesh = 0, unsigned int entityMaterial = 0);
+	void Destroy(Entity entity);
+	void Reserve(unsigned int count);
+	void Clear();
+
+	inline unsigned int GetCount() const { return (unsigned int)m_Entities.size(); }
+	inline unsigned int GetIndex(Entity entity) const { return m_Indices[entity]; }
+	inline Entity GetEntity(unsigned int index) const { return m_Entities[index]; }
+
+	inline glm::vec3 GetPosition(unsigned int index) const { return glm::vec3(positionX[index], positionY[index], positionZ[index]); }
+	inline glm::quat GetRotation(unsigned int index) const { return glm::quat(rotationW[index], rotationX[index], rotationY[index], rotationZ[index]); }
+	void SetPosition(unsigned int index, const glm::vec3& position);
+	void SetRotation(unsigned int index, const glm::quat& rotation);
+	/* World space axis times radians per second */
+	void SetAngularVelocity(unsigned int index, const glm::vec3& angularVelocity);
+
+	/* Spins every entity by its angular velocity */
+	void Integrate(float deltaTime);
+	/* translate * rotate * scale of every entity, worldMatrices is resized to GetCount() */
+	void ComputeWorldMatrices(std::vector<glm::mat4>& worldMatrices) const;
+	/* Bounding spheres from the positions and the scaled radius of each mesh, meshesRadii is indexed by the mesh component */
+	void UpdateBounds(const std::vector<float>& meshesRadii);
+
+	/* Components, indexed by GetIndex() */
+	std::vector<float> positionX, positionY, positionZ;
+	std::vector<float> rotationX, rotationY, rotationZ, rotationW;
+	std::vector<float> angularVelocityX, angularVelocityY, angularVelocityZ;
+	/* Uniform scale, enough for bounding spheres */
+	std::vector<float> scale;
+	std::vector<unsigned int> mesh;
+	/* Index in a material table owned by the scene */
+	std::vector<unsigned int> material;
+	BoundingSpheres bounds;
+
+private:
+	/* Slot to entity and entity to slot */
+	std::vector<Entity> m_Entities;
+	std::vector<unsigned int> m_Indices;
+	std::vector<Entity> m_FreeEntities;
+};
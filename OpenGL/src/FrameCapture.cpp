@@ -0,0 +1,276 @@
+#include "FrameCapture.h"
+
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+
+#include "stb/stb_image.h"
+#include "stb/stb_image_write.h"
+
+/* Same as the frame pacer: blocking waits give up after this long and try again */
+static constexpr GLuint64 FENCE_TIMEOUT_NANOSECONDS = 1000000000;
+/* Readbacks are RGBA, the alpha of the window is meaningless and dropped by the encoder */
+static constexpr unsigned int BYTES_PER_PIXEL = 4;
+
+FrameCapture::FrameCapture(const std::string& path, int width, int height, unsigned int fps)
+	: m_Path(path), m_Format(GetFormat(path)), m_Width(width), m_Height(height), m_FPS(std::max(1u, fps)),
+	m_FirstReadback(0), m_ReadbacksCount(0), m_CapturedCount(0), m_Encoding(false), m_Running(true), m_Failed(false)
+{
+	const long long size = (long long)width * height * BYTES_PER_PIXEL;
+	for (Readback& readback : m_Readbacks) {
+		GLCheckErrorCall(glGenBuffers(1, &readback.buffer));
+		GLCheckErrorCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer));
+		/* Written by the GPU, read by the CPU once */
+		GLCheckErrorCall(glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ));
+		readback.fence = 0;
+		readback.frame = 0;
+		Renderer::AddMemory(size);
+	}
+	GLCheckErrorCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+
+	if (Y4M == m_Format) {
+		m_Video.open(path, std::ios::binary);
+		if (!m_Video) {
+			std::cout << "Cannot write " << path << std::endl;
+			m_Failed = true;
+		} else {
+			/* Full chroma, no subsampling to get wrong with odd sizes */
+			m_Video << "YUV4MPEG2 W" << width << " H" << height << " F" << m_FPS << ":1 Ip A1:1 C444\n";
+		}
+	}
+
+	m_Encoder = std::thread(&FrameCapture::EncoderLoop, this);
+}
+
+FrameCapture::~FrameCapture()
+{
+	Flush();
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Running = false;
+	}
+	m_Condition.notify_all();
+	m_Encoder.join();
+
+	const long long size = (long long)m_Width * m_Height * BYTES_PER_PIXEL;
+	for (Readback& readback : m_Readbacks) {
+		GLCheckErrorCall(glDeleteBuffers(1, &readback.buffer));
+		Renderer::AddMemory(-size);
+	}
+}
+
+void FrameCapture::Capture(unsigned int framebuffer)
+{
+	Readback& readback = m_Readbacks[(m_FirstReadback + m_ReadbacksCount) % RING_SIZE];
+
+	/* The draw framebuffer stays as it is, scenes drawing offscreen do not notice the capture */
+	GLint readFramebuffer = 0;
+	GLCheckErrorCall(glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &readFramebuffer));
+	GLCheckErrorCall(glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer));
+	GLCheckErrorCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer));
+	/* With a pack buffer bound the pointer is an offset in it, the call only queues the copy */
+	GLCheckErrorCall(glReadPixels(0, 0, m_Width, m_Height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+	GLCheckErrorCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+	GLCheckErrorCall(glBindFramebuffer(GL_READ_FRAMEBUFFER, readFramebuffer));
+
+	readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	readback.frame = m_CapturedCount++;
+	++m_ReadbacksCount;
+
+	while (m_ReadbacksCount > READBACK_DELAY) {
+		RetireOldestReadback();
+	}
+}
+
+void FrameCapture::Flush()
+{
+	while (m_ReadbacksCount) {
+		RetireOldestReadback();
+	}
+
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	m_Condition.wait(lock, [this]() { return m_Queue.empty() && !m_Encoding; });
+}
+
+FrameCapture::Format FrameCapture::GetFormat(const std::string& path)
+{
+	static const std::string VIDEO_EXTENSION = ".y4m";
+	const bool video = path.size() >= VIDEO_EXTENSION.size() && 0 == path.compare(path.size() - VIDEO_EXTENSION.size(), VIDEO_EXTENSION.size(), VIDEO_EXTENSION);
+	return video ? Y4M : PNG;
+}
+
+std::string FrameCapture::GetFramePath(const std::string& prefix, unsigned int frame)
+{
+	std::ostringstream path;
+	path << prefix << std::setw(5) << std::setfill('0') << frame << ".png";
+	return path.str();
+}
+
+void FrameCapture::RetireOldestReadback()
+{
+	Readback& readback = m_Readbacks[m_FirstReadback];
+
+	/* Usually signaled already, READBACK_DELAY frames were submitted after the copy */
+	GLenum status = GL_TIMEOUT_EXPIRED;
+	do {
+		status = glClientWaitSync(readback.fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_TIMEOUT_NANOSECONDS);
+	} while (GL_TIMEOUT_EXPIRED == status);
+	GLCheckErrorCall(glDeleteSync(readback.fence));
+	readback.fence = 0;
+
+	EncodedFrame encoded;
+	encoded.frame = readback.frame;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		if (!m_FreePixels.empty()) {
+			encoded.pixels = std::move(m_FreePixels.back());
+			m_FreePixels.pop_back();
+		}
+	}
+
+	const size_t size = (size_t)m_Width * m_Height * BYTES_PER_PIXEL;
+	encoded.pixels.resize(size);
+	GLCheckErrorCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer));
+	const void* pixels;
+	GLCheckErrorCall(pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT));
+	if (pixels) {
+		std::memcpy(encoded.pixels.data(), pixels, size);
+		GLCheckErrorCall(glUnmapBuffer(GL_PIXEL_PACK_BUFFER));
+	}
+	GLCheckErrorCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+
+	m_FirstReadback = (m_FirstReadback + 1) % RING_SIZE;
+	--m_ReadbacksCount;
+
+	if (!pixels) {
+		std::cout << "Failed to map the readback of frame " << encoded.frame << std::endl;
+		return;
+	}
+
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	m_Condition.wait(lock, [this]() { return m_Queue.size() < MAX_QUEUED_FRAMES; });
+	m_Queue.push_back(std::move(encoded));
+	lock.unlock();
+	m_Condition.notify_all();
+}
+
+void FrameCapture::EncoderLoop()
+{
+	std::vector<unsigned char> scratch;
+	while (true) {
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		m_Condition.wait(lock, [this]() { return !m_Queue.empty() || !m_Running; });
+		if (m_Queue.empty()) {
+			break;
+		}
+		EncodedFrame frame = std::move(m_Queue.front());
+		m_Queue.pop_front();
+		m_Encoding = true;
+		lock.unlock();
+		m_Condition.notify_all();
+
+		/* Reported once, the following frames are dropped */
+		if (!m_Failed) {
+			m_Failed = !(PNG == m_Format ? WritePNG(frame, scratch) : WriteY4M(frame, scratch));
+		}
+
+		lock.lock();
+		m_FreePixels.push_back(std::move(frame.pixels));
+		m_Encoding = false;
+		lock.unlock();
+		m_Condition.notify_all();
+	}
+}
+
+bool FrameCapture::WritePNG(const EncodedFrame& frame, std::vector<unsigned char>& scratch) const
+{
+	/* RGB rows top to bottom, the readback is RGBA from the bottom row up */
+	scratch.resize((size_t)m_Width * m_Height * 3);
+	unsigned char* destination = scratch.data();
+	for (int y = 0; y < m_Height; ++y) {
+		const unsigned char* source = &frame.pixels[(size_t)(m_Height - 1 - y) * m_Width * BYTES_PER_PIXEL];
+		for (int x = 0; x < m_Width; ++x, source += BYTES_PER_PIXEL) {
+			*destination++ = source[0];
+			*destination++ = source[1];
+			*destination++ = source[2];
+		}
+	}
+
+	const std::string path = GetFramePath(m_Path, frame.frame);
+	if (!stbi_write_png(path.c_str(), m_Width, m_Height, 3, scratch.data(), m_Width * 3)) {
+		std::cout << "Cannot write " << path << std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool FrameCapture::WriteY4M(const EncodedFrame& frame, std::vector<unsigned char>& scratch)
+{
+	/* BT.601 limited range, what players assume when the header does not say */
+	const size_t planeSize = (size_t)m_Width * m_Height;
+	scratch.resize(planeSize * 3);
+	unsigned char* yPlane = scratch.data();
+	unsigned char* uPlane = yPlane + planeSize;
+	unsigned char* vPlane = uPlane + planeSize;
+	for (int y = 0; y < m_Height; ++y) {
+		const unsigned char* source = &frame.pixels[(size_t)(m_Height - 1 - y) * m_Width * BYTES_PER_PIXEL];
+		for (int x = 0; x < m_Width; ++x, source += BYTES_PER_PIXEL) {
+			const int r = source[0], g = source[1], b = source[2];
+			const size_t i = (size_t)y * m_Width + x;
+			yPlane[i] = (unsigned char)(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+			uPlane[i] = (unsigned char)(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+			vPlane[i] = (unsigned char)(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+		}
+	}
+
+	m_Video << "FRAME\n";
+	m_Video.write((const char*)scratch.data(), scratch.size());
+	if (!m_Video) {
+		std::cout << "Cannot write " << m_Path << std::endl;
+		return false;
+	}
+	return true;
+}
+
+unsigned int FrameCapture::CompareWithGolden(const std::string& prefix, const std::string& goldenPrefix, unsigned int frames, int tolerance)
+{
+	unsigned int mismatches = 0;
+	for (unsigned int frame = 0; frame < frames; ++frame) {
+		const std::string path = GetFramePath(prefix, frame);
+		const std::string goldenPath = GetFramePath(goldenPrefix, frame);
+
+		int width, height, goldenWidth, goldenHeight, channels;
+		unsigned char* pixels = stbi_load(path.c_str(), &width, &height, &channels, 3);
+		unsigned char* goldenPixels = stbi_load(goldenPath.c_str(), &goldenWidth, &goldenHeight, &channels, 3);
+		if (!pixels || !goldenPixels) {
+			std::cout << "Cannot read " << (pixels ? goldenPath : path) << std::endl;
+			++mismatches;
+		} else if (width != goldenWidth || height != goldenHeight) {
+			std::cout << path << " is " << width << "x" << height << ", " << goldenPath << " is " << goldenWidth << "x" << goldenHeight << std::endl;
+			++mismatches;
+		} else {
+			unsigned int differentPixels = 0;
+			int maxDifference = 0;
+			for (size_t pixel = 0; pixel < (size_t)width * height; ++pixel) {
+				int difference = 0;
+				for (int channel = 0; channel < 3; ++channel) {
+					difference = std::max(difference, std::abs(pixels[pixel * 3 + channel] - goldenPixels[pixel * 3 + channel]));
+				}
+				if (difference > tolerance) {
+					++differentPixels;
+				}
+				maxDifference = std::max(maxDifference, difference);
+			}
+			if (differentPixels) {
+				std::cout << path << ": " << differentPixels << " pixels differ from " << goldenPath << ", by up to " << maxDifference << std::endl;
+				++mismatches;
+			}
+		}
+		stbi_image_free(pixels);
+		stbi_image_free(goldenPixels);
+	}
+	return mismatches;
+}
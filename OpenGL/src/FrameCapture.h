@@ -0,0 +1,106 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "Renderer.h"
+
+/*
+	Records the frames drawn to a framebuffer without stalling the pipeline.
+	glReadPixels into a pixel buffer object returns right away, the copy happens on the GPU in order
+	with the rest of the frame; the buffer is mapped READBACK_DELAY frames later, when the copy is
+	usually done, so the map does not wait for the GPU. The pixels then go to an encoder thread,
+	which flips the rows and writes them, one PNG per frame through stb_image_write or all of them in a Y4M video,
+	while the next frames are drawn.
+*/
+class FrameCapture
+{
+public:
+	enum Format {
+		PNG,
+		Y4M
+	};
+
+	/*
+		A path ending in .y4m gets a single video at fps frames per second,
+		any other is a prefix completed with the frame number and .png, e.g. captures/frame_00042.png.
+		The context must be current, the buffers are created right away.
+	*/
+	FrameCapture(const std::string& path, int width, int height, unsigned int fps);
+	/* Reads back and writes the frames still pending, the context must be current */
+	~FrameCapture();
+
+	/* Context thread: the width x height pixels at the origin of the framebuffer, 0 for the window */
+	void Capture(unsigned int framebuffer);
+	/* Context thread: waits for every frame captured so far to be written */
+	void Flush();
+
+	inline Format GetFormat() const { return m_Format; }
+	/* Y4M for paths ending in .y4m, PNG for the others */
+	static Format GetFormat(const std::string& path);
+	inline unsigned int GetCapturedCount() const { return m_CapturedCount; }
+	/* Path of the PNG of a frame, with the same numbering Capture uses */
+	static std::string GetFramePath(const std::string& prefix, unsigned int frame);
+
+	/*
+		Compares the first frames PNG captured with the prefix against the golden ones, same numbering.
+		Pixels whose channels differ by more than tolerance count as different,
+		returns how many frames have different pixels or could not be read.
+	*/
+	static unsigned int CompareWithGolden(const std::string& prefix, const std::string& goldenPrefix, unsigned int frames, int tolerance);
+
+private:
+	/* Frames captured before a buffer is mapped, a couple hide the copy on most drivers */
+	static constexpr unsigned int READBACK_DELAY = 2;
+	static constexpr unsigned int RING_SIZE = READBACK_DELAY + 1;
+	/* The capture waits for the encoder past this, a slow disk must not grow the memory without bound */
+	static constexpr unsigned int MAX_QUEUED_FRAMES = 8;
+
+	struct Readback
+	{
+		unsigned int buffer;
+		GLsync fence;
+		unsigned int frame;
+	};
+
+	struct EncodedFrame
+	{
+		unsigned int frame;
+		std::vector<unsigned char> pixels;
+	};
+
+	/* Maps the oldest pending readback and queues its pixels for the encoder */
+	void RetireOldestReadback();
+	void EncoderLoop();
+	bool WritePNG(const EncodedFrame& frame, std::vector<unsigned char>& scratch) const;
+	bool WriteY4M(const EncodedFrame& frame, std::vector<unsigned char>& scratch);
+
+	std::string m_Path;
+	Format m_Format;
+	int m_Width, m_Height;
+	unsigned int m_FPS;
+
+	/* Context thread: ring of the readbacks in flight, oldest first */
+	Readback m_Readbacks[RING_SIZE];
+	unsigned int m_FirstReadback;
+	unsigned int m_ReadbacksCount;
+	unsigned int m_CapturedCount;
+
+	std::thread m_Encoder;
+	std::mutex m_Mutex;
+	std::condition_variable m_Condition;
+	/* Guarded by m_Mutex: frames waiting for the encoder, and their buffers once written to be reused */
+	std::deque<EncodedFrame> m_Queue;
+	std::vector<std::vector<unsigned char>> m_FreePixels;
+	bool m_Encoding;
+	bool m_Running;
+
+	/* Encoder thread */
+	std::ofstream m_Video;
+	bool m_Failed;
+};
@@ -0,0 +1,168 @@
+#include "FramePacer.h"
+
+#include <cmath>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <GLFW/glfw3.h>
+
+#include "imgui/imgui.h"
+
+/* Blocking waits give up after this long and try again, a lost context must not hang the loop silently */
+static constexpr GLuint64 FENCE_TIMEOUT_NANOSECONDS = 1000000000;
+
+FramePacer::FramePacer(Mode mode, float targetFPS, unsigned int maxFramesInFlight)
+	: m_Mode(mode), m_TargetFPS(targetFPS), m_MaxFramesInFlight(std::min(std::max(1u, maxFramesInFlight), MAX_FRAMES_IN_FLIGHT)),
+	m_NextFrameTime(0.0), m_LastFrameTime(0.0), m_FrameTimesOffset(0), m_FrameTimesCount(0),
+	m_FirstFence(0), m_FencesCount(0), m_LatenciesOffset(0), m_LatenciesCount(0), m_FenceWaitMilliseconds(0.0f)
+{
+	/* Negative swap intervals are only allowed with this extension */
+	m_AdaptiveSupported = glfwExtensionSupported("WGL_EXT_swap_control_tear") || glfwExtensionSupported("GLX_EXT_swap_control_tear");
+
+	std::fill(m_FrameTimes, m_FrameTimes + HISTORY_SIZE, 0.0f);
+	std::fill(m_Latencies, m_Latencies + HISTORY_SIZE, 0.0f);
+	m_LastFrameTime = glfwGetTime();
+	SetMode(mode);
+}
+
+FramePacer::~FramePacer()
+{
+	while (m_FencesCount) {
+		RetireOldestFrame(true);
+	}
+}
+
+void FramePacer::SetMode(Mode mode)
+{
+	m_Mode = mode;
+	switch (mode) {
+	case VSYNC:
+		glfwSwapInterval(1);
+		break;
+	case ADAPTIVE_VSYNC:
+		/* Late frames are shown right away with tearing instead of waiting for the next refresh */
+		glfwSwapInterval(m_AdaptiveSupported ? -1 : 1);
+		break;
+	case UNCAPPED:
+	case LIMITED:
+		glfwSwapInterval(0);
+		break;
+	default:
+		break;
+	}
+	m_NextFrameTime = glfwGetTime();
+}
+
+void FramePacer::BeginFrame()
+{
+	double now = glfwGetTime();
+
+	if (LIMITED == m_Mode && m_TargetFPS > 0.0f) {
+		if (now < m_NextFrameTime) {
+			double sleepSeconds = m_NextFrameTime - now - SPIN_SECONDS;
+			if (sleepSeconds > 0.0) {
+				std::this_thread::sleep_for(std::chrono::duration<double>(sleepSeconds));
+			}
+			while ((now = glfwGetTime()) < m_NextFrameTime) {
+			}
+		}
+		/* A late frame moves the schedule instead of being followed by a burst of short ones */
+		m_NextFrameTime = std::max(m_NextFrameTime + 1.0 / m_TargetFPS, now);
+	}
+
+	m_FrameTimes[m_FrameTimesOffset] = (float)((now - m_LastFrameTime) * 1000.0);
+	m_FrameTimesOffset = (m_FrameTimesOffset + 1) % HISTORY_SIZE;
+	m_FrameTimesCount = std::min(m_FrameTimesCount + 1, HISTORY_SIZE);
+	m_LastFrameTime = now;
+}
+
+void FramePacer::EndFrame(double inputTimestamp)
+{
+	unsigned int last = (m_FirstFence + m_FencesCount) % (MAX_FRAMES_IN_FLIGHT + 1);
+	m_Fences[last] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	m_InputTimestamps[last] = inputTimestamp;
+	++m_FencesCount;
+
+	/* Frames already done give their latency without waiting */
+	while (m_FencesCount && RetireOldestFrame(false)) {
+	}
+
+	auto start = std::chrono::high_resolution_clock::now();
+	while (m_FencesCount > m_MaxFramesInFlight) {
+		RetireOldestFrame(true);
+	}
+	auto end = std::chrono::high_resolution_clock::now();
+	m_FenceWaitMilliseconds = std::chrono::duration<float, std::milli>(end - start).count();
+}
+
+bool FramePacer::RetireOldestFrame(bool wait)
+{
+	GLsync fence = m_Fences[m_FirstFence];
+	GLenum status = GL_TIMEOUT_EXPIRED;
+	do {
+		/* The flush makes sure the fence gets to the GPU, otherwise waiting on it could last forever */
+		status = glClientWaitSync(fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, wait ? FENCE_TIMEOUT_NANOSECONDS : 0);
+	} while (wait && GL_TIMEOUT_EXPIRED == status);
+
+	if (GL_TIMEOUT_EXPIRED == status) {
+		return false;
+	}
+
+	if (m_InputTimestamps[m_FirstFence] > 0.0) {
+		m_Latencies[m_LatenciesOffset] = (float)((glfwGetTime() - m_InputTimestamps[m_FirstFence]) * 1000.0);
+		m_LatenciesOffset = (m_LatenciesOffset + 1) % HISTORY_SIZE;
+		m_LatenciesCount = std::min(m_LatenciesCount + 1, HISTORY_SIZE);
+	}
+
+	GLCheckErrorCall(glDeleteSync(fence));
+	m_FirstFence = (m_FirstFence + 1) % (MAX_FRAMES_IN_FLIGHT + 1);
+	--m_FencesCount;
+	return true;
+}
+
+void FramePacer::OnImGuiRender()
+{
+	ImGui::Begin("Frame pacing");
+
+	int mode = m_Mode;
+	if (ImGui::Combo("Mode", &mode, MODE_NAMES, MODES_COUNT)) {
+		SetMode((Mode)mode);
+	}
+	if (ADAPTIVE_VSYNC == m_Mode && !m_AdaptiveSupported) {
+		ImGui::Text("swap_control_tear not supported, plain vsync");
+	}
+	if (LIMITED == m_Mode) {
+		ImGui::SliderFloat("Target FPS", &m_TargetFPS, 10.0f, 500.0f, "%.0f");
+	}
+	int maxFramesInFlight = (int)m_MaxFramesInFlight;
+	if (ImGui::SliderInt("Frames in flight", &maxFramesInFlight, 1, (int)MAX_FRAMES_IN_FLIGHT)) {
+		m_MaxFramesInFlight = (unsigned int)maxFramesInFlight;
+	}
+
+	/* Variance over the history, what the eye notices more than the average */
+	float mean = 0.0f, maxFrameTime = 0.0f;
+	for (unsigned int i = 0; i < m_FrameTimesCount; ++i) {
+		mean += m_FrameTimes[i];
+		maxFrameTime = std::max(maxFrameTime, m_FrameTimes[i]);
+	}
+	mean /= std::max(1u, m_FrameTimesCount);
+	float variance = 0.0f;
+	for (unsigned int i = 0; i < m_FrameTimesCount; ++i) {
+		variance += (m_FrameTimes[i] - mean) * (m_FrameTimes[i] - mean);
+	}
+	variance /= std::max(1u, m_FrameTimesCount);
+
+	ImGui::Text("Frame time %.3f ms, standard deviation %.3f ms, max %.3f ms", mean, std::sqrt(variance), maxFrameTime);
+	ImGui::PlotLines("Frame times", m_FrameTimes, HISTORY_SIZE, m_FrameTimesOffset, nullptr, 0.0f, std::max(1.0f, maxFrameTime), ImVec2(0.0f, 60.0f));
+
+	float meanLatency = 0.0f, maxLatency = 0.0f;
+	for (unsigned int i = 0; i < m_LatenciesCount; ++i) {
+		meanLatency += m_Latencies[i];
+		maxLatency = std::max(maxLatency, m_Latencies[i]);
+	}
+	meanLatency /= std::max(1u, m_LatenciesCount);
+	ImGui::Text("Input to GPU done %.3f ms, max %.3f ms", meanLatency, maxLatency);
+	ImGui::Text("%u frames in flight, waited %.3f ms on fences", m_FencesCount, m_FenceWaitMilliseconds);
+
+	ImGui::End();
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "Renderer.h"
+
+/*
+	Decides when frames start and how many the GPU may have queued, and measures the result.
+	Vsync modes leave the waiting to the swap; the limiter sleeps until just before the frame
+	is due and spins the rest, since sleeps are only accurate to a millisecond or worse.
+	Each submitted frame gets a fence: the CPU waits when too many of them are still pending,
+	which bounds the latency the driver queue adds. The latency is estimated from the oldest input
+	applied to a frame to when its fence is seen signaled, the display shows it at the next refresh at most.
+*/
+class FramePacer
+{
+public:
+	enum Mode {
+		VSYNC,
+		ADAPTIVE_VSYNC,
+		UNCAPPED,
+		LIMITED,
+		MODES_COUNT
+	};
+
+	static constexpr const char* MODE_NAMES[MODES_COUNT] = { "Vsync", "Adaptive vsync", "Uncapped", "Frame limiter" };
+	static constexpr unsigned int MAX_FRAMES_IN_FLIGHT = 8;
+
+	/* The context must be current, the swap interval is set right away */
+	FramePacer(Mode mode, float targetFPS, unsigned int maxFramesInFlight);
+	~FramePacer();
+
+	/* Context thread */
+	void SetMode(Mode mode);
+	inline Mode GetMode() const { return m_Mode; }
+	inline void SetTargetFPS(float targetFPS) { m_TargetFPS = targetFPS; }
+	inline void SetMaxFramesInFlight(unsigned int maxFramesInFlight) { m_MaxFramesInFlight = maxFramesInFlight; }
+
+	/* Start of every frame, on the main thread: waits for the limiter and measures the frame time */
+	void BeginFrame();
+	/*
+		After the frame was submitted, on the context thread: fences it and waits while too many frames are in flight.
+		inputTimestamp is the glfwGetTime of the oldest input the frame applied, 0 when there was none.
+	*/
+	void EndFrame(double inputTimestamp);
+
+	/* Mode selection and statistics, the context must be current */
+	void OnImGuiRender();
+
+private:
+	/* Sleeps stop this far before the frame is due, the rest is spent spinning */
+	static constexpr double SPIN_SECONDS = 0.002;
+	static constexpr unsigned int HISTORY_SIZE = 240;
+
+	/* Records the latency of the oldest fence if it is signaled, waiting for it when asked to */
+	bool RetireOldestFrame(bool wait);
+
+	Mode m_Mode;
+	float m_TargetFPS;
+	unsigned int m_MaxFramesInFlight;
+	bool m_AdaptiveSupported;
+
+	/* Main thread */
+	double m_NextFrameTime;
+	double m_LastFrameTime;
+	float m_FrameTimes[HISTORY_SIZE];
+	unsigned int m_FrameTimesOffset;
+	unsigned int m_FrameTimesCount;
+
+	/* Context thread: ring of the frames in flight, oldest first */
+	GLsync m_Fences[MAX_FRAMES_IN_FLIGHT + 1];
+	double m_InputTimestamps[MAX_FRAMES_IN_FLIGHT + 1];
+	unsigned int m_FirstFence;
+	unsigned int m_FencesCount;
+	float m_Latencies[HISTORY_SIZE];
+	unsigned int m_LatenciesOffset;
+	unsigned int m_LatenciesCount;
+	/* Time spent blocked on fences by the last frame */
+	float m_FenceWaitMilliseconds;
+};
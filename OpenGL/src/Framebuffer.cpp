@@ -0,0 +1,47 @@
+#include "Framebuffer.h"
+
+#include "Renderer.h"
+
+Framebuffer::Framebuffer(int width, int height) : m_Width(width), m_Height(height)
+{
+	GLCheckErrorCall(glGenRenderbuffers(1, &m_ColorRenderbuffer));
+	GLCheckErrorCall(glBindRenderbuffer(GL_RENDERBUFFER, m_ColorRenderbuffer));
+	GLCheckErrorCall(glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height));
+
+	GLCheckErrorCall(glGenRenderbuffers(1, &m_DepthRenderbuffer));
+	GLCheckErrorCall(glBindRenderbuffer(GL_RENDERBUFFER, m_DepthRenderbuffer));
+	GLCheckErrorCall(glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height));
+	GLCheckErrorCall(glBindRenderbuffer(GL_RENDERBUFFER, 0));
+
+	GLCheckErrorCall(glGenFramebuffers(1, &m_RendererID));
+	GLCheckErrorCall(glBindFramebuffer(GL_FRAMEBUFFER, m_RendererID));
+	GLCheckErrorCall(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_ColorRenderbuffer));
+	GLCheckErrorCall(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_DepthRenderbuffer));
+	GLCheckErrorCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+}
+
+Framebuffer::~Framebuffer()
+{
+	GLCheckErrorCall(glDeleteFramebuffers(1, &m_RendererID));
+	GLCheckErrorCall(glDeleteRenderbuffers(1, &m_ColorRenderbuffer));
+	GLCheckErrorCall(glDeleteRenderbuffers(1, &m_DepthRenderbuffer));
+}
+
+void Framebuffer::Bind() const
+{
+	GLCheckErrorCall(glBindFramebuffer(GL_FRAMEBUFFER, m_RendererID));
+	GLCheckErrorCall(glViewport(0, 0, m_Width, m_Height));
+}
+
+void Framebuffer::Unbind()
+{
+	GLCheckErrorCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+}
+
+bool Framebuffer::IsComplete() const
+{
+	GLCheckErrorCall(glBindFramebuffer(GL_FRAMEBUFFER, m_RendererID));
+	GLenum status;
+	GLCheckErrorCall(status = glCheckFramebufferStatus(GL_FRAMEBUFFER));
+	return GL_FRAMEBUFFER_COMPLETE == status;
+}
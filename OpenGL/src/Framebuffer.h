@@ -0,0 +1,27 @@
+#pragma once
+
+/*
+	Offscreen render target with a color and a depth-stencil renderbuffer.
+	While it is bound, everything drawn goes to it instead of the window.
+*/
+class Framebuffer
+{
+private:
+	unsigned int m_RendererID;
+	unsigned int m_ColorRenderbuffer;
+	unsigned int m_DepthRenderbuffer;
+	int m_Width, m_Height;
+public:
+	Framebuffer(int width, int height);
+	~Framebuffer();
+
+	/* Also sets the viewport to the whole framebuffer */
+	void Bind() const;
+	/* Back to the default framebuffer, the window one */
+	static void Unbind();
+	bool IsComplete() const;
+
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline int GetWidth() const { return m_Width; }
+	inline int GetHeight() const { return m_Height; }
+};
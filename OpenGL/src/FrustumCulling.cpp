@@ -0,0 +1,290 @@
+#include "FrustumCulling.h"
+
+#include <cmath>
+
+#if defined(__AVX__)
+#define FRUSTUM_CULLING_AVX
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FRUSTUM_CULLING_SSE
+#include <emmintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace {
+
+	/* Index of the lowest bit set, mask must not be 0 */
+	inline unsigned int LowestBit(unsigned int mask)
+	{
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanForward(&index, mask);
+		return (unsigned int)index;
+#else
+		return (unsigned int)__builtin_ctz(mask);
+#endif
+	}
+
+	/* Appends base + i for every bit i set in mask */
+	inline unsigned int* WriteVisible(unsigned int* output, unsigned int base, unsigned int mask)
+	{
+		while (0 != mask) {
+			*output++ = base + LowestBit(mask);
+			mask &= mask - 1;
+		}
+		return output;
+	}
+
+	inline bool IsSphereVisible(const Frustum& frustum, float x, float y, float z, float r)
+	{
+		for (const glm::vec4& plane : frustum.planes) {
+			if (plane.x * x + plane.y * y + plane.z * z + plane.w < -r) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	inline bool IsBoxVisible(const Frustum& frustum, float x, float y, float z, float ex, float ey, float ez)
+	{
+		/* The box corner farthest along the plane normal decides */
+		for (const glm::vec4& plane : frustum.planes) {
+			float distance = plane.x * x + plane.y * y + plane.z * z + plane.w;
+			float projectedExtent = std::abs(plane.x) * ex + std::abs(plane.y) * ey + std::abs(plane.z) * ez;
+			if (distance < -projectedExtent) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+}
+
+void BoundingSpheres::Add(const glm::vec3& center, float r)
+{
+	centerX.push_back(center.x);
+	centerY.push_back(center.y);
+	centerZ.push_back(center.z);
+	radius.push_back(r);
+}
+
+void BoundingSpheres::Set(unsigned int index, const glm::vec3& center, float r)
+{
+	centerX[index] = center.x;
+	centerY[index] = center.y;
+	centerZ[index] = center.z;
+	radius[index] = r;
+}
+
+void BoundingSpheres::Reserve(unsigned int count)
+{
+	centerX.reserve(count);
+	centerY.reserve(count);
+	centerZ.reserve(count);
+	radius.reserve(count);
+}
+
+void BoundingSpheres::Clear()
+{
+	centerX.clear();
+	centerY.clear();
+	centerZ.clear();
+	radius.clear();
+}
+
+void BoundingBoxes::Add(const glm::vec3& center, const glm::vec3& extent)
+{
+	centerX.push_back(center.x);
+	centerY.push_back(center.y);
+	centerZ.push_back(center.z);
+	extentX.push_back(extent.x);
+	extentY.push_back(extent.y);
+	extentZ.push_back(extent.z);
+}
+
+void BoundingBoxes::Set(unsigned int index, const glm::vec3& center, const glm::vec3& extent)
+{
+	centerX[index] = center.x;
+	centerY[index] = center.y;
+	centerZ[index] = center.z;
+	extentX[index] = extent.x;
+	extentY[index] = extent.y;
+	extentZ[index] = extent.z;
+}
+
+void BoundingBoxes::Reserve(unsigned int count)
+{
+	centerX.reserve(count);
+	centerY.reserve(count);
+	centerZ.reserve(count);
+	extentX.reserve(count);
+	extentY.reserve(count);
+	extentZ.reserve(count);
+}
+
+void BoundingBoxes::Clear()
+{
+	centerX.clear();
+	centerY.clear();
+	centerZ.clear();
+	extentX.clear();
+	extentY.clear();
+	extentZ.clear();
+}
+
+Frustum FrustumCulling::ExtractFrustum(const glm::mat4& viewProj)
+{
+	/* glm is column major: row i is (m[0][i], m[1][i], m[2][i], m[3][i]) */
+	auto row = [&viewProj](int i) { return glm::vec4(viewProj[0][i], viewProj[1][i], viewProj[2][i], viewProj[3][i]); };
+
+	Frustum frustum;
+	frustum.planes[Frustum::LEFT_PLANE] = row(3) + row(0);
+	frustum.planes[Frustum::RIGHT_PLANE] = row(3) - row(0);
+	frustum.planes[Frustum::BOTTOM_PLANE] = row(3) + row(1);
+	frustum.planes[Frustum::TOP_PLANE] = row(3) - row(1);
+	/* OpenGL clip space, depth goes from -w to w */
+	frustum.planes[Frustum::NEAR_PLANE] = row(3) + row(2);
+	frustum.planes[Frustum::FAR_PLANE] = row(3) - row(2);
+
+	for (glm::vec4& plane : frustum.planes) {
+		plane /= glm::length(glm::vec3(plane));
+	}
+
+	return frustum;
+}
+
+unsigned int FrustumCulling::Cull(const Frustum& frustum, const BoundingSpheres& spheres, std::vector<unsigned int>& visible)
+{
+	const unsigned int count = spheres.Size();
+	visible.resize(count);
+	unsigned int* output = visible.data();
+	unsigned int i = 0;
+
+#if defined(FRUSTUM_CULLING_AVX)
+	for (; i + 8 <= count; i += 8) {
+		const __m256 x = _mm256_loadu_ps(&spheres.centerX[i]);
+		const __m256 y = _mm256_loadu_ps(&spheres.centerY[i]);
+		const __m256 z = _mm256_loadu_ps(&spheres.centerZ[i]);
+		const __m256 negativeRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(&spheres.radius[i]));
+
+		__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+		for (const glm::vec4& plane : frustum.planes) {
+			__m256 distance = _mm256_add_ps(
+				_mm256_add_ps(_mm256_mul_ps(x, _mm256_set1_ps(plane.x)), _mm256_mul_ps(y, _mm256_set1_ps(plane.y))),
+				_mm256_add_ps(_mm256_mul_ps(z, _mm256_set1_ps(plane.z)), _mm256_set1_ps(plane.w)));
+			inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negativeRadius, _CMP_GE_OQ));
+		}
+
+		output = WriteVisible(output, i, (unsigned int)_mm256_movemask_ps(inside));
+	}
+#elif defined(FRUSTUM_CULLING_SSE)
+	for (; i + 4 <= count; i += 4) {
+		const __m128 x = _mm_loadu_ps(&spheres.centerX[i]);
+		const __m128 y = _mm_loadu_ps(&spheres.centerY[i]);
+		const __m128 z = _mm_loadu_ps(&spheres.centerZ[i]);
+		const __m128 negativeRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(&spheres.radius[i]));
+
+		__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		for (const glm::vec4& plane : frustum.planes) {
+			__m128 distance = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(plane.x)), _mm_mul_ps(y, _mm_set1_ps(plane.y))),
+				_mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(plane.z)), _mm_set1_ps(plane.w)));
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negativeRadius));
+		}
+
+		output = WriteVisible(output, i, (unsigned int)_mm_movemask_ps(inside));
+	}
+#endif
+
+	/* Leftovers that do not fill a register */
+	for (; i < count; ++i) {
+		if (IsSphereVisible(frustum, spheres.centerX[i], spheres.centerY[i], spheres.centerZ[i], spheres.radius[i])) {
+			*output++ = i;
+		}
+	}
+
+	visible.resize(output - visible.data());
+	return (unsigned int)visible.size();
+}
+
+unsigned int FrustumCulling::Cull(const Frustum& frustum, const BoundingBoxes& boxes, std::vector<unsigned int>& visible)
+{
+	const unsigned int count = boxes.Size();
+	visible.resize(count);
+	unsigned int* output = visible.data();
+	unsigned int i = 0;
+
+#if defined(FRUSTUM_CULLING_AVX)
+	const __m256 signMask = _mm256_set1_ps(-0.0f);
+	for (; i + 8 <= count; i += 8) {
+		const __m256 x = _mm256_loadu_ps(&boxes.centerX[i]);
+		const __m256 y = _mm256_loadu_ps(&boxes.centerY[i]);
+		const __m256 z = _mm256_loadu_ps(&boxes.centerZ[i]);
+		const __m256 ex = _mm256_loadu_ps(&boxes.extentX[i]);
+		const __m256 ey = _mm256_loadu_ps(&boxes.extentY[i]);
+		const __m256 ez = _mm256_loadu_ps(&boxes.extentZ[i]);
+
+		__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+		for (const glm::vec4& plane : frustum.planes) {
+			const __m256 nx = _mm256_set1_ps(plane.x), ny = _mm256_set1_ps(plane.y), nz = _mm256_set1_ps(plane.z);
+			__m256 distance = _mm256_add_ps(
+				_mm256_add_ps(_mm256_mul_ps(x, nx), _mm256_mul_ps(y, ny)),
+				_mm256_add_ps(_mm256_mul_ps(z, nz), _mm256_set1_ps(plane.w)));
+			__m256 projectedExtent = _mm256_add_ps(
+				_mm256_add_ps(_mm256_mul_ps(ex, _mm256_andnot_ps(signMask, nx)), _mm256_mul_ps(ey, _mm256_andnot_ps(signMask, ny))),
+				_mm256_mul_ps(ez, _mm256_andnot_ps(signMask, nz)));
+			inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(distance, projectedExtent), _mm256_setzero_ps(), _CMP_GE_OQ));
+		}
+
+		output = WriteVisible(output, i, (unsigned int)_mm256_movemask_ps(inside));
+	}
+#elif defined(FRUSTUM_CULLING_SSE)
+	const __m128 signMask = _mm_set1_ps(-0.0f);
+	for (; i + 4 <= count; i += 4) {
+		const __m128 x = _mm_loadu_ps(&boxes.centerX[i]);
+		const __m128 y = _mm_loadu_ps(&boxes.centerY[i]);
+		const __m128 z = _mm_loadu_ps(&boxes.centerZ[i]);
+		const __m128 ex = _mm_loadu_ps(&boxes.extentX[i]);
+		const __m128 ey = _mm_loadu_ps(&boxes.extentY[i]);
+		const __m128 ez = _mm_loadu_ps(&boxes.extentZ[i]);
+
+		__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		for (const glm::vec4& plane : frustum.planes) {
+			const __m128 nx = _mm_set1_ps(plane.x), ny = _mm_set1_ps(plane.y), nz = _mm_set1_ps(plane.z);
+			__m128 distance = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(x, nx), _mm_mul_ps(y, ny)),
+				_mm_add_ps(_mm_mul_ps(z, nz), _mm_set1_ps(plane.w)));
+			/* |n| by clearing the sign bit */
+			__m128 projectedExtent = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(ex, _mm_andnot_ps(signMask, nx)), _mm_mul_ps(ey, _mm_andnot_ps(signMask, ny))),
+				_mm_mul_ps(ez, _mm_andnot_ps(signMask, nz)));
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, projectedExtent), _mm_setzero_ps()));
+		}
+
+		output = WriteVisible(output, i, (unsigned int)_mm_movemask_ps(inside));
+	}
+#endif
+
+	for (; i < count; ++i) {
+		if (IsBoxVisible(frustum, boxes.centerX[i], boxes.centerY[i], boxes.centerZ[i], boxes.extentX[i], boxes.extentY[i], boxes.extentZ[i])) {
+			*output++ = i;
+		}
+	}
+
+	visible.resize(output - visible.data());
+	return (unsigned int)visible.size();
+}
+
+const char* FrustumCulling::GetInstructionSet()
+{
+#if defined(FRUSTUM_CULLING_AVX)
+	return "AVX";
+#elif defined(FRUSTUM_CULLING_SSE)
+	return "SSE2";
+#else
+	return "scalar";
+#endif
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <vector>
+#include "glm/glm.hpp"
+
+/* Planes as (normal, distance), normals point inside and are normalized, so plane . (p, 1) is a signed distance */
+struct Frustum
+{
+	/* NEAR and FAR would clash with the Windows headers */
+	enum Plane {
+		LEFT_PLANE,
+		RIGHT_PLANE,
+		BOTTOM_PLANE,
+		TOP_PLANE,
+		NEAR_PLANE,
+		FAR_PLANE,
+		PLANES_COUNT
+	};
+
+	glm::vec4 planes[PLANES_COUNT];
+};
+
+/* Bounding spheres as a structure of arrays, so that a SIMD register loads four or eight of them at once */
+struct BoundingSpheres
+{
+	std::vector<float> centerX, centerY, centerZ, radius;
+
+	void Add(const glm::vec3& center, float r);
+	void Set(unsigned int index, const glm::vec3& center, float r);
+	void Reserve(unsigned int count);
+	void Clear();
+	inline unsigned int Size() const { return (unsigned int)radius.size(); }
+};
+
+/* Axis aligned boxes as a structure of arrays, given by center and half extents */
+struct BoundingBoxes
+{
+	std::vector<float> centerX, centerY, centerZ, extentX, extentY, extentZ;
+
+	void Add(const glm::vec3& center, const glm::vec3& extent);
+	void Set(unsigned int index, const glm::vec3& center, const glm::vec3& extent);
+	void Reserve(unsigned int count);
+	void Clear();
+	inline unsigned int Size() const { return (unsigned int)extentX.size(); }
+};
+
+/*
+	Frustum culling of bounding volumes against the camera frustum.
+	Volumes are tested against all the planes eight at a time with AVX, four with SSE2,
+	and the indices of the visible ones are compacted into the output list.
+*/
+class FrustumCulling
+{
+public:
+	/* Gribb-Hartmann extraction, from proj * view for world space volumes */
+	static Frustum ExtractFrustum(const glm::mat4& viewProj);
+
+	/* visible is overwritten with the indices of the volumes intersecting the frustum, returns their count */
+	static unsigned int Cull(const Frustum& frustum, const BoundingSpheres& spheres, std::vector<unsigned int>& visible);
+	static unsigned int Cull(const Frustum& frustum, const BoundingBoxes& boxes, std::vector<unsigned int>& visible);
+
+	/* Instruction set picked at compile time */
+	static const char* GetInstructionSet();
+};
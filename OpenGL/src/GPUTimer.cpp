@@ -0,0 +1,57 @@
+#include "GPUTimer.h"
+
+#include "Renderer.h"
+
+GPUTimer::GPUTimer() : m_Current(0), m_ElapsedMilliseconds(0.0f)
+{
+	GLCheckErrorCall(glGenQueries(QUERIES_COUNT, m_Queries));
+	for (unsigned int i = 0; i < QUERIES_COUNT; ++i) {
+		m_Pending[i] = false;
+	}
+}
+
+GPUTimer::~GPUTimer()
+{
+	GLCheckErrorCall(glDeleteQueries(QUERIES_COUNT, m_Queries));
+}
+
+void GPUTimer::Begin()
+{
+	/* The ring is deep enough that this should almost never wait */
+	if (m_Pending[m_Current]) {
+		ReadResult(m_Current, true);
+	}
+
+	GLCheckErrorCall(glBeginQuery(GL_TIME_ELAPSED, m_Queries[m_Current]));
+}
+
+void GPUTimer::End()
+{
+	GLCheckErrorCall(glEndQuery(GL_TIME_ELAPSED));
+	m_Pending[m_Current] = true;
+	m_Current = (m_Current + 1) % QUERIES_COUNT;
+
+	/* Collect whatever is already available, oldest first */
+	for (unsigned int i = 0; i < QUERIES_COUNT; ++i) {
+		unsigned int query = (m_Current + i) % QUERIES_COUNT;
+		if (m_Pending[query]) {
+			ReadResult(query, false);
+		}
+	}
+}
+
+void GPUTimer::ReadResult(unsigned int query, bool wait)
+{
+	if (!wait) {
+		GLint available = 0;
+		GLCheckErrorCall(glGetQueryObjectiv(m_Queries[query], GL_QUERY_RESULT_AVAILABLE, &available));
+		if (!available) {
+			return;
+		}
+	}
+
+	GLuint64 elapsedNanoseconds = 0;
+	GLCheckErrorCall(glGetQueryObjectui64v(m_Queries[query], GL_QUERY_RESULT, &elapsedNanoseconds));
+	m_ElapsedMilliseconds = (float)(elapsedNanoseconds / 1.0e6);
+	m_Pending[query] = false;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+/*
+	Measures the GPU time spent between Begin and End with GL_TIME_ELAPSED queries.
+	Queries are recycled in a ring and read back a few frames later, so that
+	asking for the result never stalls the pipeline.
+*/
+class GPUTimer
+{
+public:
+	GPUTimer();
+	~GPUTimer();
+
+	void Begin();
+	void End();
+
+	/* Last available measure, in milliseconds */
+	inline float GetElapsedMilliseconds() const { return m_ElapsedMilliseconds; }
+
+private:
+	static constexpr unsigned int QUERIES_COUNT = 4;
+
+	void ReadResult(unsigned int query, bool wait);
+
+	unsigned int m_Queries[QUERIES_COUNT];
+	bool m_Pending[QUERIES_COUNT];
+	unsigned int m_Current;
+	float m_ElapsedMilliseconds;
+};
@@ -0,0 +1,187 @@
+#include "GeometryHeap.h"
+
+#include <iostream>
+#include <algorithm>
+
+#include "Renderer.h"
+#include "glm/gtc/packing.hpp"
+
+StaticMeshVertex StaticMeshVertex::Pack(const float* position, const float* normal, const float* uv)
+{
+	StaticMeshVertex vertex;
+
+	vertex.position[0] = glm::packHalf1x16(position[0]);
+	vertex.position[1] = glm::packHalf1x16(position[1]);
+	vertex.position[2] = glm::packHalf1x16(position[2]);
+	vertex.position[3] = glm::packHalf1x16(1.0f);
+
+	/* x in the lowest 10 bits, as GL_INT_2_10_10_10_REV expects */
+	vertex.normal = glm::packSnorm3x10_1x2(glm::vec4(normal[0], normal[1], normal[2], 0.0f));
+
+	vertex.uv[0] = glm::packHalf1x16(uv[0]);
+	vertex.uv[1] = glm::packHalf1x16(uv[1]);
+
+	return vertex;
+}
+
+GeometryHeap::GeometryHeap(const VertexBufferLayout& layout, unsigned int vertexCapacity, unsigned int indexCapacity) :
+	m_Layout(layout), m_VertexAllocator(vertexCapacity), m_IndexAllocator(indexCapacity)
+{
+	m_VertexArrayCache = VertexArrayCache::Get();
+
+	/* Creating the index buffer binds it, keep it away from the element array binding of other VAOs */
+	VertexArray::Unbind();
+
+	/* Reserve the storage only, meshes are uploaded later with glBufferSubData */
+	m_VertexBuffer = std::make_unique<VertexBuffer>(nullptr, (size_t)vertexCapacity * m_Layout.GetStride());
+	m_IndexBuffer = std::make_unique<IndexBuffer>(nullptr, indexCapacity);
+}
+
+GeometryHeap::~GeometryHeap() {}
+
+MeshAllocation GeometryHeap::Allocate(const void* vertices, unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount)
+{
+	MeshAllocation mesh = { 0, 0, 0, 0 };
+	if (0 == vertexCount || 0 == indexCount) {
+		return mesh;
+	}
+
+	unsigned int baseVertex = m_VertexAllocator.Allocate(vertexCount);
+	if (OffsetAllocator::INVALID_OFFSET == baseVertex) {
+		GrowVertices(m_VertexAllocator.GetCapacity() + vertexCount);
+		baseVertex = m_VertexAllocator.Allocate(vertexCount);
+	}
+
+	unsigned int firstIndex = m_IndexAllocator.Allocate(indexCount);
+	if (OffsetAllocator::INVALID_OFFSET == firstIndex) {
+		GrowIndices(m_IndexAllocator.GetCapacity() + indexCount);
+		firstIndex = m_IndexAllocator.Allocate(indexCount);
+	}
+
+	if (OffsetAllocator::INVALID_OFFSET == baseVertex || OffsetAllocator::INVALID_OFFSET == firstIndex) {
+		std::cout << "GeometryHeap: failed to allocate " << vertexCount << " vertices and " << indexCount << " indices" << std::endl;
+		if (OffsetAllocator::INVALID_OFFSET != baseVertex) {
+			m_VertexAllocator.Free(baseVertex);
+		}
+		if (OffsetAllocator::INVALID_OFFSET != firstIndex) {
+			m_IndexAllocator.Free(firstIndex);
+		}
+		return mesh;
+	}
+
+	/* Make sure the index buffer is written through our own VAO */
+	this->Bind();
+
+	const GLsizei stride = m_Layout.GetStride();
+	m_VertexBuffer->SetData(vertices, (size_t)baseVertex * stride, (size_t)vertexCount * stride);
+	m_IndexBuffer->SetData(indices, firstIndex, indexCount);
+
+	mesh.baseVertex = (GLint)baseVertex;
+	mesh.firstIndex = firstIndex;
+	mesh.count = (GLsizei)indexCount;
+	mesh.vertexCount = vertexCount;
+
+	return mesh;
+}
+
+MeshAllocation GeometryHeap::AllocateStaticMesh(const float* vertices, unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount)
+{
+	const unsigned int SOURCE_VERTEX_SIZE = 8;
+
+	std::vector<StaticMeshVertex> packed(vertexCount);
+	for (unsigned int i = 0; i < vertexCount; ++i) {
+		const float* vertex = &vertices[i * SOURCE_VERTEX_SIZE];
+		packed[i] = StaticMeshVertex::Pack(vertex, vertex + 3, vertex + 6);
+	}
+
+	return this->Allocate(packed.data(), vertexCount, indices, indexCount);
+}
+
+void GeometryHeap::Free(const MeshAllocation& mesh)
+{
+	if (!mesh.IsValid()) {
+		return;
+	}
+
+	m_VertexAllocator.Free((unsigned int)mesh.baseVertex);
+	m_IndexAllocator.Free(mesh.firstIndex);
+}
+
+void GeometryHeap::Bind() const
+{
+	m_VertexArrayCache->Bind(m_Layout, *m_VertexBuffer, m_IndexBuffer.get());
+}
+
+void GeometryHeap::Unbind()
+{
+	VertexArray::Unbind();
+}
+
+void GeometryHeap::Draw(const MeshAllocation& mesh) const
+{
+	const GLvoid* indicesOffset = reinterpret_cast<const GLvoid*>((size_t)mesh.firstIndex * sizeof(unsigned int));
+	GLCheckErrorCall(glDrawElementsBaseVertex(GL_TRIANGLES, mesh.count, GL_UNSIGNED_INT, indicesOffset, mesh.baseVertex));
+	Renderer::AddDrawCalls();
+}
+
+void GeometryHeap::MultiDraw(const MeshAllocation* meshes, unsigned int meshesCount) const
+{
+	m_MultiDrawCounts.resize(meshesCount);
+	m_MultiDrawOffsets.resize(meshesCount);
+	m_MultiDrawBaseVertices.resize(meshesCount);
+
+	for (unsigned int i = 0; i < meshesCount; ++i) {
+		m_MultiDrawCounts[i] = meshes[i].count;
+		m_MultiDrawOffsets[i] = reinterpret_cast<const GLvoid*>((size_t)meshes[i].firstIndex * sizeof(unsigned int));
+		m_MultiDrawBaseVertices[i] = meshes[i].baseVertex;
+	}
+
+	/* One call for all the meshes, no state change in between */
+	GLCheckErrorCall(glMultiDrawElementsBaseVertex(GL_TRIANGLES, m_MultiDrawCounts.data(), GL_UNSIGNED_INT,
+		m_MultiDrawOffsets.data(), meshesCount, m_MultiDrawBaseVertices.data()));
+	Renderer::AddDrawCalls();
+}
+
+std::shared_ptr<GeometryHeap> GeometryHeap::GetStaticMeshHeap()
+{
+	/*
+		Only a weak reference is kept here: the heap dies with the last mesh using it,
+		which is always before glfwTerminate destroys the OpenGL context.
+	*/
+	static std::weak_ptr<GeometryHeap> s_StaticMeshHeap;
+
+	std::shared_ptr<GeometryHeap> heap = s_StaticMeshHeap.lock();
+	if (!heap) {
+		heap = std::make_shared<GeometryHeap>(StaticMeshVertex::Format::Layout(), STATIC_MESH_VERTEX_CAPACITY, STATIC_MESH_INDEX_CAPACITY);
+		s_StaticMeshHeap = heap;
+	}
+
+	return heap;
+}
+
+void GeometryHeap::GrowVertices(unsigned int minCapacity)
+{
+	unsigned int oldCapacity = m_VertexAllocator.GetCapacity();
+	unsigned int newCapacity = std::max(2 * oldCapacity, minCapacity);
+	const GLsizei stride = m_Layout.GetStride();
+
+	std::unique_ptr<VertexBuffer> vertexBuffer = std::make_unique<VertexBuffer>(nullptr, (size_t)newCapacity * stride);
+	vertexBuffer->CopyFrom(*m_VertexBuffer, (size_t)oldCapacity * stride);
+	/* Deleting the old buffer evicts its VAO, the next Bind sets up the new one */
+	m_VertexBuffer = std::move(vertexBuffer);
+	m_VertexAllocator.Grow(newCapacity);
+}
+
+void GeometryHeap::GrowIndices(unsigned int minCapacity)
+{
+	unsigned int oldCapacity = m_IndexAllocator.GetCapacity();
+	unsigned int newCapacity = std::max(2 * oldCapacity, minCapacity);
+
+	/* The new buffer is bound on creation, do not attach it to any VAO */
+	VertexArray::Unbind();
+	std::unique_ptr<IndexBuffer> indexBuffer = std::make_unique<IndexBuffer>(nullptr, newCapacity);
+	indexBuffer->CopyFrom(*m_IndexBuffer, oldCapacity);
+	m_IndexBuffer = std::move(indexBuffer);
+
+	m_IndexAllocator.Grow(newCapacity);
+}
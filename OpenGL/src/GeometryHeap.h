@@ -0,0 +1,93 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <glad/glad.h>
+
+#include "VertexArray.h"
+#include "VertexArrayCache.h"
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+#include "VertexBufferLayout.h"
+#include "OffsetAllocator.h"
+
+/* A mesh living inside a GeometryHeap, indices are relative to baseVertex */
+struct MeshAllocation
+{
+	GLint baseVertex;
+	unsigned int firstIndex;
+	GLsizei count;
+	unsigned int vertexCount;
+
+	inline bool IsValid() const { return count > 0; }
+};
+
+/*
+	Vertex stored in the static mesh heap: 16 bytes instead of the 32 of the float layout.
+	Half floats are exact for the unit primitives, normals lose a little precision only.
+*/
+struct StaticMeshVertex
+{
+	using Format = VertexFormat<attrib::Half<4>, attrib::Int2101010Rev, attrib::Half<2>>;
+
+	GLhalf position[4];
+	GLuint normal;
+	GLhalf uv[2];
+
+	static StaticMeshVertex Pack(const float* position, const float* normal, const float* uv);
+};
+
+static_assert(sizeof(StaticMeshVertex) == StaticMeshVertex::Format::STRIDE, "StaticMeshVertex does not match its format");
+
+/*
+	Large vertex and index buffers shared by all the meshes with the same layout.
+	Meshes are sub-allocated inside them and drawn with glDrawElementsBaseVertex,
+	so they all share a single cached VAO and can be merged into a single multi-draw.
+*/
+class GeometryHeap
+{
+public:
+	GeometryHeap(const VertexBufferLayout& layout, unsigned int vertexCapacity, unsigned int indexCapacity);
+	~GeometryHeap();
+
+	MeshAllocation Allocate(const void* vertices, unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount);
+	/* Packs interleaved position (3), normal (3), uv (2) floats into StaticMeshVertex, this heap must use its layout */
+	MeshAllocation AllocateStaticMesh(const float* vertices, unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount);
+	void Free(const MeshAllocation& mesh);
+
+	void Bind() const;
+	static void Unbind();
+
+	void Draw(const MeshAllocation& mesh) const;
+	void MultiDraw(const MeshAllocation* meshes, unsigned int meshesCount) const;
+
+	inline unsigned int GetVertexCapacity() const { return m_VertexAllocator.GetCapacity(); }
+	inline unsigned int GetIndexCapacity() const { return m_IndexAllocator.GetCapacity(); }
+	inline unsigned int GetUsedVertices() const { return m_VertexAllocator.GetUsed(); }
+	inline unsigned int GetUsedIndices() const { return m_IndexAllocator.GetUsed(); }
+
+	/* Heap shared by the static meshes, made of StaticMeshVertex */
+	static std::shared_ptr<GeometryHeap> GetStaticMeshHeap();
+
+private:
+	static constexpr unsigned int STATIC_MESH_VERTEX_CAPACITY = 64 * 1024;
+	static constexpr unsigned int STATIC_MESH_INDEX_CAPACITY = 3 * STATIC_MESH_VERTEX_CAPACITY;
+
+	void GrowVertices(unsigned int minCapacity);
+	void GrowIndices(unsigned int minCapacity);
+
+	VertexBufferLayout m_Layout;
+
+	OffsetAllocator m_VertexAllocator;
+	OffsetAllocator m_IndexAllocator;
+
+	/* Declared before the buffers, so that it is still alive when they get deleted */
+	std::shared_ptr<VertexArrayCache> m_VertexArrayCache;
+	std::unique_ptr<VertexBuffer> m_VertexBuffer;
+	std::unique_ptr<IndexBuffer> m_IndexBuffer;
+
+	/* Scratch arrays for MultiDraw, kept around to avoid reallocations */
+	mutable std::vector<GLsizei> m_MultiDrawCounts;
+	mutable std::vector<const GLvoid*> m_MultiDrawOffsets;
+	mutable std::vector<GLint> m_MultiDrawBaseVertices;
+};
@@ -1,17 +1,38 @@
 #include "IndexBuffer.h"
 
+#include <vector>
+#include <iostream>
+#include <algorithm>
+
 #include "Renderer.h"
+#include "VertexArrayCache.h"
+
+static constexpr unsigned int MAX_SHORT_INDEX = 0xFFFF;
 
-IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int count) : m_Count(count)
+IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int count) : m_Count(count), m_Type(GL_UNSIGNED_INT)
 {
 	GLCheckErrorCall(glGenBuffers(1, &m_RendererID));
 	GLCheckErrorCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID));
-	GLCheckErrorCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(unsigned int), data, GL_STATIC_DRAW));
+
+	/* Use 16 bit indices if the mesh has few enough vertices */
+	if (data && count > 0 && *std::max_element(data, data + count) <= MAX_SHORT_INDEX) {
+		std::vector<GLushort> shortIndices(data, data + count);
+		m_Type = GL_UNSIGNED_SHORT;
+		GLCheckErrorCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(GLushort), shortIndices.data(), GL_STATIC_DRAW));
+		Renderer::AddMemory((long long)count * sizeof(GLushort));
+		return;
+	}
+
+	GLCheckErrorCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(GLuint), data, GL_STATIC_DRAW));
+	Renderer::AddMemory((long long)count * sizeof(GLuint));
 }
 
 IndexBuffer::~IndexBuffer()
 {
+	/* Vertex arrays have this buffer as element array binding, drop them from the cache */
+	VertexArrayCache::OnBufferDeleted(m_RendererID);
 	GLCheckErrorCall(glDeleteBuffers(1, &m_RendererID));
+	Renderer::AddMemory(-(long long)m_Count * GetIndexSize());
 }
 
 void IndexBuffer::Bind() const
@@ -28,3 +49,33 @@ bool IndexBuffer::IsBound() const
 {
 	return 0 != m_RendererID;
 }
+
+void IndexBuffer::SetData(const unsigned int* data, unsigned int first, unsigned int count)
+{
+	this->Bind();
+
+	if (GL_UNSIGNED_SHORT == m_Type) {
+		if (count > 0 && *std::max_element(data, data + count) > MAX_SHORT_INDEX) {
+			std::cout << "IndexBuffer: indices do not fit in a 16 bit index buffer" << std::endl;
+			return;
+		}
+
+		std::vector<GLushort> shortIndices(data, data + count);
+		GLCheckErrorCall(glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, first * sizeof(GLushort), count * sizeof(GLushort), shortIndices.data()));
+		return;
+	}
+
+	GLCheckErrorCall(glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, first * sizeof(GLuint), count * sizeof(GLuint), data));
+}
+
+void IndexBuffer::CopyFrom(const IndexBuffer& source, unsigned int count)
+{
+#ifdef _PR_DEBUG
+	ASSERT_AND_BREAK(source.m_Type == m_Type)
+#endif
+	GLCheckErrorCall(glBindBuffer(GL_COPY_READ_BUFFER, source.m_RendererID));
+	GLCheckErrorCall(glBindBuffer(GL_COPY_WRITE_BUFFER, m_RendererID));
+	GLCheckErrorCall(glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, count * GetIndexSize()));
+	GLCheckErrorCall(glBindBuffer(GL_COPY_READ_BUFFER, 0));
+	GLCheckErrorCall(glBindBuffer(GL_COPY_WRITE_BUFFER, 0));
+}
@@ -1,17 +1,31 @@
 #pragma once
 
+#include <glad/glad.h>
+
 class IndexBuffer
 {
 private:
 	unsigned int m_RendererID;
 	unsigned int m_Count;
+	GLenum m_Type;
 public:
+	/*
+		Indices are stored on 16 bits whenever they all fit, halving the buffer size.
+		Passing no data reserves a 32 bit buffer to be filled later with SetData.
+	*/
 	IndexBuffer(const unsigned int* data, unsigned int count);
 	~IndexBuffer();
 
 	void Bind() const;
 	static void Unbind();
 	bool IsBound() const;
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+
+	void SetData(const unsigned int* data, unsigned int first, unsigned int count);
+	void CopyFrom(const IndexBuffer& source, unsigned int count);
 
 	inline unsigned int GetCount() const { return m_Count; }
+	/* GL_UNSIGNED_SHORT or GL_UNSIGNED_INT, as expected by glDrawElements */
+	inline GLenum GetType() const { return m_Type; }
+	inline unsigned int GetIndexSize() const { return GL_UNSIGNED_SHORT == m_Type ? sizeof(GLushort) : sizeof(GLuint); }
 };
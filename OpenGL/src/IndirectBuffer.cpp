@@ -0,0 +1,70 @@
+#include "IndirectBuffer.h"
+
+#include "Renderer.h"
+#include <GLFW/glfw3.h>
+
+static constexpr GLenum DRAW_INDIRECT_BUFFER = 0x8F3F;
+
+typedef void (APIENTRYP PFNMULTIDRAWELEMENTSINDIRECTPROC)(GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride);
+
+static PFNMULTIDRAWELEMENTSINDIRECTPROC s_MultiDrawElementsIndirect = nullptr;
+
+static bool LoadMultiDrawIndirect()
+{
+	/* Commands use baseInstance, which comes with ARB_base_instance */
+	if (!glfwExtensionSupported("GL_ARB_multi_draw_indirect") || !glfwExtensionSupported("GL_ARB_base_instance")) {
+		return false;
+	}
+
+	s_MultiDrawElementsIndirect = (PFNMULTIDRAWELEMENTSINDIRECTPROC)glfwGetProcAddress("glMultiDrawElementsIndirect");
+
+	return nullptr != s_MultiDrawElementsIndirect;
+}
+
+IndirectBuffer::IndirectBuffer(const DrawElementsIndirectCommand* commands, unsigned int count) : m_Count(count)
+{
+	GLCheckErrorCall(glGenBuffers(1, &m_RendererID));
+	GLCheckErrorCall(glBindBuffer(DRAW_INDIRECT_BUFFER, m_RendererID));
+	GLCheckErrorCall(glBufferData(DRAW_INDIRECT_BUFFER, count * sizeof(DrawElementsIndirectCommand), commands, GL_STATIC_DRAW));
+	Renderer::AddMemory((long long)count * sizeof(DrawElementsIndirectCommand));
+}
+
+IndirectBuffer::~IndirectBuffer()
+{
+	GLCheckErrorCall(glDeleteBuffers(1, &m_RendererID));
+	Renderer::AddMemory(-(long long)m_Count * sizeof(DrawElementsIndirectCommand));
+}
+
+void IndirectBuffer::Bind() const
+{
+	GLCheckErrorCall(glBindBuffer(DRAW_INDIRECT_BUFFER, m_RendererID));
+}
+
+void IndirectBuffer::Unbind()
+{
+	GLCheckErrorCall(glBindBuffer(DRAW_INDIRECT_BUFFER, 0));
+}
+
+void IndirectBuffer::SetData(const DrawElementsIndirectCommand* commands, unsigned int first, unsigned int count)
+{
+	this->Bind();
+
+	GLCheckErrorCall(glBufferSubData(DRAW_INDIRECT_BUFFER, first * sizeof(DrawElementsIndirectCommand),
+		count * sizeof(DrawElementsIndirectCommand), commands));
+}
+
+void IndirectBuffer::MultiDraw(GLenum mode, GLenum indexType, unsigned int first, unsigned int count) const
+{
+	this->Bind();
+
+	/* With a buffer bound the pointer is an offset into it */
+	GLCheckErrorCall(s_MultiDrawElementsIndirect(mode, indexType,
+		reinterpret_cast<const void*>(first * sizeof(DrawElementsIndirectCommand)), (GLsizei)count, 0));
+	Renderer::AddDrawCalls();
+}
+
+bool IndirectBuffer::IsSupported()
+{
+	static const bool s_Supported = LoadMultiDrawIndirect();
+	return s_Supported;
+}
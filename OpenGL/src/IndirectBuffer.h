@@ -0,0 +1,41 @@
+#pragma once
+
+#include <glad/glad.h>
+
+/* Layout of the commands read by glMultiDrawElementsIndirect */
+struct DrawElementsIndirectCommand
+{
+	GLuint count;
+	GLuint instanceCount;
+	GLuint firstIndex;
+	GLint baseVertex;
+	GLuint baseInstance;
+};
+
+/*
+	Draw commands stored on the GPU, a whole list of them is issued with a single call.
+	ARB_multi_draw_indirect (core in OpenGL 4.3) is not part of our 3.3 loader,
+	check IsSupported before creating one.
+*/
+class IndirectBuffer
+{
+private:
+	unsigned int m_RendererID;
+	unsigned int m_Count;
+public:
+	IndirectBuffer(const DrawElementsIndirectCommand* commands, unsigned int count);
+	~IndirectBuffer();
+
+	void Bind() const;
+	static void Unbind();
+
+	void SetData(const DrawElementsIndirectCommand* commands, unsigned int first, unsigned int count);
+
+	/* Issues the commands [first, first + count), the vertex array and its index buffer must be bound */
+	void MultiDraw(GLenum mode, GLenum indexType, unsigned int first, unsigned int count) const;
+
+	inline unsigned int GetCount() const { return m_Count; }
+
+	/* Needs a current context, the entry point is loaded on the first call */
+	static bool IsSupported();
+};
@@ -0,0 +1,33 @@
+#include "InputQueue.h"
+
+InputQueue::InputQueue() : m_Head(0), m_Tail(0), m_Dropped(0), m_Events(new InputEvent[CAPACITY])
+{
+}
+
+bool InputQueue::Push(const InputEvent& event)
+{
+	unsigned int tail = m_Tail.load(std::memory_order_relaxed);
+	/* Indices wrap around the unsigned range, their difference is the number of events queued */
+	if (tail - m_Head.load(std::memory_order_acquire) >= CAPACITY) {
+		m_Dropped.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	m_Events[tail & MASK] = event;
+	/* The event must be written before the consumer sees the new tail */
+	m_Tail.store(tail + 1, std::memory_order_release);
+	return true;
+}
+
+bool InputQueue::Pop(InputEvent& event)
+{
+	unsigned int head = m_Head.load(std::memory_order_relaxed);
+	if (head == m_Tail.load(std::memory_order_acquire)) {
+		return false;
+	}
+
+	event = m_Events[head & MASK];
+	/* The slot can be reused by the producer once the new head is visible */
+	m_Head.store(head + 1, std::memory_order_release);
+	return true;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+/* What the window callbacks saw, in the order they saw it */
+struct InputEvent
+{
+	enum Type : unsigned char {
+		CURSOR_MOVED,
+		SCROLLED
+	};
+
+	Type type;
+	/* glfwGetTime when the callback ran, for input latency measures */
+	double timestamp;
+	/* Cursor position in window coordinates, or scroll offsets */
+	float x;
+	float y;
+};
+
+/*
+	Single producer, single consumer ring of input events, without locks: the window callbacks push,
+	the update pops. Head and tail are written by one side each, so a load-acquire of the other
+	side's index is all the synchronization needed. When the consumer falls behind by the whole
+	capacity, new events are dropped rather than blocking the callbacks.
+*/
+class InputQueue
+{
+public:
+	InputQueue();
+
+	/* Producer only, false when the queue is full */
+	bool Push(const InputEvent& event);
+	/* Consumer only, false when the queue is empty */
+	bool Pop(InputEvent& event);
+
+	inline unsigned int GetDroppedCount() const { return m_Dropped.load(std::memory_order_relaxed); }
+
+private:
+	static constexpr unsigned int CAPACITY = 1024;
+	static constexpr unsigned int MASK = CAPACITY - 1;
+	static_assert(0 == (CAPACITY & MASK), "CAPACITY must be a power of two");
+
+	/* Next event to pop, written by the consumer */
+	alignas(64) std::atomic<unsigned int> m_Head;
+	/* Next free slot, written by the producer */
+	alignas(64) std::atomic<unsigned int> m_Tail;
+	std::atomic<unsigned int> m_Dropped;
+	std::unique_ptr<InputEvent[]> m_Events;
+};
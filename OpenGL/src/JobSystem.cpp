@@ -0,0 +1,303 @@
+#include "JobSystem.h"
+
+#include <algorithm>
+
+static constexpr unsigned int NO_WORKER = 0xFFFFFFFF;
+
+/* Pool and queue owned by the current thread, if any */
+static thread_local const JobSystem* s_Pool = nullptr;
+static thread_local unsigned int s_Worker = NO_WORKER;
+
+JobGraph::Job JobGraph::Add(std::function<void()> work)
+{
+	m_Nodes.push_back(std::make_unique<Node>());
+	m_Nodes.back()->work = std::move(work);
+	return (Job)(m_Nodes.size() - 1);
+}
+
+void JobGraph::AddDependency(Job before, Job after)
+{
+	m_Nodes[before]->dependents.push_back(after);
+	++m_Nodes[after]->dependencies;
+}
+
+void JobGraph::Clear()
+{
+	m_Nodes.clear();
+}
+
+JobSystem::WorkStealingQueue::WorkStealingQueue() : m_Top(0), m_Bottom(0), m_Tasks(new std::atomic<Task*>[QUEUE_CAPACITY])
+{
+}
+
+bool JobSystem::WorkStealingQueue::Push(Task* task)
+{
+	long long bottom = m_Bottom.load(std::memory_order_relaxed);
+	long long top = m_Top.load(std::memory_order_acquire);
+	if (bottom - top >= (long long)QUEUE_CAPACITY) {
+		return false;
+	}
+
+	m_Tasks[bottom & MASK].store(task, std::memory_order_relaxed);
+	/* The task must be visible before the thieves see the new bottom */
+	std::atomic_thread_fence(std::memory_order_release);
+	m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+	return true;
+}
+
+JobSystem::Task* JobSystem::WorkStealingQueue::Pop()
+{
+	long long bottom = m_Bottom.load(std::memory_order_relaxed) - 1;
+	m_Bottom.store(bottom, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	long long top = m_Top.load(std::memory_order_relaxed);
+
+	if (top > bottom) {
+		/* Empty */
+		m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+		return nullptr;
+	}
+
+	Task* task = m_Tasks[bottom & MASK].load(std::memory_order_relaxed);
+	if (top == bottom) {
+		/* Last task, a thief may be taking it at the same time: whoever moves top wins */
+		if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+			task = nullptr;
+		}
+		m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+	}
+	return task;
+}
+
+JobSystem::Task* JobSystem::WorkStealingQueue::Steal()
+{
+	long long top = m_Top.load(std::memory_order_acquire);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	long long bottom = m_Bottom.load(std::memory_order_acquire);
+
+	if (top >= bottom) {
+		return nullptr;
+	}
+
+	Task* task = m_Tasks[top & MASK].load(std::memory_order_relaxed);
+	if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+		return nullptr;
+	}
+	return task;
+}
+
+JobSystem::JobSystem(unsigned int threadsCount) : m_Running(true), m_QueuedTasks(0)
+{
+	if (0 == threadsCount) {
+		threadsCount = std::max(1u, std::thread::hardware_concurrency());
+	}
+	m_ActiveThreads = threadsCount;
+
+	for (unsigned int i = 0; i < threadsCount; ++i) {
+		m_Queues.push_back(std::make_unique<WorkStealingQueue>());
+	}
+
+	/* The creating thread is worker 0, it works while waiting */
+	s_Pool = this;
+	s_Worker = 0;
+	for (unsigned int i = 1; i < threadsCount; ++i) {
+		m_Threads.emplace_back(&JobSystem::WorkerLoop, this, i);
+	}
+}
+
+JobSystem::~JobSystem()
+{
+	m_Running = false;
+	WakeWorkers();
+	for (std::thread& thread : m_Threads) {
+		thread.join();
+	}
+
+	if (this == s_Pool) {
+		s_Pool = nullptr;
+		s_Worker = NO_WORKER;
+	}
+}
+
+JobSystem& JobSystem::Get()
+{
+	static JobSystem s_JobSystem;
+	return s_JobSystem;
+}
+
+void JobSystem::SetActiveThreads(unsigned int activeThreads)
+{
+	m_ActiveThreads = std::min(std::max(activeThreads, 1u), this->GetThreadsCount());
+	WakeWorkers();
+}
+
+unsigned int JobSystem::GetWorkerIndex() const
+{
+	return this == s_Pool ? s_Worker : NO_WORKER;
+}
+
+void JobSystem::ParallelFor(unsigned int count, unsigned int minRange, const std::function<void(unsigned int begin, unsigned int end)>& work)
+{
+	if (0 == count) {
+		return;
+	}
+
+	unsigned int rangesCount = std::min(std::max(1u, count / std::max(1u, minRange)), m_ActiveThreads * RANGES_PER_THREAD);
+	if (rangesCount <= 1 || NO_WORKER == this->GetWorkerIndex()) {
+		work(0, count);
+		return;
+	}
+
+	std::vector<Task> tasks(rangesCount);
+	std::atomic<unsigned int> unfinished(rangesCount);
+	for (unsigned int range = 0; range < rangesCount; ++range) {
+		unsigned int begin = (unsigned int)((unsigned long long)count * range / rangesCount);
+		unsigned int end = (unsigned int)((unsigned long long)count * (range + 1) / rangesCount);
+		tasks[range] = { nullptr, &work, begin, end, &unfinished, nullptr, nullptr, 0 };
+	}
+
+	/* Pushed backwards: the owner pops the first ranges, the thieves take the last ones */
+	for (unsigned int range = rangesCount; range-- > 0;) {
+		Submit(&tasks[range]);
+	}
+	WakeWorkers();
+
+	WaitFor(unfinished);
+}
+
+void JobSystem::Run(JobGraph& graph)
+{
+	const unsigned int jobsCount = graph.GetJobsCount();
+	if (0 == jobsCount) {
+		return;
+	}
+
+	std::vector<Task> tasks(jobsCount);
+	std::atomic<unsigned int> unfinished(jobsCount);
+	for (unsigned int job = 0; job < jobsCount; ++job) {
+		JobGraph::Node& node = *graph.m_Nodes[job];
+		node.pending = node.dependencies;
+		tasks[job] = { &node.work, nullptr, 0, 0, &unfinished, &graph, tasks.data(), job };
+	}
+
+	for (unsigned int job = 0; job < jobsCount; ++job) {
+		if (0 == graph.m_Nodes[job]->dependencies) {
+			Submit(&tasks[job]);
+		}
+	}
+	WakeWorkers();
+
+	WaitFor(unfinished);
+}
+
+void JobSystem::Submit(Task* task)
+{
+	unsigned int worker = this->GetWorkerIndex();
+	if (NO_WORKER == worker) {
+		Execute(task);
+		return;
+	}
+
+	/* Counted first, so that a thief never sees it queued and not counted */
+	++m_QueuedTasks;
+	if (!m_Queues[worker]->Push(task)) {
+		--m_QueuedTasks;
+		Execute(task);
+	}
+}
+
+void JobSystem::Execute(Task* task)
+{
+	if (task->work) {
+		(*task->work)();
+	} else {
+		(*task->rangeWork)(task->begin, task->end);
+	}
+
+	/* The dependents are released before this job counts as done, so the waiting thread cannot return before they are queued */
+	if (task->graph) {
+		bool released = false;
+		for (JobGraph::Job dependent : task->graph->m_Nodes[task->job]->dependents) {
+			if (1 == task->graph->m_Nodes[dependent]->pending.fetch_sub(1, std::memory_order_acq_rel)) {
+				Submit(&task->graphTasks[dependent]);
+				released = true;
+			}
+		}
+		if (released) {
+			WakeWorkers();
+		}
+	}
+
+	task->unfinished->fetch_sub(1, std::memory_order_release);
+}
+
+JobSystem::Task* JobSystem::FindTask(unsigned int worker)
+{
+	const unsigned int queuesCount = (unsigned int)m_Queues.size();
+
+	Task* task = nullptr;
+	if (NO_WORKER != worker) {
+		task = m_Queues[worker]->Pop();
+	}
+
+	/* Every thread starts stealing from its neighbour, so that they do not all hit the same queue */
+	for (unsigned int i = 1; nullptr == task && i <= queuesCount; ++i) {
+		unsigned int victim = (NO_WORKER != worker ? worker + i : i) % queuesCount;
+		if (victim != worker) {
+			task = m_Queues[victim]->Steal();
+		}
+	}
+
+	if (task) {
+		--m_QueuedTasks;
+	}
+	return task;
+}
+
+void JobSystem::WaitFor(const std::atomic<unsigned int>& unfinished)
+{
+	const unsigned int worker = this->GetWorkerIndex();
+	while (unfinished.load(std::memory_order_acquire) > 0) {
+		Task* task = FindTask(worker);
+		if (task) {
+			Execute(task);
+		} else {
+			/* The last jobs are running on other threads */
+			std::this_thread::yield();
+		}
+	}
+}
+
+void JobSystem::WorkerLoop(unsigned int worker)
+{
+	s_Pool = this;
+	s_Worker = worker;
+
+	unsigned int idleSpins = 0;
+	while (m_Running) {
+		Task* task = worker < m_ActiveThreads ? FindTask(worker) : nullptr;
+		if (task) {
+			Execute(task);
+			idleSpins = 0;
+			continue;
+		}
+
+		if (++idleSpins < SPINS_BEFORE_SLEEP) {
+			std::this_thread::yield();
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(m_SleepMutex);
+		m_WakeUp.wait(lock, [this, worker]() { return !m_Running || (m_QueuedTasks > 0 && worker < m_ActiveThreads); });
+		idleSpins = 0;
+	}
+}
+
+void JobSystem::WakeWorkers()
+{
+	/* Taking the mutex orders the notification after the check of a worker about to sleep */
+	{
+		std::lock_guard<std::mutex> lock(m_SleepMutex);
+	}
+	m_WakeUp.notify_all();
+}
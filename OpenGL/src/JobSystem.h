@@ -0,0 +1,134 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <functional>
+#include <condition_variable>
+
+/*
+	Jobs with dependencies: a job starts once all the jobs it depends on are done.
+	Build it once and run it every frame, the graph is not consumed by JobSystem::Run.
+*/
+class JobGraph
+{
+public:
+	typedef unsigned int Job;
+
+	Job Add(std::function<void()> work);
+	/* after does not start before before is done */
+	void AddDependency(Job before, Job after);
+	void Clear();
+
+	inline unsigned int GetJobsCount() const { return (unsigned int)m_Nodes.size(); }
+
+private:
+	friend class JobSystem;
+
+	struct Node
+	{
+		std::function<void()> work;
+		std::vector<Job> dependents;
+		unsigned int dependencies = 0;
+		std::atomic<unsigned int> pending{ 0 };
+	};
+
+	/* Nodes hold atomics, they cannot move when the vector grows */
+	std::vector<std::unique_ptr<Node>> m_Nodes;
+};
+
+/*
+	Pool of worker threads stealing work from each other. Every thread owns a Chase-Lev deque:
+	it pushes and pops its own jobs at the bottom, without locks, while idle threads steal from the top.
+	The thread waiting for some work to finish runs jobs too, so nested ParallelFor calls cannot deadlock.
+	Jobs must not block on anything else than the job system. Threads out of the pool can use it too,
+	but their work runs serially on themselves.
+*/
+class JobSystem
+{
+public:
+	/* threadsCount 0 uses all the hardware threads, the creating thread included */
+	JobSystem(unsigned int threadsCount = 0);
+	~JobSystem();
+
+	/*
+		Runs work(begin, end) over ranges covering [0, count), at least minRange indices each,
+		returns when all of them are done.
+	*/
+	void ParallelFor(unsigned int count, unsigned int minRange, const std::function<void(unsigned int begin, unsigned int end)>& work);
+	/* Returns when all the jobs of the graph are done, the dependencies must not form cycles */
+	void Run(JobGraph& graph);
+
+	/* Threads taking jobs from now on, between 1 and GetThreadsCount: measures scaling without recreating the pool */
+	void SetActiveThreads(unsigned int activeThreads);
+	inline unsigned int GetActiveThreads() const { return m_ActiveThreads; }
+	inline unsigned int GetThreadsCount() const { return (unsigned int)m_Queues.size(); }
+
+	/* Pool shared by the whole application, created on first use by the main thread */
+	static JobSystem& Get();
+
+private:
+	/* Enough ranges per thread that the fast ones can steal from the slow ones */
+	static constexpr unsigned int RANGES_PER_THREAD = 4;
+	static constexpr unsigned int QUEUE_CAPACITY = 4096;
+	/* Failed steals before an idle worker goes to sleep */
+	static constexpr unsigned int SPINS_BEFORE_SLEEP = 64;
+
+	/* Either a graph job or a range of a ParallelFor, pointing to work owned by the caller waiting for it */
+	struct Task
+	{
+		const std::function<void()>* work;
+		const std::function<void(unsigned int, unsigned int)>* rangeWork;
+		unsigned int begin;
+		unsigned int end;
+		std::atomic<unsigned int>* unfinished;
+		/* Set for graph jobs, their dependents are released when they are done */
+		JobGraph* graph;
+		Task* graphTasks;
+		JobGraph::Job job;
+	};
+
+	/* Chase-Lev deque with a fixed capacity, Push fails when it is full */
+	class WorkStealingQueue
+	{
+	public:
+		WorkStealingQueue();
+
+		/* Owner only */
+		bool Push(Task* task);
+		Task* Pop();
+		/* Any thread */
+		Task* Steal();
+
+	private:
+		static constexpr long long MASK = QUEUE_CAPACITY - 1;
+		static_assert(0 == (QUEUE_CAPACITY & MASK), "QUEUE_CAPACITY must be a power of two");
+
+		alignas(64) std::atomic<long long> m_Top;
+		alignas(64) std::atomic<long long> m_Bottom;
+		std::unique_ptr<std::atomic<Task*>[]> m_Tasks;
+	};
+
+	void WorkerLoop(unsigned int worker);
+	/* Pushes on the queue of the calling thread, runs the task right away if the queue is full or there is none */
+	void Submit(Task* task);
+	void Execute(Task* task);
+	/* Own queue first, then the others, null when there is nothing to do */
+	Task* FindTask(unsigned int worker);
+	/* Runs jobs until unfinished gets to 0 */
+	void WaitFor(const std::atomic<unsigned int>& unfinished);
+	unsigned int GetWorkerIndex() const;
+	void WakeWorkers();
+
+	std::vector<std::unique_ptr<WorkStealingQueue>> m_Queues;
+	std::vector<std::thread> m_Threads;
+	std::atomic<unsigned int> m_ActiveThreads;
+	std::atomic<bool> m_Running;
+
+	/* Idle workers sleep here, m_QueuedTasks tells them whether there is something to steal */
+	std::mutex m_SleepMutex;
+	std::condition_variable m_WakeUp;
+	std::atomic<unsigned int> m_QueuedTasks;
+};
@@ -0,0 +1,70 @@
+#include "LODMesh.h"
+
+#include <cmath>
+#include <algorithm>
+#include <utility>
+
+LODMesh::LODMesh(const MeshData& mesh, unsigned int levelsCount) :
+	m_BoundingRadius(0.0f)
+{
+	m_Heap = GeometryHeap::GetStaticMeshHeap();
+
+	levelsCount = std::clamp(levelsCount, 1u, MAX_LEVELS);
+	std::vector<MeshLOD> levels = MeshSimplifier::BuildLODChain(mesh, levelsCount);
+
+	for (const MeshLOD& lod : levels) {
+		const MeshData& data = lod.mesh;
+		m_Levels.push_back({ m_Heap->AllocateStaticMesh(data.vertices.data(), data.GetVertexCount(), data.indices.data(), data.GetIndexCount()), lod.error });
+	}
+	m_Occluder = std::move(levels.back().mesh);
+
+	for (unsigned int i = 0; i < mesh.GetVertexCount(); ++i) {
+		const float* position = &mesh.vertices[(size_t)i * MeshData::VERTEX_SIZE];
+		m_BoundingRadius = std::max(m_BoundingRadius, glm::length(glm::vec3(position[0], position[1], position[2])));
+	}
+}
+
+LODMesh::~LODMesh()
+{
+	for (const Level& level : m_Levels) {
+		m_Heap->Free(level.mesh);
+	}
+}
+
+void LODMesh::Draw(unsigned int level) const
+{
+	m_Heap->Draw(m_Levels[std::min(level, this->GetLevelsCount() - 1)].mesh);
+}
+
+float LODMesh::ComputeScreenSize(const glm::mat4& proj, const glm::vec3& viewCenter, float radius)
+{
+	/* The camera looks down -Z, objects around the eye cover the whole screen */
+	float distance = -viewCenter.z;
+	if (distance <= radius) {
+		return 1.0f;
+	}
+
+	return radius * proj[1][1] / distance;
+}
+
+unsigned int LODMesh::SelectLevel(float screenSize, unsigned int currentLevel) const
+{
+	const unsigned int lastLevel = this->GetLevelsCount() - 1;
+	unsigned int level = std::min(currentLevel, lastLevel);
+
+	/* Switch only once past the threshold by the hysteresis band, in either direction */
+	while (level > 0 && screenSize > GetThreshold(level - 1) * (1.0f + HYSTERESIS)) {
+		--level;
+	}
+	while (level < lastLevel && screenSize < GetThreshold(level) * (1.0f - HYSTERESIS)) {
+		++level;
+	}
+
+	return level;
+}
+
+float LODMesh::GetThreshold(unsigned int level)
+{
+	/* Level i is meant for sizes between GetThreshold(i) and GetThreshold(i - 1) */
+	return LOD0_SCREEN_SIZE * std::ldexp(1.0f, -(int)level);
+}
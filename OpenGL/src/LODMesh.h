@@ -0,0 +1,65 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "glm/glm.hpp"
+#include "GeometryHeap.h"
+#include "MeshSimplifier.h"
+
+/*
+	Chain of simplified versions of a mesh, all living in the static mesh heap.
+	The level is picked from the size of the object on screen, with some hysteresis
+	so that objects sitting at a threshold distance do not flicker between two levels.
+*/
+class LODMesh
+{
+public:
+	static constexpr unsigned int LEVELS_DEFAULT = 4;
+	static constexpr unsigned int MAX_LEVELS = 5;
+
+	LODMesh(const MeshData& mesh, unsigned int levelsCount = LEVELS_DEFAULT);
+	~LODMesh();
+
+	LODMesh(const LODMesh&) = delete;
+	LODMesh& operator=(const LODMesh&) = delete;
+
+	/* The static mesh heap must be bound */
+	void Draw(unsigned int level) const;
+
+	inline unsigned int GetLevelsCount() const { return (unsigned int)m_Levels.size(); }
+	inline unsigned int GetIndexCount(unsigned int level) const { return (unsigned int)m_Levels[level].mesh.count; }
+	inline float GetError(unsigned int level) const { return m_Levels[level].error; }
+	/* Radius of the bounding sphere centered in the origin of the mesh */
+	inline float GetBoundingRadius() const { return m_BoundingRadius; }
+	/* Coarsest level kept in client memory, for the CPU occlusion culling */
+	inline const MeshData& GetOccluder() const { return m_Occluder; }
+
+	/*
+		Fraction of the viewport height covered by a sphere, centered in viewCenter (view space).
+		The projection matrix gives the field of view: proj[1][1] = 1 / tan(fov / 2).
+	*/
+	static float ComputeScreenSize(const glm::mat4& proj, const glm::vec3& viewCenter, float radius);
+
+	/* Level to draw an object covering screenSize of the viewport, currentLevel is the one it was drawn with last time */
+	unsigned int SelectLevel(float screenSize, unsigned int currentLevel) const;
+
+private:
+	/* Full detail above half the viewport height, every next level takes over at half the size */
+	static constexpr float LOD0_SCREEN_SIZE = 0.5f;
+	/* Relative band around each threshold where the current level is kept */
+	static constexpr float HYSTERESIS = 0.15f;
+
+	struct Level
+	{
+		MeshAllocation mesh;
+		float error;
+	};
+
+	static float GetThreshold(unsigned int level);
+
+	std::shared_ptr<GeometryHeap> m_Heap;
+	std::vector<Level> m_Levels;
+	MeshData m_Occluder;
+	float m_BoundingRadius;
+};
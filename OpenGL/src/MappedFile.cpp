@@ -0,0 +1,107 @@
+#include "MappedFile.h"
+
+#include <iostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& filepath) :
+	m_Data(nullptr), m_Size(0), m_Opened(false), m_FileHandle(INVALID_HANDLE_VALUE), m_MappingHandle(nullptr)
+{
+	m_FileHandle = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (INVALID_HANDLE_VALUE == m_FileHandle) {
+		std::cout << "Error while opening file " << filepath << std::endl;
+		return;
+	}
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(m_FileHandle, &size)) {
+		std::cout << "Error while reading the size of file " << filepath << std::endl;
+		return;
+	}
+	m_Size = (size_t)size.QuadPart;
+	m_Opened = true;
+
+	/* Empty files cannot be mapped */
+	if (0 == m_Size) {
+		return;
+	}
+
+	m_MappingHandle = CreateFileMappingA(m_FileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (nullptr == m_MappingHandle) {
+		std::cout << "Error while mapping file " << filepath << std::endl;
+		return;
+	}
+
+	m_Data = static_cast<const char*>(MapViewOfFile(m_MappingHandle, FILE_MAP_READ, 0, 0, 0));
+	if (nullptr == m_Data) {
+		std::cout << "Error while mapping file " << filepath << std::endl;
+	}
+}
+
+MappedFile::~MappedFile()
+{
+	if (nullptr != m_Data) {
+		UnmapViewOfFile(m_Data);
+	}
+	if (nullptr != m_MappingHandle) {
+		CloseHandle(m_MappingHandle);
+	}
+	if (INVALID_HANDLE_VALUE != m_FileHandle) {
+		CloseHandle(m_FileHandle);
+	}
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& filepath) :
+	m_Data(nullptr), m_Size(0), m_Opened(false)
+{
+	int fd = open(filepath.c_str(), O_RDONLY);
+	if (fd < 0) {
+		std::cout << "Error while opening file " << filepath << std::endl;
+		return;
+	}
+
+	struct stat info;
+	if (0 != fstat(fd, &info)) {
+		std::cout << "Error while reading the size of file " << filepath << std::endl;
+		close(fd);
+		return;
+	}
+	m_Size = (size_t)info.st_size;
+	m_Opened = true;
+
+	/* Empty files cannot be mapped */
+	if (m_Size > 0) {
+		void* data = mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (MAP_FAILED == data) {
+			std::cout << "Error while mapping file " << filepath << std::endl;
+		} else {
+			m_Data = static_cast<const char*>(data);
+			madvise(data, m_Size, MADV_SEQUENTIAL);
+		}
+	}
+
+	/* The mapping stays valid after the descriptor is closed */
+	close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+	if (nullptr != m_Data) {
+		munmap(const_cast<char*>(m_Data), m_Size);
+	}
+}
+
+#endif
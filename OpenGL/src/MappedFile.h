@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+/*
+	Read-only memory mapping of a whole file: pages are loaded by the OS on demand,
+	so large assets can be parsed in place without copying them into our own buffers.
+*/
+class MappedFile
+{
+public:
+	MappedFile(const std::string& filepath);
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	inline bool IsValid() const { return nullptr != m_Data || (m_Opened && 0 == m_Size); }
+	inline const char* GetData() const { return m_Data; }
+	inline size_t GetSize() const { return m_Size; }
+
+private:
+	const char* m_Data;
+	size_t m_Size;
+	bool m_Opened;
+
+#ifdef _WIN32
+	void* m_FileHandle;
+	void* m_MappingHandle;
+#endif
+};
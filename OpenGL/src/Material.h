@@ -0,0 +1,13 @@
+#pragma once
+
+#include "glm/glm.hpp"
+
+/* Phong parameters as plain data, shared by index and applied by the lighted shaders */
+struct Material
+{
+	glm::vec3 objectColor = glm::vec3(1.0f, 0.5f, 0.31f);
+	float ambientStrenght = 0.8f;
+	float diffuseStrenght = 1.0f;
+	float specularStrenght = 0.5f;
+	float specularShininess = 32.0f;
+};
@@ -0,0 +1,1170 @@
+#include "MeshImporter.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <chrono>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <iostream>
+#include <limits>
+#include <algorithm>
+
+#include "glm/glm.hpp"
+#include "MappedFile.h"
+#include "JobSystem.h"
+
+namespace {
+
+	/*
+		Text parsing helpers working on the mapped memory, which is not null terminated:
+		they never read past end and return the first character they did not consume.
+	*/
+	inline const char* SkipSpaces(const char* p, const char* end)
+	{
+		while (p < end && (' ' == *p || '\t' == *p)) {
+			++p;
+		}
+		return p;
+	}
+
+	inline const char* SkipLine(const char* p, const char* end)
+	{
+		while (p < end && '\n' != *p) {
+			++p;
+		}
+		return p < end ? p + 1 : end;
+	}
+
+	inline bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+
+	/* Locale independent and much faster than strtod, plenty for the decimal numbers found in OBJ and JSON */
+	const char* ParseDouble(const char* p, const char* end, double& value)
+	{
+		bool negative = false;
+		if (p < end && ('-' == *p || '+' == *p)) {
+			negative = '-' == *p;
+			++p;
+		}
+
+		double result = 0.0;
+		while (p < end && IsDigit(*p)) {
+			result = 10.0 * result + (*p - '0');
+			++p;
+		}
+
+		if (p < end && '.' == *p) {
+			++p;
+			double scale = 0.1;
+			while (p < end && IsDigit(*p)) {
+				result += scale * (*p - '0');
+				scale *= 0.1;
+				++p;
+			}
+		}
+
+		if (p < end && ('e' == *p || 'E' == *p)) {
+			++p;
+			bool negativeExponent = false;
+			if (p < end && ('-' == *p || '+' == *p)) {
+				negativeExponent = '-' == *p;
+				++p;
+			}
+			int exponent = 0;
+			while (p < end && IsDigit(*p)) {
+				exponent = 10 * exponent + (*p - '0');
+				++p;
+			}
+			result *= std::pow(10.0, negativeExponent ? -exponent : exponent);
+		}
+
+		value = negative ? -result : result;
+		return p;
+	}
+
+	inline const char* ParseFloat(const char* p, const char* end, float& value)
+	{
+		double result;
+		p = ParseDouble(SkipSpaces(p, end), end, result);
+		value = (float)result;
+		return p;
+	}
+
+	/* Returns p itself when there is no integer to parse */
+	const char* ParseInt(const char* p, const char* end, int& value)
+	{
+		const char* start = p;
+		bool negative = false;
+		if (p < end && ('-' == *p || '+' == *p)) {
+			negative = '-' == *p;
+			++p;
+		}
+
+		if (p >= end || !IsDigit(*p)) {
+			return start;
+		}
+
+		int result = 0;
+		while (p < end && IsDigit(*p)) {
+			result = 10 * result + (*p - '0');
+			++p;
+		}
+
+		value = negative ? -result : result;
+		return p;
+	}
+
+	/* ---------------------------------------- OBJ ---------------------------------------- */
+
+	/* Indices are 0-based, -1 when the attribute is missing */
+	struct ObjCorner
+	{
+		int position;
+		int uv;
+		int normal;
+		/* Bit per attribute set when the index is relative to the chunk, as for negative OBJ indices */
+		int relativeMask;
+
+		inline bool operator==(const ObjCorner& other) const
+		{
+			return position == other.position && uv == other.uv && normal == other.normal;
+		}
+	};
+
+	enum ObjAttribute {
+		OBJ_POSITION = 1 << 0,
+		OBJ_UV = 1 << 1,
+		OBJ_NORMAL = 1 << 2
+	};
+
+	/* A range of whole lines, parsed independently from the others */
+	struct ObjChunk
+	{
+		const char* begin;
+		const char* end;
+
+		std::vector<float> positions;
+		std::vector<float> uvs;
+		std::vector<float> normals;
+		/* Three per triangle */
+		std::vector<ObjCorner> corners;
+
+		/* Attributes declared by the previous chunks */
+		unsigned int positionsOffset;
+		unsigned int uvsOffset;
+		unsigned int normalsOffset;
+
+		/* Corners after deduplication, and the triangles indexing them */
+		std::vector<ObjCorner> vertices;
+		std::vector<unsigned int> indices;
+		unsigned int baseVertex;
+		unsigned int firstIndex;
+
+		bool valid;
+	};
+
+	int ResolveObjIndex(int index, unsigned int declared, int attribute, int& relativeMask)
+	{
+		if (index > 0) {
+			return index - 1;
+		}
+
+		/* Negative indices count backwards from the last attribute declared, which may lie in a previous chunk */
+		if (index < 0) {
+			relativeMask |= attribute;
+			return (int)declared + index;
+		}
+
+		return -1;
+	}
+
+	const char* ParseObjCorner(const char* p, const char* end, const ObjChunk& chunk, ObjCorner& corner)
+	{
+		corner = { -1, -1, -1, 0 };
+
+		int index = 0;
+		const char* next = ParseInt(p, end, index);
+		if (next == p) {
+			return p;
+		}
+		corner.position = ResolveObjIndex(index, (unsigned int)(chunk.positions.size() / 3), OBJ_POSITION, corner.relativeMask);
+		p = next;
+
+		/* v, v/vt, v//vn or v/vt/vn */
+		if (p < end && '/' == *p) {
+			++p;
+			index = 0;
+			p = ParseInt(p, end, index);
+			corner.uv = ResolveObjIndex(index, (unsigned int)(chunk.uvs.size() / 2), OBJ_UV, corner.relativeMask);
+
+			if (p < end && '/' == *p) {
+				++p;
+				index = 0;
+				p = ParseInt(p, end, index);
+				corner.normal = ResolveObjIndex(index, (unsigned int)(chunk.normals.size() / 3), OBJ_NORMAL, corner.relativeMask);
+			}
+		}
+
+		return p;
+	}
+
+	void ParseObjChunk(ObjChunk& chunk)
+	{
+		const char* p = chunk.begin;
+		const char* end = chunk.end;
+		float value;
+
+		while (p < end) {
+			p = SkipSpaces(p, end);
+
+			if (p + 1 < end && 'v' == p[0]) {
+				if (' ' == p[1] || '\t' == p[1]) {
+					p += 2;
+					for (int i = 0; i < 3; ++i) {
+						p = ParseFloat(p, end, value);
+						chunk.positions.push_back(value);
+					}
+				} else if ('n' == p[1]) {
+					p += 2;
+					for (int i = 0; i < 3; ++i) {
+						p = ParseFloat(p, end, value);
+						chunk.normals.push_back(value);
+					}
+				} else if ('t' == p[1]) {
+					p += 2;
+					for (int i = 0; i < 2; ++i) {
+						p = ParseFloat(p, end, value);
+						chunk.uvs.push_back(value);
+					}
+				}
+			} else if (p + 1 < end && 'f' == p[0] && (' ' == p[1] || '\t' == p[1])) {
+				p += 2;
+
+				/* Polygons become triangle fans around their first corner */
+				ObjCorner first, previous, corner;
+				unsigned int cornersCount = 0;
+				for (;;) {
+					p = SkipSpaces(p, end);
+					const char* next = ParseObjCorner(p, end, chunk, corner);
+					if (next == p) {
+						break;
+					}
+					p = next;
+
+					if (cornersCount >= 2) {
+						chunk.corners.push_back(first);
+						chunk.corners.push_back(previous);
+						chunk.corners.push_back(corner);
+					} else if (0 == cornersCount) {
+						first = corner;
+					}
+					previous = corner;
+					++cornersCount;
+				}
+			}
+
+			p = SkipLine(p, end);
+		}
+	}
+
+	/* Turns the chunk indices into global ones, returns false if any of them is out of range */
+	bool ResolveObjChunk(ObjChunk& chunk, unsigned int positionsCount, unsigned int uvsCount, unsigned int normalsCount)
+	{
+		for (ObjCorner& corner : chunk.corners) {
+			if (corner.relativeMask & OBJ_POSITION) {
+				corner.position += (int)chunk.positionsOffset;
+			}
+			if (corner.relativeMask & OBJ_UV) {
+				corner.uv += (int)chunk.uvsOffset;
+			}
+			if (corner.relativeMask & OBJ_NORMAL) {
+				corner.normal += (int)chunk.normalsOffset;
+			}
+			corner.relativeMask = 0;
+
+			if (corner.position < 0 || corner.position >= (int)positionsCount ||
+				corner.uv < -1 || corner.uv >= (int)uvsCount ||
+				corner.normal < -1 || corner.normal >= (int)normalsCount) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	/* Merges the corners with the same attributes, with an open addressing table sized once */
+	void DeduplicateObjChunk(ObjChunk& chunk)
+	{
+		const size_t cornersCount = chunk.corners.size();
+		size_t tableSize = 16;
+		while (tableSize < 2 * cornersCount) {
+			tableSize *= 2;
+		}
+
+		/* 0 marks an empty slot, the others are vertex indices + 1 */
+		std::vector<unsigned int> table(tableSize, 0);
+		chunk.vertices.reserve(cornersCount);
+		chunk.indices.resize(cornersCount);
+
+		for (size_t i = 0; i < cornersCount; ++i) {
+			const ObjCorner& corner = chunk.corners[i];
+			uint32_t hash = (uint32_t)corner.position * 0x9E3779B1u ^ (uint32_t)corner.uv * 0x85EBCA77u ^ (uint32_t)corner.normal * 0xC2B2AE3Du;
+
+			size_t slot = hash & (tableSize - 1);
+			while (0 != table[slot] && !(chunk.vertices[table[slot] - 1] == corner)) {
+				slot = (slot + 1) & (tableSize - 1);
+			}
+
+			if (0 == table[slot]) {
+				chunk.vertices.push_back(corner);
+				table[slot] = (unsigned int)chunk.vertices.size();
+			}
+			chunk.indices[i] = table[slot] - 1;
+		}
+
+		std::vector<ObjCorner>().swap(chunk.corners);
+	}
+
+	/* ---------------------------------------- JSON ---------------------------------------- */
+
+	/* Just enough JSON to read glTF files, objects keep the members in their original order */
+	struct JsonValue
+	{
+		enum Type { JSON_NULL, JSON_BOOLEAN, JSON_NUMBER, JSON_STRING, JSON_ARRAY, JSON_OBJECT };
+
+		Type type = JSON_NULL;
+		double number = 0.0;
+		std::string string;
+		std::vector<JsonValue> elements;
+		std::vector<std::pair<std::string, JsonValue>> members;
+
+		const JsonValue* Find(const char* key) const
+		{
+			for (const auto& member : members) {
+				if (member.first == key) {
+					return &member.second;
+				}
+			}
+			return nullptr;
+		}
+
+		double GetNumber(const char* key, double fallback) const
+		{
+			const JsonValue* value = Find(key);
+			return (nullptr != value && JSON_NUMBER == value->type) ? value->number : fallback;
+		}
+
+		const JsonValue* GetElement(const char* key, size_t index) const
+		{
+			const JsonValue* array = Find(key);
+			if (nullptr == array || JSON_ARRAY != array->type || index >= array->elements.size()) {
+				return nullptr;
+			}
+			return &array->elements[index];
+		}
+	};
+
+	class JsonParser
+	{
+	public:
+		JsonParser(const char* begin, const char* end) : m_Cursor(begin), m_End(end) {}
+
+		bool Parse(JsonValue& value)
+		{
+			if (!ParseValue(value)) {
+				return false;
+			}
+			SkipWhitespace();
+			return m_Cursor == m_End;
+		}
+
+	private:
+		static constexpr int MAX_DEPTH = 256;
+
+		const char* m_Cursor;
+		const char* m_End;
+		int m_Depth = 0;
+
+		void SkipWhitespace()
+		{
+			while (m_Cursor < m_End && (' ' == *m_Cursor || '\t' == *m_Cursor || '\n' == *m_Cursor || '\r' == *m_Cursor)) {
+				++m_Cursor;
+			}
+		}
+
+		bool Match(const char* literal)
+		{
+			size_t length = strlen(literal);
+			if ((size_t)(m_End - m_Cursor) < length || 0 != memcmp(m_Cursor, literal, length)) {
+				return false;
+			}
+			m_Cursor += length;
+			return true;
+		}
+
+		bool ParseValue(JsonValue& value)
+		{
+			SkipWhitespace();
+			if (m_Cursor >= m_End || ++m_Depth > MAX_DEPTH) {
+				return false;
+			}
+
+			bool result = false;
+			switch (*m_Cursor) {
+			case '{':
+				result = ParseObject(value);
+				break;
+			case '[':
+				result = ParseArray(value);
+				break;
+			case '"':
+				value.type = JsonValue::JSON_STRING;
+				result = ParseString(value.string);
+				break;
+			case 't':
+				value.type = JsonValue::JSON_BOOLEAN;
+				value.number = 1.0;
+				result = Match("true");
+				break;
+			case 'f':
+				value.type = JsonValue::JSON_BOOLEAN;
+				result = Match("false");
+				break;
+			case 'n':
+				result = Match("null");
+				break;
+			default: {
+				const char* start = m_Cursor;
+				value.type = JsonValue::JSON_NUMBER;
+				m_Cursor = ParseDouble(m_Cursor, m_End, value.number);
+				result = m_Cursor != start;
+				break;
+			}
+			}
+
+			--m_Depth;
+			return result;
+		}
+
+		bool ParseObject(JsonValue& value)
+		{
+			value.type = JsonValue::JSON_OBJECT;
+			++m_Cursor;
+
+			SkipWhitespace();
+			if (m_Cursor < m_End && '}' == *m_Cursor) {
+				++m_Cursor;
+				return true;
+			}
+
+			for (;;) {
+				value.members.emplace_back();
+				SkipWhitespace();
+				if (!ParseString(value.members.back().first)) {
+					return false;
+				}
+
+				SkipWhitespace();
+				if (m_Cursor >= m_End || ':' != *m_Cursor++) {
+					return false;
+				}
+
+				if (!ParseValue(value.members.back().second)) {
+					return false;
+				}
+
+				SkipWhitespace();
+				if (m_Cursor >= m_End) {
+					return false;
+				}
+				char separator = *m_Cursor++;
+				if ('}' == separator) {
+					return true;
+				}
+				if (',' != separator) {
+					return false;
+				}
+			}
+		}
+
+		bool ParseArray(JsonValue& value)
+		{
+			value.type = JsonValue::JSON_ARRAY;
+			++m_Cursor;
+
+			SkipWhitespace();
+			if (m_Cursor < m_End && ']' == *m_Cursor) {
+				++m_Cursor;
+				return true;
+			}
+
+			for (;;) {
+				value.elements.emplace_back();
+				if (!ParseValue(value.elements.back())) {
+					return false;
+				}
+
+				SkipWhitespace();
+				if (m_Cursor >= m_End) {
+					return false;
+				}
+				char separator = *m_Cursor++;
+				if (']' == separator) {
+					return true;
+				}
+				if (',' != separator) {
+					return false;
+				}
+			}
+		}
+
+		bool ParseString(std::string& string)
+		{
+			if (m_Cursor >= m_End || '"' != *m_Cursor) {
+				return false;
+			}
+			++m_Cursor;
+
+			while (m_Cursor < m_End && '"' != *m_Cursor) {
+				char c = *m_Cursor++;
+				if ('\\' != c) {
+					string.push_back(c);
+					continue;
+				}
+
+				if (m_Cursor >= m_End) {
+					return false;
+				}
+				c = *m_Cursor++;
+				switch (c) {
+				case 'b': string.push_back('\b'); break;
+				case 'f': string.push_back('\f'); break;
+				case 'n': string.push_back('\n'); break;
+				case 'r': string.push_back('\r'); break;
+				case 't': string.push_back('\t'); break;
+				case 'u': {
+					if (m_End - m_Cursor < 4) {
+						return false;
+					}
+					unsigned int codePoint = 0;
+					for (int i = 0; i < 4; ++i) {
+						char digit = *m_Cursor++;
+						codePoint <<= 4;
+						if (IsDigit(digit)) codePoint |= digit - '0';
+						else if (digit >= 'a' && digit <= 'f') codePoint |= digit - 'a' + 10;
+						else if (digit >= 'A' && digit <= 'F') codePoint |= digit - 'A' + 10;
+						else return false;
+					}
+					/* UTF-8 encoding, surrogate pairs are not recombined since glTF names do not matter here */
+					if (codePoint < 0x80) {
+						string.push_back((char)codePoint);
+					} else if (codePoint < 0x800) {
+						string.push_back((char)(0xC0 | (codePoint >> 6)));
+						string.push_back((char)(0x80 | (codePoint & 0x3F)));
+					} else {
+						string.push_back((char)(0xE0 | (codePoint >> 12)));
+						string.push_back((char)(0x80 | ((codePoint >> 6) & 0x3F)));
+						string.push_back((char)(0x80 | (codePoint & 0x3F)));
+					}
+					break;
+				}
+				default:
+					/* \" \\ and \/ */
+					string.push_back(c);
+					break;
+				}
+			}
+
+			if (m_Cursor >= m_End) {
+				return false;
+			}
+			++m_Cursor;
+			return true;
+		}
+	};
+
+	/* ---------------------------------------- glTF ---------------------------------------- */
+
+	enum GltfComponentType {
+		GLTF_BYTE = 5120,
+		GLTF_UNSIGNED_BYTE = 5121,
+		GLTF_SHORT = 5122,
+		GLTF_UNSIGNED_SHORT = 5123,
+		GLTF_UNSIGNED_INT = 5125,
+		GLTF_FLOAT = 5126
+	};
+
+	static constexpr int GLTF_MODE_TRIANGLES = 4;
+
+	/*
+		JSON numbers are doubles, casting a negative, fractional or too big one to an integer is undefined:
+		indices, counts and sizes go through here first. NaN fails every comparison, so it is rejected too.
+	*/
+	bool ToSize(double value, size_t& size)
+	{
+		static const double MAX_EXACT_SIZE = std::min(9007199254740992.0, (double)std::numeric_limits<size_t>::max());
+		if (!(value >= 0.0 && value < MAX_EXACT_SIZE) || std::floor(value) != value) {
+			return false;
+		}
+		size = (size_t)value;
+		return true;
+	}
+
+	bool ToUnsigned(double value, unsigned int& number)
+	{
+		size_t size;
+		if (!ToSize(value, size) || size > std::numeric_limits<unsigned int>::max()) {
+			return false;
+		}
+		number = (unsigned int)size;
+		return true;
+	}
+
+	/* A strided view over a buffer, validated against its bounds */
+	struct GltfAccessor
+	{
+		const unsigned char* data = nullptr;
+		size_t stride = 0;
+		unsigned int count = 0;
+		unsigned int componentType = 0;
+		unsigned int components = 0;
+		bool normalized = false;
+
+		float ReadFloat(unsigned int element, unsigned int component) const
+		{
+			const unsigned char* p = data + element * stride;
+			switch (componentType) {
+			case GLTF_FLOAT: {
+				float value;
+				memcpy(&value, p + 4 * component, sizeof(float));
+				return value;
+			}
+			case GLTF_UNSIGNED_BYTE:
+				return normalized ? p[component] / 255.0f : (float)p[component];
+			case GLTF_BYTE: {
+				float value = (float)(int8_t)p[component];
+				return normalized ? std::max(value / 127.0f, -1.0f) : value;
+			}
+			case GLTF_UNSIGNED_SHORT: {
+				uint16_t value;
+				memcpy(&value, p + 2 * component, sizeof(uint16_t));
+				return normalized ? value / 65535.0f : (float)value;
+			}
+			case GLTF_SHORT: {
+				int16_t value;
+				memcpy(&value, p + 2 * component, sizeof(int16_t));
+				return normalized ? std::max(value / 32767.0f, -1.0f) : (float)value;
+			}
+			default:
+				return 0.0f;
+			}
+		}
+
+		unsigned int ReadIndex(unsigned int element) const
+		{
+			const unsigned char* p = data + element * stride;
+			switch (componentType) {
+			case GLTF_UNSIGNED_BYTE:
+				return p[0];
+			case GLTF_UNSIGNED_SHORT: {
+				uint16_t value;
+				memcpy(&value, p, sizeof(uint16_t));
+				return value;
+			}
+			default: {
+				uint32_t value;
+				memcpy(&value, p, sizeof(uint32_t));
+				return value;
+			}
+			}
+		}
+	};
+
+	struct GltfPrimitive
+	{
+		GltfAccessor position;
+		GltfAccessor normal;
+		GltfAccessor uv;
+		GltfAccessor indices;
+		bool hasNormal;
+		bool hasUv;
+		bool hasIndices;
+
+		unsigned int baseVertex;
+		unsigned int firstIndex;
+		unsigned int indexCount;
+	};
+
+	unsigned int GetComponentSize(unsigned int componentType)
+	{
+		switch (componentType) {
+		case GLTF_BYTE:
+		case GLTF_UNSIGNED_BYTE:
+			return 1;
+		case GLTF_SHORT:
+		case GLTF_UNSIGNED_SHORT:
+			return 2;
+		case GLTF_UNSIGNED_INT:
+		case GLTF_FLOAT:
+			return 4;
+		default:
+			return 0;
+		}
+	}
+
+	unsigned int GetComponentsCount(const std::string& type)
+	{
+		if ("SCALAR" == type) return 1;
+		if ("VEC2" == type) return 2;
+		if ("VEC3" == type) return 3;
+		if ("VEC4" == type) return 4;
+		return 0;
+	}
+
+	bool ResolveGltfAccessor(const JsonValue& document, const std::vector<std::unique_ptr<MappedFile>>& buffers,
+		double accessorIndex, GltfAccessor& accessor)
+	{
+		size_t index;
+		if (!ToSize(accessorIndex, index)) {
+			return false;
+		}
+		const JsonValue* json = document.GetElement("accessors", index);
+		if (nullptr == json) {
+			return false;
+		}
+
+		const JsonValue* type = json->Find("type");
+		if (!ToUnsigned(json->GetNumber("count", 0.0), accessor.count) ||
+			!ToUnsigned(json->GetNumber("componentType", 0.0), accessor.componentType)) {
+			return false;
+		}
+		accessor.components = nullptr != type ? GetComponentsCount(type->string) : 0;
+		const JsonValue* normalized = json->Find("normalized");
+		accessor.normalized = nullptr != normalized && 0.0 != normalized->number;
+
+		const size_t elementSize = (size_t)GetComponentSize(accessor.componentType) * accessor.components;
+		if (0 == elementSize) {
+			return false;
+		}
+
+		/* Sparse accessors and accessors without a view (all zeros) are not supported */
+		size_t viewIndex;
+		if (!ToSize(json->GetNumber("bufferView", -1.0), viewIndex)) {
+			return false;
+		}
+		const JsonValue* view = document.GetElement("bufferViews", viewIndex);
+		if (nullptr == view) {
+			return false;
+		}
+
+		size_t bufferIndex;
+		if (!ToSize(view->GetNumber("buffer", -1.0), bufferIndex) || bufferIndex >= buffers.size()) {
+			return false;
+		}
+		const MappedFile& buffer = *buffers[bufferIndex];
+
+		size_t viewOffset, viewLength, accessorOffset;
+		if (!ToSize(view->GetNumber("byteOffset", 0.0), viewOffset) ||
+			!ToSize(view->GetNumber("byteLength", 0.0), viewLength) ||
+			!ToSize(json->GetNumber("byteOffset", 0.0), accessorOffset) ||
+			!ToSize(view->GetNumber("byteStride", (double)elementSize), accessor.stride) ||
+			accessor.stride < elementSize) {
+			return false;
+		}
+
+		/* Written so that no sum can overflow */
+		if (viewOffset > buffer.GetSize() || viewLength > buffer.GetSize() - viewOffset) {
+			return false;
+		}
+		if (accessor.count > 0) {
+			if (accessorOffset > viewLength || elementSize > viewLength - accessorOffset ||
+				accessor.count - 1 > (viewLength - accessorOffset - elementSize) / accessor.stride) {
+				return false;
+			}
+		}
+
+		accessor.data = reinterpret_cast<const unsigned char*>(buffer.GetData()) + viewOffset + accessorOffset;
+		return true;
+	}
+
+	std::string GetDirectory(const std::string& filepath)
+	{
+		size_t separator = filepath.find_last_of("/\\");
+		return std::string::npos == separator ? std::string() : filepath.substr(0, separator + 1);
+	}
+
+}
+
+bool MeshImporter::Load(const std::string& filepath, MeshData& mesh)
+{
+	size_t dot = filepath.find_last_of('.');
+	std::string extension = std::string::npos == dot ? std::string() : filepath.substr(dot + 1);
+	std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return (char)tolower(c); });
+
+	if ("obj" == extension) {
+		return LoadOBJ(filepath, mesh);
+	}
+	if ("gltf" == extension) {
+		return LoadGLTF(filepath, mesh);
+	}
+
+	std::cout << "MeshImporter: unsupported file format " << filepath << std::endl;
+	return false;
+}
+
+bool MeshImporter::LoadOBJ(const std::string& filepath, MeshData& mesh)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+
+	MappedFile file(filepath);
+	if (!file.IsValid()) {
+		return false;
+	}
+
+	const char* data = file.GetData();
+	const size_t size = file.GetSize();
+
+	/* Split on line boundaries, each chunk is parsed by its own job */
+	JobSystem& jobSystem = JobSystem::Get();
+	const unsigned int chunksCount = (unsigned int)std::max<size_t>(1, std::min<size_t>(jobSystem.GetThreadsCount(), size / MIN_CHUNK_SIZE));
+	std::vector<ObjChunk> chunks(chunksCount);
+
+	const char* chunkBegin = data;
+	for (unsigned int i = 0; i < chunksCount; ++i) {
+		const char* chunkEnd = data + size;
+		if (i + 1 < chunksCount) {
+			chunkEnd = std::max(chunkBegin, SkipLine(data + size * (i + 1) / chunksCount, data + size));
+		}
+		chunks[i].begin = chunkBegin;
+		chunks[i].end = chunkEnd;
+		chunkBegin = chunkEnd;
+	}
+
+	jobSystem.ParallelFor(chunksCount, 1, [&chunks](unsigned int begin, unsigned int end) {
+		for (unsigned int i = begin; i < end; ++i) {
+			ParseObjChunk(chunks[i]);
+		}
+	});
+
+	/* Attributes are numbered across the whole file */
+	unsigned int positionsCount = 0, uvsCount = 0, normalsCount = 0;
+	for (ObjChunk& chunk : chunks) {
+		chunk.positionsOffset = positionsCount;
+		chunk.uvsOffset = uvsCount;
+		chunk.normalsOffset = normalsCount;
+		positionsCount += (unsigned int)(chunk.positions.size() / 3);
+		uvsCount += (unsigned int)(chunk.uvs.size() / 2);
+		normalsCount += (unsigned int)(chunk.normals.size() / 3);
+	}
+
+	std::vector<float> positions(3 * (size_t)positionsCount);
+	std::vector<float> uvs(2 * (size_t)uvsCount);
+	std::vector<float> normals(3 * (size_t)normalsCount);
+
+	jobSystem.ParallelFor(chunksCount, 1, [&](unsigned int begin, unsigned int end) {
+		for (unsigned int i = begin; i < end; ++i) {
+			ObjChunk& chunk = chunks[i];
+			std::copy(chunk.positions.begin(), chunk.positions.end(), positions.begin() + 3 * (size_t)chunk.positionsOffset);
+			std::copy(chunk.uvs.begin(), chunk.uvs.end(), uvs.begin() + 2 * (size_t)chunk.uvsOffset);
+			std::copy(chunk.normals.begin(), chunk.normals.end(), normals.begin() + 3 * (size_t)chunk.normalsOffset);
+			std::vector<float>().swap(chunk.positions);
+			std::vector<float>().swap(chunk.uvs);
+			std::vector<float>().swap(chunk.normals);
+
+			chunk.valid = ResolveObjChunk(chunk, positionsCount, uvsCount, normalsCount);
+			if (chunk.valid) {
+				DeduplicateObjChunk(chunk);
+			}
+		}
+	});
+
+	/* Vertices shared across chunks get duplicated, which costs little next to a global deduplication */
+	unsigned int vertexCount = 0, indexCount = 0;
+	for (ObjChunk& chunk : chunks) {
+		if (!chunk.valid) {
+			std::cout << "MeshImporter: face index out of range in " << filepath << std::endl;
+			return false;
+		}
+		chunk.baseVertex = vertexCount;
+		chunk.firstIndex = indexCount;
+		vertexCount += (unsigned int)chunk.vertices.size();
+		indexCount += (unsigned int)chunk.indices.size();
+	}
+
+	mesh.vertices.resize((size_t)vertexCount * MeshData::VERTEX_SIZE);
+	mesh.indices.resize(indexCount);
+
+	jobSystem.ParallelFor(chunksCount, 1, [&](unsigned int begin, unsigned int end) {
+		for (unsigned int i = begin; i < end; ++i) {
+			const ObjChunk& chunk = chunks[i];
+
+			float* vertex = &mesh.vertices[(size_t)chunk.baseVertex * MeshData::VERTEX_SIZE];
+			for (const ObjCorner& corner : chunk.vertices) {
+				const float* position = &positions[3 * (size_t)corner.position];
+				vertex[0] = position[0];
+				vertex[1] = position[1];
+				vertex[2] = position[2];
+
+				if (corner.normal >= 0) {
+					const float* normal = &normals[3 * (size_t)corner.normal];
+					vertex[3] = normal[0];
+					vertex[4] = normal[1];
+					vertex[5] = normal[2];
+				} else {
+					vertex[3] = vertex[4] = vertex[5] = 0.0f;
+				}
+
+				if (corner.uv >= 0) {
+					vertex[6] = uvs[2 * (size_t)corner.uv];
+					vertex[7] = uvs[2 * (size_t)corner.uv + 1];
+				} else {
+					vertex[6] = vertex[7] = 0.0f;
+				}
+
+				vertex += MeshData::VERTEX_SIZE;
+			}
+
+			unsigned int* index = &mesh.indices[chunk.firstIndex];
+			for (unsigned int localIndex : chunk.indices) {
+				*index++ = chunk.baseVertex + localIndex;
+			}
+		}
+	});
+
+	if (0 == normalsCount) {
+		GenerateNormals(mesh);
+	}
+
+	auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start);
+	LogThroughput(filepath, size, elapsed.count(), mesh);
+
+	return true;
+}
+
+bool MeshImporter::LoadGLTF(const std::string& filepath, MeshData& mesh)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+
+	MappedFile file(filepath);
+	if (!file.IsValid()) {
+		return false;
+	}
+
+	JsonValue document;
+	JsonParser parser(file.GetData(), file.GetData() + file.GetSize());
+	if (!parser.Parse(document) || JsonValue::JSON_OBJECT != document.type) {
+		std::cout << "MeshImporter: invalid JSON in " << filepath << std::endl;
+		return false;
+	}
+
+	/* Binary buffers are mapped as well, the vertex data is read straight from them */
+	size_t totalSize = file.GetSize();
+	std::vector<std::unique_ptr<MappedFile>> buffers;
+	const JsonValue* buffersJson = document.Find("buffers");
+	if (nullptr != buffersJson) {
+		for (const JsonValue& buffer : buffersJson->elements) {
+			const JsonValue* uri = buffer.Find("uri");
+			if (nullptr == uri || 0 == uri->string.compare(0, 5, "data:")) {
+				std::cout << "MeshImporter: only external buffers are supported in " << filepath << std::endl;
+				return false;
+			}
+
+			buffers.push_back(std::make_unique<MappedFile>(GetDirectory(filepath) + uri->string));
+			size_t byteLength;
+			if (!ToSize(buffer.GetNumber("byteLength", 0.0), byteLength) || !buffers.back()->IsValid() || buffers.back()->GetSize() < byteLength) {
+				std::cout << "MeshImporter: missing or truncated buffer " << uri->string << " in " << filepath << std::endl;
+				return false;
+			}
+			totalSize += buffers.back()->GetSize();
+		}
+	}
+
+	/* Gather the primitives of all the meshes and their place in the output */
+	std::vector<GltfPrimitive> primitives;
+	unsigned int vertexCount = 0, indexCount = 0;
+	const JsonValue* meshesJson = document.Find("meshes");
+	if (nullptr != meshesJson) {
+		for (const JsonValue& meshJson : meshesJson->elements) {
+			const JsonValue* primitivesJson = meshJson.Find("primitives");
+			if (nullptr == primitivesJson) {
+				continue;
+			}
+
+			for (const JsonValue& primitiveJson : primitivesJson->elements) {
+				if (GLTF_MODE_TRIANGLES != primitiveJson.GetNumber("mode", GLTF_MODE_TRIANGLES)) {
+					std::cout << "MeshImporter: skipping a non triangle primitive in " << filepath << std::endl;
+					continue;
+				}
+
+				const JsonValue* attributes = primitiveJson.Find("attributes");
+				if (nullptr == attributes) {
+					continue;
+				}
+
+				GltfPrimitive primitive = {};
+				bool valid = ResolveGltfAccessor(document, buffers, attributes->GetNumber("POSITION", -1.0), primitive.position) &&
+					GLTF_FLOAT == primitive.position.componentType && 3 == primitive.position.components;
+
+				if (valid && nullptr != attributes->Find("NORMAL")) {
+					primitive.hasNormal = true;
+					valid = ResolveGltfAccessor(document, buffers, attributes->GetNumber("NORMAL", -1.0), primitive.normal) &&
+						3 == primitive.normal.components && primitive.normal.count == primitive.position.count;
+				}
+
+				if (valid && nullptr != attributes->Find("TEXCOORD_0")) {
+					primitive.hasUv = true;
+					valid = ResolveGltfAccessor(document, buffers, attributes->GetNumber("TEXCOORD_0", -1.0), primitive.uv) &&
+						2 == primitive.uv.components && primitive.uv.count == primitive.position.count;
+				}
+
+				if (valid && nullptr != primitiveJson.Find("indices")) {
+					primitive.hasIndices = true;
+					valid = ResolveGltfAccessor(document, buffers, primitiveJson.GetNumber("indices", -1.0), primitive.indices) &&
+						1 == primitive.indices.components && GLTF_FLOAT != primitive.indices.componentType;
+				}
+
+				if (!valid) {
+					std::cout << "MeshImporter: invalid primitive accessors in " << filepath << std::endl;
+					return false;
+				}
+
+				primitive.indexCount = primitive.hasIndices ? primitive.indices.count : primitive.position.count;
+				primitive.indexCount -= primitive.indexCount % 3;
+				primitive.baseVertex = vertexCount;
+				primitive.firstIndex = indexCount;
+				vertexCount += primitive.position.count;
+				indexCount += primitive.indexCount;
+				primitives.push_back(primitive);
+			}
+		}
+	}
+
+	mesh.vertices.resize((size_t)vertexCount * MeshData::VERTEX_SIZE);
+	mesh.indices.resize(indexCount);
+
+	std::atomic<bool> valid(true);
+	JobSystem::Get().ParallelFor((unsigned int)primitives.size(), 1, [&](unsigned int begin, unsigned int end) {
+		for (unsigned int i = begin; i < end; ++i) {
+			const GltfPrimitive& primitive = primitives[i];
+
+			float* vertex = &mesh.vertices[(size_t)primitive.baseVertex * MeshData::VERTEX_SIZE];
+			for (unsigned int v = 0; v < primitive.position.count; ++v) {
+				vertex[0] = primitive.position.ReadFloat(v, 0);
+				vertex[1] = primitive.position.ReadFloat(v, 1);
+				vertex[2] = primitive.position.ReadFloat(v, 2);
+				vertex[3] = primitive.hasNormal ? primitive.normal.ReadFloat(v, 0) : 0.0f;
+				vertex[4] = primitive.hasNormal ? primitive.normal.ReadFloat(v, 1) : 0.0f;
+				vertex[5] = primitive.hasNormal ? primitive.normal.ReadFloat(v, 2) : 0.0f;
+				vertex[6] = primitive.hasUv ? primitive.uv.ReadFloat(v, 0) : 0.0f;
+				vertex[7] = primitive.hasUv ? primitive.uv.ReadFloat(v, 1) : 0.0f;
+				vertex += MeshData::VERTEX_SIZE;
+			}
+
+			unsigned int* index = primitive.indexCount > 0 ? &mesh.indices[primitive.firstIndex] : nullptr;
+			for (unsigned int n = 0; n < primitive.indexCount; ++n) {
+				unsigned int localIndex = primitive.hasIndices ? primitive.indices.ReadIndex(n) : n;
+				if (localIndex >= primitive.position.count) {
+					valid = false;
+					localIndex = 0;
+				}
+				index[n] = primitive.baseVertex + localIndex;
+			}
+		}
+	});
+
+	if (!valid) {
+		std::cout << "MeshImporter: index out of range in " << filepath << std::endl;
+		return false;
+	}
+
+	/* Only where the file has none, the authored normals of the other primitives are kept */
+	for (const GltfPrimitive& primitive : primitives) {
+		if (!primitive.hasNormal) {
+			GenerateNormals(mesh, primitive.baseVertex, primitive.position.count, primitive.firstIndex, primitive.indexCount);
+		}
+	}
+
+	auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start);
+	LogThroughput(filepath, totalSize, elapsed.count(), mesh);
+
+	return true;
+}
+
+void MeshImporter::FitToUnitCube(MeshData& mesh)
+{
+	const unsigned int vertexCount = mesh.GetVertexCount();
+	if (0 == vertexCount) {
+		return;
+	}
+
+	glm::vec3 minPosition(mesh.vertices[0], mesh.vertices[1], mesh.vertices[2]);
+	glm::vec3 maxPosition = minPosition;
+	for (unsigned int i = 1; i < vertexCount; ++i) {
+		const float* position = &mesh.vertices[(size_t)i * MeshData::VERTEX_SIZE];
+		minPosition = glm::min(minPosition, glm::vec3(position[0], position[1], position[2]));
+		maxPosition = glm::max(maxPosition, glm::vec3(position[0], position[1], position[2]));
+	}
+
+	const glm::vec3 center = 0.5f * (minPosition + maxPosition);
+	const glm::vec3 extent = maxPosition - minPosition;
+	const float largestExtent = std::max(extent.x, std::max(extent.y, extent.z));
+	const float scale = largestExtent > 0.0f ? 1.0f / largestExtent : 1.0f;
+
+	for (unsigned int i = 0; i < vertexCount; ++i) {
+		float* position = &mesh.vertices[(size_t)i * MeshData::VERTEX_SIZE];
+		position[0] = (position[0] - center.x) * scale;
+		position[1] = (position[1] - center.y) * scale;
+		position[2] = (position[2] - center.z) * scale;
+	}
+}
+
+void MeshImporter::GenerateNormals(MeshData& mesh)
+{
+	GenerateNormals(mesh, 0, mesh.GetVertexCount(), 0, mesh.indices.size());
+}
+
+void MeshImporter::GenerateNormals(MeshData& mesh, unsigned int firstVertex, unsigned int vertexCount, size_t firstIndex, size_t indexCount)
+{
+	for (unsigned int i = firstVertex; i < firstVertex + vertexCount; ++i) {
+		float* normal = &mesh.vertices[(size_t)i * MeshData::VERTEX_SIZE + 3];
+		normal[0] = normal[1] = normal[2] = 0.0f;
+	}
+
+	/* The cross product is twice the area of the triangle, so bigger triangles weigh more */
+	for (size_t i = firstIndex; i + 2 < firstIndex + indexCount; i += 3) {
+		float* vertices[3];
+		for (int corner = 0; corner < 3; ++corner) {
+			vertices[corner] = &mesh.vertices[(size_t)mesh.indices[i + corner] * MeshData::VERTEX_SIZE];
+		}
+
+		glm::vec3 a(vertices[0][0], vertices[0][1], vertices[0][2]);
+		glm::vec3 b(vertices[1][0], vertices[1][1], vertices[1][2]);
+		glm::vec3 c(vertices[2][0], vertices[2][1], vertices[2][2]);
+		glm::vec3 faceNormal = glm::cross(b - a, c - a);
+
+		for (float* vertex : vertices) {
+			vertex[3] += faceNormal.x;
+			vertex[4] += faceNormal.y;
+			vertex[5] += faceNormal.z;
+		}
+	}
+
+	for (unsigned int i = firstVertex; i < firstVertex + vertexCount; ++i) {
+		float* normal = &mesh.vertices[(size_t)i * MeshData::VERTEX_SIZE + 3];
+		glm::vec3 n(normal[0], normal[1], normal[2]);
+		float length = glm::length(n);
+		n = length > 0.0f ? n / length : glm::vec3(0.0f, 1.0f, 0.0f);
+		normal[0] = n.x;
+		normal[1] = n.y;
+		normal[2] = n.z;
+	}
+}
+
+void MeshImporter::LogThroughput(const std::string& filepath, size_t bytes, double milliseconds, const MeshData& mesh)
+{
+	const double megabytes = bytes / (1024.0 * 1024.0);
+	const double throughput = milliseconds > 0.0 ? megabytes / (milliseconds / 1000.0) : 0.0;
+	std::cout << "MeshImporter: " << filepath << " (" << megabytes << " MB) parsed in " << milliseconds << " ms, "
+		<< throughput << " MB/s, " << mesh.GetVertexCount() << " vertices, " << mesh.GetIndexCount() / 3 << " triangles" << std::endl;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string>
+#include "primitives/MeshGenerator.h"
+
+/*
+	Loads triangle meshes from disk into the interleaved MeshData layout.
+	Files are memory mapped and parsed in place by several threads, the output buffers
+	are sized once and filled directly, so no allocation is done per vertex.
+	Supported formats:
+		- Wavefront OBJ: positions, normals and uv coordinates, polygons are triangulated as fans
+		- glTF 2.0 (.gltf with external .bin buffers): triangle primitives of all the meshes,
+		  in mesh space since the node hierarchy is not applied
+	Missing normals are generated by averaging the face normals.
+*/
+class MeshImporter
+{
+public:
+	/* Picks the format from the file extension */
+	static bool Load(const std::string& filepath, MeshData& mesh);
+
+	static bool LoadOBJ(const std::string& filepath, MeshData& mesh);
+	static bool LoadGLTF(const std::string& filepath, MeshData& mesh);
+
+	/* Centers the mesh in the origin and scales it uniformly to fit the unit cube, as the procedural primitives */
+	static void FitToUnitCube(MeshData& mesh);
+
+private:
+	/* Below this size a file is not worth splitting among threads */
+	static constexpr size_t MIN_CHUNK_SIZE = 1024 * 1024;
+
+	static void GenerateNormals(MeshData& mesh);
+	/* Only the given vertices, which the given indices must not reach out of */
+	static void GenerateNormals(MeshData& mesh, unsigned int firstVertex, unsigned int vertexCount, size_t firstIndex, size_t indexCount);
+	static void LogThroughput(const std::string& filepath, size_t bytes, double milliseconds, const MeshData& mesh);
+};
@@ -0,0 +1,327 @@
+#include "MeshOptimizer.h"
+
+#include <cmath>
+#include <vector>
+#include <cstring>
+#include <numeric>
+#include <iostream>
+#include <algorithm>
+
+#include "glm/glm.hpp"
+
+/* Tuning values from the original paper */
+static constexpr float FORSYTH_CACHE_DECAY_POWER = 1.5f;
+static constexpr float FORSYTH_LAST_TRIANGLE_SCORE = 0.75f;
+static constexpr float FORSYTH_VALENCE_BOOST_SCALE = 2.0f;
+static constexpr float FORSYTH_VALENCE_BOOST_POWER = 0.5f;
+
+static constexpr unsigned int INVALID_INDEX = 0xFFFFFFFF;
+
+static float ForsythVertexScore(int cachePosition, unsigned int remainingTriangles, unsigned int cacheSize)
+{
+	/* Nothing left to draw with this vertex */
+	if (0 == remainingTriangles) {
+		return -1.0f;
+	}
+
+	float score = 0.0f;
+	if (cachePosition >= 0) {
+		if (cachePosition < 3) {
+			/* Used by the last triangle: fixed score, so that strips are not privileged over fans */
+			score = FORSYTH_LAST_TRIANGLE_SCORE;
+		} else {
+			float scaler = 1.0f / (cacheSize - 3);
+			score = std::pow(1.0f - (cachePosition - 3) * scaler, FORSYTH_CACHE_DECAY_POWER);
+		}
+	}
+
+	/* Boost vertices with few triangles left, to get rid of lone triangles early */
+	score += FORSYTH_VALENCE_BOOST_SCALE * std::pow((float)remainingTriangles, -FORSYTH_VALENCE_BOOST_POWER);
+
+	return score;
+}
+
+VertexCacheStats MeshOptimizer::AnalyzeVertexCache(const unsigned int* indices, unsigned int indexCount, unsigned int vertexCount,
+	unsigned int cacheSize)
+{
+	VertexCacheStats stats = { 0.0f, 0.0f };
+	if (indexCount < 3) {
+		return stats;
+	}
+
+	/* A vertex is still in the FIFO if less than cacheSize misses happened since it entered */
+	std::vector<unsigned int> cacheTimestamp(vertexCount, 0);
+	std::vector<bool> used(vertexCount, false);
+	unsigned int transformed = 0;
+	unsigned int unique = 0;
+
+	for (unsigned int i = 0; i < indexCount; ++i) {
+		unsigned int index = indices[i];
+		if (!used[index]) {
+			used[index] = true;
+			++unique;
+		}
+
+		if (0 == cacheTimestamp[index] || transformed + 1 - cacheTimestamp[index] > cacheSize) {
+			++transformed;
+			cacheTimestamp[index] = transformed;
+		}
+	}
+
+	stats.acmr = (float)transformed / (indexCount / 3);
+	stats.atvr = (float)transformed / unique;
+
+	return stats;
+}
+
+void MeshOptimizer::OptimizeVertexCache(unsigned int* indices, unsigned int indexCount, unsigned int vertexCount)
+{
+	const unsigned int triangleCount = indexCount / 3;
+	if (0 == triangleCount) {
+		return;
+	}
+
+	/* Triangles adjacent to each vertex, remaining ones are kept at the front of each range */
+	std::vector<unsigned int> remaining(vertexCount, 0);
+	for (unsigned int i = 0; i < indexCount; ++i) {
+		++remaining[indices[i]];
+	}
+
+	std::vector<unsigned int> adjacencyOffsets(vertexCount + 1, 0);
+	for (unsigned int v = 0; v < vertexCount; ++v) {
+		adjacencyOffsets[v + 1] = adjacencyOffsets[v] + remaining[v];
+	}
+
+	std::vector<unsigned int> adjacency(indexCount);
+	{
+		std::vector<unsigned int> cursor(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+		for (unsigned int i = 0; i < indexCount; ++i) {
+			adjacency[cursor[indices[i]]++] = i / 3;
+		}
+	}
+
+	std::vector<int> cachePosition(vertexCount, -1);
+	std::vector<float> vertexScore(vertexCount);
+	for (unsigned int v = 0; v < vertexCount; ++v) {
+		vertexScore[v] = ForsythVertexScore(-1, remaining[v], FORSYTH_CACHE_SIZE);
+	}
+
+	std::vector<float> triangleScore(triangleCount);
+	for (unsigned int t = 0; t < triangleCount; ++t) {
+		triangleScore[t] = vertexScore[indices[3 * t]] + vertexScore[indices[3 * t + 1]] + vertexScore[indices[3 * t + 2]];
+	}
+
+	std::vector<bool> emitted(triangleCount, false);
+	std::vector<unsigned int> output;
+	output.reserve(indexCount);
+
+	unsigned int cache[FORSYTH_CACHE_SIZE + 3];
+	unsigned int cacheCount = 0;
+	unsigned int scanCursor = 0;
+	unsigned int bestTriangle = INVALID_INDEX;
+
+	for (unsigned int emittedCount = 0; emittedCount < triangleCount; ++emittedCount) {
+		/* The cache dried up: restart from the first triangle not drawn yet */
+		if (INVALID_INDEX == bestTriangle) {
+			while (emitted[scanCursor]) {
+				++scanCursor;
+			}
+			bestTriangle = scanCursor;
+		}
+
+		const unsigned int* triangle = &indices[3 * bestTriangle];
+		output.insert(output.end(), triangle, triangle + 3);
+		emitted[bestTriangle] = true;
+
+		/* Remove the triangle from the adjacency of its vertices */
+		for (unsigned int k = 0; k < 3; ++k) {
+			unsigned int v = triangle[k];
+			unsigned int* begin = &adjacency[adjacencyOffsets[v]];
+			unsigned int* end = begin + remaining[v];
+			unsigned int* found = std::find(begin, end, bestTriangle);
+			if (found != end) {
+				std::swap(*found, *(end - 1));
+				--remaining[v];
+			}
+		}
+
+		/* The triangle vertices go on top of the cache, the others are pushed down */
+		unsigned int newCache[FORSYTH_CACHE_SIZE + 3];
+		unsigned int newCacheCount = 0;
+		for (unsigned int k = 0; k < 3; ++k) {
+			newCache[newCacheCount++] = triangle[k];
+		}
+		for (unsigned int i = 0; i < cacheCount; ++i) {
+			unsigned int v = cache[i];
+			if (v != triangle[0] && v != triangle[1] && v != triangle[2]) {
+				newCache[newCacheCount++] = v;
+			}
+		}
+
+		/* Update the scores of every vertex that moved, including the evicted ones */
+		for (unsigned int i = 0; i < newCacheCount; ++i) {
+			unsigned int v = newCache[i];
+			cachePosition[v] = i < FORSYTH_CACHE_SIZE ? (int)i : -1;
+
+			float score = ForsythVertexScore(cachePosition[v], remaining[v], FORSYTH_CACHE_SIZE);
+			float delta = score - vertexScore[v];
+			vertexScore[v] = score;
+
+			for (unsigned int a = 0; a < remaining[v]; ++a) {
+				triangleScore[adjacency[adjacencyOffsets[v] + a]] += delta;
+			}
+		}
+
+		cacheCount = std::min(newCacheCount, FORSYTH_CACHE_SIZE);
+		std::copy(newCache, newCache + cacheCount, cache);
+
+		/* Next triangle: the best one among those touching the cache */
+		bestTriangle = INVALID_INDEX;
+		float bestScore = -1.0f;
+		for (unsigned int i = 0; i < cacheCount; ++i) {
+			unsigned int v = cache[i];
+			for (unsigned int a = 0; a < remaining[v]; ++a) {
+				unsigned int t = adjacency[adjacencyOffsets[v] + a];
+				if (triangleScore[t] > bestScore) {
+					bestScore = triangleScore[t];
+					bestTriangle = t;
+				}
+			}
+		}
+	}
+
+	std::copy(output.begin(), output.end(), indices);
+}
+
+void MeshOptimizer::OptimizeOverdraw(unsigned int* indices, unsigned int indexCount,
+	const float* positions, unsigned int vertexCount, size_t vertexStride)
+{
+	const unsigned int triangleCount = indexCount / 3;
+	if (0 == triangleCount) {
+		return;
+	}
+
+	/*
+		A new cluster starts where all the vertices of a triangle miss the cache:
+		moving clusters around does not change the cache efficiency much.
+	*/
+	std::vector<unsigned int> clusterStarts;
+	{
+		std::vector<unsigned int> cacheTimestamp(vertexCount, 0);
+		unsigned int transformed = 0;
+		for (unsigned int t = 0; t < triangleCount; ++t) {
+			unsigned int misses = 0;
+			for (unsigned int k = 0; k < 3; ++k) {
+				unsigned int index = indices[3 * t + k];
+				if (0 == cacheTimestamp[index] || transformed + 1 - cacheTimestamp[index] > ANALYZE_CACHE_SIZE) {
+					cacheTimestamp[index] = ++transformed;
+					++misses;
+				}
+			}
+			if (0 == t || 3 == misses) {
+				clusterStarts.push_back(t);
+			}
+		}
+	}
+	clusterStarts.push_back(triangleCount);
+
+	const unsigned int clusterCount = (unsigned int)clusterStarts.size() - 1;
+	const size_t floatStride = vertexStride / sizeof(float);
+	auto position = [&](unsigned int index) {
+		const float* p = &positions[index * floatStride];
+		return glm::vec3(p[0], p[1], p[2]);
+	};
+
+	/* Area weighted centroid and normal of each cluster */
+	std::vector<glm::vec3> clusterCentroids(clusterCount, glm::vec3(0.0f));
+	std::vector<glm::vec3> clusterNormals(clusterCount, glm::vec3(0.0f));
+	glm::vec3 meshCentroid(0.0f);
+	float meshArea = 0.0f;
+
+	for (unsigned int c = 0; c < clusterCount; ++c) {
+		float clusterArea = 0.0f;
+		for (unsigned int t = clusterStarts[c]; t < clusterStarts[c + 1]; ++t) {
+			glm::vec3 p0 = position(indices[3 * t]);
+			glm::vec3 p1 = position(indices[3 * t + 1]);
+			glm::vec3 p2 = position(indices[3 * t + 2]);
+
+			glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+			float area = glm::length(normal);
+
+			clusterCentroids[c] += area * (p0 + p1 + p2) / 3.0f;
+			clusterNormals[c] += normal;
+			clusterArea += area;
+		}
+
+		meshCentroid += clusterCentroids[c];
+		meshArea += clusterArea;
+		if (clusterArea > 0.0f) {
+			clusterCentroids[c] /= clusterArea;
+		}
+	}
+
+	if (meshArea > 0.0f) {
+		meshCentroid /= meshArea;
+	}
+
+	/* Clusters far out along their normal are likely to occlude the others */
+	std::vector<float> clusterSortKeys(clusterCount);
+	for (unsigned int c = 0; c < clusterCount; ++c) {
+		float normalLength = glm::length(clusterNormals[c]);
+		glm::vec3 normal = normalLength > 0.0f ? clusterNormals[c] / normalLength : glm::vec3(0.0f);
+		clusterSortKeys[c] = glm::dot(clusterCentroids[c] - meshCentroid, normal);
+	}
+
+	std::vector<unsigned int> clusterOrder(clusterCount);
+	std::iota(clusterOrder.begin(), clusterOrder.end(), 0);
+	std::stable_sort(clusterOrder.begin(), clusterOrder.end(),
+		[&clusterSortKeys](unsigned int a, unsigned int b) { return clusterSortKeys[a] > clusterSortKeys[b]; });
+
+	std::vector<unsigned int> output;
+	output.reserve(indexCount);
+	for (unsigned int c : clusterOrder) {
+		output.insert(output.end(), &indices[3 * clusterStarts[c]], &indices[3 * clusterStarts[c + 1]]);
+	}
+
+	std::copy(output.begin(), output.end(), indices);
+}
+
+unsigned int MeshOptimizer::OptimizeVertexFetch(void* vertices, unsigned int vertexCount, size_t vertexSize,
+	unsigned int* indices, unsigned int indexCount)
+{
+	std::vector<unsigned int> remap(vertexCount, INVALID_INDEX);
+	std::vector<unsigned char> output(vertexCount * vertexSize);
+	const unsigned char* source = static_cast<const unsigned char*>(vertices);
+	unsigned int nextVertex = 0;
+
+	for (unsigned int i = 0; i < indexCount; ++i) {
+		unsigned int index = indices[i];
+		if (INVALID_INDEX == remap[index]) {
+			remap[index] = nextVertex;
+			std::memcpy(&output[nextVertex * vertexSize], &source[index * vertexSize], vertexSize);
+			++nextVertex;
+		}
+		indices[i] = remap[index];
+	}
+
+	std::memcpy(vertices, output.data(), nextVertex * vertexSize);
+
+	return nextVertex;
+}
+
+unsigned int MeshOptimizer::Optimize(float* vertices, unsigned int vertexCount, size_t vertexSize,
+	unsigned int* indices, unsigned int indexCount)
+{
+	VertexCacheStats before = AnalyzeVertexCache(indices, indexCount, vertexCount);
+
+	OptimizeVertexCache(indices, indexCount, vertexCount);
+	OptimizeOverdraw(indices, indexCount, vertices, vertexCount, vertexSize);
+	unsigned int newVertexCount = OptimizeVertexFetch(vertices, vertexCount, vertexSize, indices, indexCount);
+
+	VertexCacheStats after = AnalyzeVertexCache(indices, indexCount, newVertexCount);
+
+	std::cout << "MeshOptimizer: ACMR " << before.acmr << " -> " << after.acmr
+		<< ", ATVR " << before.atvr << " -> " << after.atvr << std::endl;
+
+	return newVertexCount;
+}
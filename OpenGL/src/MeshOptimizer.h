@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+
+/* Post-transform vertex cache efficiency of an index buffer */
+struct VertexCacheStats
+{
+	/* Average cache miss ratio: transformed vertices per triangle, 0.5 is the ideal, 3 the worst */
+	float acmr;
+	/* Average transform to vertex ratio: transformed vertices per unique vertex, 1 is the ideal */
+	float atvr;
+};
+
+/*
+	Reorders index and vertex data of a triangle list to make the GPU work less on the same mesh.
+	The passes are meant to be run in this order:
+		1. OptimizeVertexCache: reuse of the post-transform vertex cache
+		2. OptimizeOverdraw: outer triangles first, so the depth test rejects more fragments
+		3. OptimizeVertexFetch: vertices in the order they are used, for pre-transform cache locality
+*/
+class MeshOptimizer
+{
+public:
+	/* Size of the FIFO cache simulated by AnalyzeVertexCache, typical of current GPUs */
+	static constexpr unsigned int ANALYZE_CACHE_SIZE = 16;
+
+	static VertexCacheStats AnalyzeVertexCache(const unsigned int* indices, unsigned int indexCount, unsigned int vertexCount,
+		unsigned int cacheSize = ANALYZE_CACHE_SIZE);
+
+	/* Tom Forsyth's linear-speed vertex cache optimisation */
+	static void OptimizeVertexCache(unsigned int* indices, unsigned int indexCount, unsigned int vertexCount);
+
+	/*
+		Splits the triangles in clusters where the vertex cache would be flushed anyway,
+		then sorts the clusters so that the ones facing outwards are drawn first.
+		Positions are the first three floats of each vertex, vertexStride is in bytes.
+	*/
+	static void OptimizeOverdraw(unsigned int* indices, unsigned int indexCount,
+		const float* positions, unsigned int vertexCount, size_t vertexStride);
+
+	/* Renumbers vertices by first use, drops unused ones and returns the new vertex count */
+	static unsigned int OptimizeVertexFetch(void* vertices, unsigned int vertexCount, size_t vertexSize,
+		unsigned int* indices, unsigned int indexCount);
+
+	/* Runs all the passes and logs ACMR/ATVR before and after */
+	static unsigned int Optimize(float* vertices, unsigned int vertexCount, size_t vertexSize,
+		unsigned int* indices, unsigned int indexCount);
+
+private:
+	static constexpr unsigned int FORSYTH_CACHE_SIZE = 32;
+};
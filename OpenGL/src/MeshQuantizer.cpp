@@ -0,0 +1,167 @@
+#include "MeshQuantizer.h"
+
+#include <cmath>
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+
+#include "glm/gtc/packing.hpp"
+
+QuantizedMesh MeshQuantizer::Quantize(const float* vertices, unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount)
+{
+	QuantizedMesh mesh;
+	mesh.transform.offset = glm::vec3(0.0f);
+	mesh.transform.scale = glm::vec3(1.0f);
+	mesh.indices.assign(indices, indices + indexCount);
+
+	if (0 == vertexCount) {
+		return mesh;
+	}
+
+	/* The bounding box is mapped to [-1, 1] on each axis, to use the whole 16 bit range */
+	glm::vec3 minPosition(vertices[0], vertices[1], vertices[2]);
+	glm::vec3 maxPosition = minPosition;
+	for (unsigned int i = 1; i < vertexCount; ++i) {
+		const float* position = &vertices[i * SOURCE_VERTEX_SIZE];
+		minPosition = glm::min(minPosition, glm::vec3(position[0], position[1], position[2]));
+		maxPosition = glm::max(maxPosition, glm::vec3(position[0], position[1], position[2]));
+	}
+
+	mesh.transform.offset = 0.5f * (maxPosition + minPosition);
+	/* Avoid a division by zero for flat meshes */
+	mesh.transform.scale = glm::max(0.5f * (maxPosition - minPosition), glm::vec3(1e-6f));
+
+	mesh.vertices.resize(vertexCount);
+	for (unsigned int i = 0; i < vertexCount; ++i) {
+		const float* source = &vertices[i * SOURCE_VERTEX_SIZE];
+		QuantizedVertex& vertex = mesh.vertices[i];
+
+		glm::vec3 position = (glm::vec3(source[0], source[1], source[2]) - mesh.transform.offset) / mesh.transform.scale;
+		vertex.position[0] = PackSnorm16(position.x);
+		vertex.position[1] = PackSnorm16(position.y);
+		vertex.position[2] = PackSnorm16(position.z);
+		vertex.position[3] = PackSnorm16(1.0f);
+
+		glm::vec2 normal = EncodeOctahedral(glm::vec3(source[3], source[4], source[5]));
+		vertex.normal[0] = PackSnorm16(normal.x);
+		vertex.normal[1] = PackSnorm16(normal.y);
+
+		vertex.uv[0] = glm::packHalf1x16(source[6]);
+		vertex.uv[1] = glm::packHalf1x16(source[7]);
+	}
+
+	return mesh;
+}
+
+bool MeshQuantizer::Save(const QuantizedMesh& mesh, const std::string& filepath)
+{
+	std::ofstream fstreamout(filepath, std::ios::binary);
+	if (!fstreamout.is_open()) {
+		std::cout << "Error while opening quantized mesh file " << filepath << std::endl;
+		return false;
+	}
+
+	unsigned int header[4] = { FILE_MAGIC, FILE_VERSION, (unsigned int)mesh.vertices.size(), (unsigned int)mesh.indices.size() };
+	fstreamout.write(reinterpret_cast<const char*>(header), sizeof(header));
+	fstreamout.write(reinterpret_cast<const char*>(&mesh.transform), sizeof(DequantizationTransform));
+	fstreamout.write(reinterpret_cast<const char*>(mesh.vertices.data()), mesh.vertices.size() * sizeof(QuantizedVertex));
+	fstreamout.write(reinterpret_cast<const char*>(mesh.indices.data()), mesh.indices.size() * sizeof(unsigned int));
+
+	if (!fstreamout.good()) {
+		std::cout << "Error while writing quantized mesh file " << filepath << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+bool MeshQuantizer::Load(QuantizedMesh& mesh, const std::string& filepath)
+{
+	std::ifstream fstreamin(filepath, std::ios::binary | std::ios::ate);
+	if (!fstreamin.is_open()) {
+		std::cout << "Error while opening quantized mesh file " << filepath << std::endl;
+		return false;
+	}
+	const std::streamoff fileSize = fstreamin.tellg();
+	fstreamin.seekg(0, std::ios::beg);
+
+	unsigned int header[4];
+	fstreamin.read(reinterpret_cast<char*>(header), sizeof(header));
+	if (!fstreamin.good() || FILE_MAGIC != header[0] || FILE_VERSION != header[1]) {
+		std::cout << "Invalid quantized mesh file " << filepath << std::endl;
+		return false;
+	}
+
+	/* The counts come from the file: a corrupt one must not turn into a huge allocation or a read past the end */
+	const unsigned long long expectedSize = sizeof(header) + sizeof(DequantizationTransform)
+		+ (unsigned long long)header[2] * sizeof(QuantizedVertex) + (unsigned long long)header[3] * sizeof(unsigned int);
+	if (fileSize < 0 || (unsigned long long)fileSize != expectedSize) {
+		std::cout << "Invalid quantized mesh file " << filepath << ": " << header[2] << " vertices and " << header[3]
+			<< " indices need " << expectedSize << " bytes, the file has " << fileSize << std::endl;
+		return false;
+	}
+
+	fstreamin.read(reinterpret_cast<char*>(&mesh.transform), sizeof(DequantizationTransform));
+	if (!fstreamin.good()) {
+		std::cout << "Truncated quantized mesh file " << filepath << std::endl;
+		return false;
+	}
+	mesh.vertices.resize(header[2]);
+	fstreamin.read(reinterpret_cast<char*>(mesh.vertices.data()), mesh.vertices.size() * sizeof(QuantizedVertex));
+	if (!fstreamin.good()) {
+		std::cout << "Truncated quantized mesh file " << filepath << std::endl;
+		return false;
+	}
+	mesh.indices.resize(header[3]);
+	fstreamin.read(reinterpret_cast<char*>(mesh.indices.data()), mesh.indices.size() * sizeof(unsigned int));
+	if (!fstreamin.good()) {
+		std::cout << "Truncated quantized mesh file " << filepath << std::endl;
+		return false;
+	}
+
+	/* Indices past the vertices would make the draw read outside the buffer */
+	for (unsigned int index : mesh.indices) {
+		if (index >= header[2]) {
+			std::cout << "Invalid quantized mesh file " << filepath << ": index " << index << " out of " << header[2] << " vertices" << std::endl;
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void MeshQuantizer::SetDequantizationUniforms(Shader& shader, const DequantizationTransform& transform)
+{
+	shader.SetUniform3f(UNIFORM_DEQUANT_OFFSET, transform.offset.x, transform.offset.y, transform.offset.z);
+	shader.SetUniform3f(UNIFORM_DEQUANT_SCALE, transform.scale.x, transform.scale.y, transform.scale.z);
+}
+
+glm::vec2 MeshQuantizer::EncodeOctahedral(const glm::vec3& normal)
+{
+	/* Project on the octahedron |x| + |y| + |z| = 1 ... */
+	glm::vec3 n = normal / (std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z));
+
+	/* ... then fold the lower hemisphere over the upper one */
+	if (n.z < 0.0f) {
+		float x = (1.0f - std::abs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f);
+		float y = (1.0f - std::abs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f);
+		return glm::vec2(x, y);
+	}
+
+	return glm::vec2(n.x, n.y);
+}
+
+glm::vec3 MeshQuantizer::DecodeOctahedral(const glm::vec2& encoded)
+{
+	/* Same as the decoding done in the quantized vertex shaders */
+	glm::vec3 n(encoded.x, encoded.y, 1.0f - std::abs(encoded.x) - std::abs(encoded.y));
+	float t = std::max(-n.z, 0.0f);
+	n.x += n.x >= 0.0f ? -t : t;
+	n.y += n.y >= 0.0f ? -t : t;
+	return glm::normalize(n);
+}
+
+GLshort MeshQuantizer::PackSnorm16(float value)
+{
+	return (GLshort)std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f);
+}
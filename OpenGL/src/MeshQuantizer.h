@@ -0,0 +1,64 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+
+#include "glm/glm.hpp"
+#include "VertexBufferLayout.h"
+#include "Shader.h"
+
+/*
+	Compressed vertex, 16 bytes instead of the 32 of the float layout:
+		- position on 16 bit snorm, relative to the mesh bounding box (see DequantizationTransform)
+		- normal octahedral encoded on 2 x 16 bit snorm
+		- uv coordinates as half floats
+*/
+struct QuantizedVertex
+{
+	using Format = VertexFormat<attrib::NormShort<4>, attrib::NormShort<2>, attrib::Half<2>>;
+
+	GLshort position[4];
+	GLshort normal[2];
+	GLhalf uv[2];
+};
+
+static_assert(sizeof(QuantizedVertex) == QuantizedVertex::Format::STRIDE, "QuantizedVertex does not match its format");
+
+/* Brings a quantized position back to object space: position = offset + scale * quantized */
+struct DequantizationTransform
+{
+	glm::vec3 offset;
+	glm::vec3 scale;
+};
+
+struct QuantizedMesh
+{
+	DequantizationTransform transform;
+	std::vector<QuantizedVertex> vertices;
+	std::vector<unsigned int> indices;
+};
+
+class MeshQuantizer
+{
+public:
+	/* Source vertices are interleaved floats: position (3), normal (3), uv (2) */
+	static constexpr unsigned int SOURCE_VERTEX_SIZE = 8;
+
+	static QuantizedMesh Quantize(const float* vertices, unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount);
+
+	/* Offline step: quantize once, then load the compressed mesh directly */
+	static bool Save(const QuantizedMesh& mesh, const std::string& filepath);
+	static bool Load(QuantizedMesh& mesh, const std::string& filepath);
+
+	static void SetDequantizationUniforms(Shader& shader, const DequantizationTransform& transform);
+
+	static glm::vec2 EncodeOctahedral(const glm::vec3& normal);
+	static glm::vec3 DecodeOctahedral(const glm::vec2& encoded);
+
+private:
+	static constexpr unsigned int FILE_MAGIC = 0x48534D51; /* "QMSH" */
+	static constexpr unsigned int FILE_VERSION = 1;
+
+	static GLshort PackSnorm16(float value);
+};
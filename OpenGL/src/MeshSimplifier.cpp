@@ -0,0 +1,349 @@
+#include "MeshSimplifier.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <unordered_map>
+
+#include "glm/glm.hpp"
+#include "MeshOptimizer.h"
+
+namespace {
+
+	/* Sum of squared distances to a set of weighted planes, as the 10 unique coefficients of a symmetric 4x4 matrix */
+	struct Quadric
+	{
+		double a2 = 0.0, ab = 0.0, ac = 0.0, ad = 0.0;
+		double b2 = 0.0, bc = 0.0, bd = 0.0;
+		double c2 = 0.0, cd = 0.0;
+		double d2 = 0.0;
+		double weight = 0.0;
+
+		void AddPlane(const glm::dvec3& n, double d, double w)
+		{
+			a2 += w * n.x * n.x; ab += w * n.x * n.y; ac += w * n.x * n.z; ad += w * n.x * d;
+			b2 += w * n.y * n.y; bc += w * n.y * n.z; bd += w * n.y * d;
+			c2 += w * n.z * n.z; cd += w * n.z * d;
+			d2 += w * d * d;
+			weight += w;
+		}
+
+		Quadric& operator+=(const Quadric& other)
+		{
+			a2 += other.a2; ab += other.ab; ac += other.ac; ad += other.ad;
+			b2 += other.b2; bc += other.bc; bd += other.bd;
+			c2 += other.c2; cd += other.cd;
+			d2 += other.d2;
+			weight += other.weight;
+			return *this;
+		}
+
+		/* Weighted average of the squared distances, so that the error is a squared length */
+		double Evaluate(const glm::dvec3& p) const
+		{
+			double error = a2 * p.x * p.x + 2.0 * ab * p.x * p.y + 2.0 * ac * p.x * p.z + 2.0 * ad * p.x
+				+ b2 * p.y * p.y + 2.0 * bc * p.y * p.z + 2.0 * bd * p.y
+				+ c2 * p.z * p.z + 2.0 * cd * p.z
+				+ d2;
+			return weight > 0.0 ? std::max(error, 0.0) / weight : 0.0;
+		}
+	};
+
+	struct Collapse
+	{
+		unsigned int from;
+		unsigned int to;
+		/* Squared distance from the surface, plus the attribute penalty */
+		double cost;
+		double error;
+	};
+
+	inline glm::dvec3 GetPosition(const std::vector<float>& vertices, unsigned int vertex)
+	{
+		const float* p = &vertices[(size_t)vertex * MeshData::VERTEX_SIZE];
+		return glm::dvec3(p[0], p[1], p[2]);
+	}
+
+	inline uint64_t EdgeKey(unsigned int a, unsigned int b)
+	{
+		return ((uint64_t)a << 32) | b;
+	}
+
+	/* Maps every vertex to the first vertex found at the same position */
+	std::vector<unsigned int> WeldPositions(const std::vector<float>& vertices, unsigned int vertexCount)
+	{
+		struct PositionHash
+		{
+			size_t operator()(const glm::vec3& p) const
+			{
+				uint32_t bits[3];
+				memcpy(bits, &p, sizeof(bits));
+				return (size_t)(bits[0] * 73856093u ^ bits[1] * 19349663u ^ bits[2] * 83492791u);
+			}
+		};
+
+		std::unordered_map<glm::vec3, unsigned int, PositionHash> firstAtPosition;
+		firstAtPosition.reserve(vertexCount);
+
+		std::vector<unsigned int> welded(vertexCount);
+		for (unsigned int v = 0; v < vertexCount; ++v) {
+			const float* p = &vertices[(size_t)v * MeshData::VERTEX_SIZE];
+			welded[v] = firstAtPosition.emplace(glm::vec3(p[0], p[1], p[2]), v).first->second;
+		}
+
+		return welded;
+	}
+
+}
+
+float MeshSimplifier::Simplify(const MeshData& source, MeshData& destination, unsigned int targetIndexCount, float maxRelativeError)
+{
+	const unsigned int vertexCount = source.GetVertexCount();
+	const std::vector<float>& vertices = source.vertices;
+	std::vector<unsigned int> indices = source.indices;
+	targetIndexCount -= targetIndexCount % 3;
+
+	/* Seams: more than one vertex at the same position */
+	std::vector<unsigned int> welded = WeldPositions(vertices, vertexCount);
+	std::vector<bool> locked(vertexCount, false);
+	for (unsigned int v = 0; v < vertexCount; ++v) {
+		if (welded[v] != v) {
+			locked[v] = true;
+			locked[welded[v]] = true;
+		}
+	}
+
+	/* Borders and non-manifold edges: a directed edge without its opposite, or shared by more than two triangles */
+	std::unordered_map<uint64_t, unsigned int> directedEdges;
+	directedEdges.reserve(indices.size());
+	for (size_t i = 0; i < indices.size(); i += 3) {
+		for (int e = 0; e < 3; ++e) {
+			++directedEdges[EdgeKey(welded[indices[i + e]], welded[indices[i + (e + 1) % 3]])];
+		}
+	}
+	std::vector<bool> lockedPosition(vertexCount, false);
+	for (const auto& edge : directedEdges) {
+		unsigned int a = (unsigned int)(edge.first >> 32), b = (unsigned int)(edge.first & 0xFFFFFFFF);
+		auto opposite = directedEdges.find(EdgeKey(b, a));
+		if (edge.second > 1 || directedEdges.end() == opposite || opposite->second > 1) {
+			lockedPosition[a] = lockedPosition[b] = true;
+		}
+	}
+	for (unsigned int v = 0; v < vertexCount; ++v) {
+		if (lockedPosition[welded[v]]) {
+			locked[v] = true;
+		}
+	}
+
+	/* Quadrics of the planes around each vertex, weighted by the triangle areas */
+	std::vector<Quadric> quadrics(vertexCount);
+	glm::dvec3 minPosition(INFINITY), maxPosition(-INFINITY);
+	for (unsigned int v = 0; v < vertexCount; ++v) {
+		minPosition = glm::min(minPosition, GetPosition(vertices, v));
+		maxPosition = glm::max(maxPosition, GetPosition(vertices, v));
+	}
+	for (size_t i = 0; i < indices.size(); i += 3) {
+		glm::dvec3 p0 = GetPosition(vertices, indices[i]);
+		glm::dvec3 normal = glm::cross(GetPosition(vertices, indices[i + 1]) - p0, GetPosition(vertices, indices[i + 2]) - p0);
+		double length = glm::length(normal);
+		if (length <= 0.0) {
+			continue;
+		}
+
+		normal /= length;
+		for (int corner = 0; corner < 3; ++corner) {
+			quadrics[indices[i + corner]].AddPlane(normal, -glm::dot(normal, p0), 0.5 * length);
+		}
+	}
+
+	const double extent = vertexCount > 0 ? glm::length(maxPosition - minPosition) : 0.0;
+	const double attributeScale = ATTRIBUTE_WEIGHT * ATTRIBUTE_WEIGHT * extent * extent;
+	const double maxSquaredError = (double)maxRelativeError * maxRelativeError * extent * extent;
+
+	double squaredError = 0.0;
+	std::vector<unsigned int> triangleOffsets(vertexCount + 1);
+	std::vector<unsigned int> vertexTriangles;
+	std::vector<Collapse> collapses;
+	std::vector<unsigned int> remap(vertexCount);
+	std::vector<bool> touched(vertexCount);
+
+	/* Each pass collapses a set of independent edges, cheapest first */
+	while (indices.size() > targetIndexCount) {
+		const unsigned int trianglesCount = (unsigned int)(indices.size() / 3);
+
+		/* Triangles around each vertex, in compressed rows */
+		std::fill(triangleOffsets.begin(), triangleOffsets.end(), 0);
+		for (unsigned int index : indices) {
+			++triangleOffsets[index + 1];
+		}
+		for (unsigned int v = 0; v < vertexCount; ++v) {
+			triangleOffsets[v + 1] += triangleOffsets[v];
+		}
+		vertexTriangles.resize(indices.size());
+		{
+			std::vector<unsigned int> fill(triangleOffsets.begin(), triangleOffsets.end() - 1);
+			for (unsigned int t = 0; t < trianglesCount; ++t) {
+				for (int corner = 0; corner < 3; ++corner) {
+					vertexTriangles[fill[indices[3 * t + corner]]++] = t;
+				}
+			}
+		}
+
+		collapses.clear();
+		for (size_t i = 0; i < indices.size(); i += 3) {
+			for (int e = 0; e < 3; ++e) {
+				unsigned int from = indices[i + e], to = indices[i + (e + 1) % 3];
+				if (locked[from]) {
+					continue;
+				}
+
+				Quadric quadric = quadrics[from];
+				quadric += quadrics[to];
+				double error = quadric.Evaluate(GetPosition(vertices, to));
+
+				const float* attributesFrom = &vertices[(size_t)from * MeshData::VERTEX_SIZE + 3];
+				const float* attributesTo = &vertices[(size_t)to * MeshData::VERTEX_SIZE + 3];
+				double attributeDistance = 0.0;
+				for (unsigned int a = 0; a < MeshData::VERTEX_SIZE - 3; ++a) {
+					double difference = (double)attributesFrom[a] - attributesTo[a];
+					attributeDistance += difference * difference;
+				}
+
+				collapses.push_back({ from, to, error + attributeScale * attributeDistance, error });
+			}
+		}
+
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.cost < b.cost; });
+
+		for (unsigned int v = 0; v < vertexCount; ++v) {
+			remap[v] = v;
+		}
+		std::fill(touched.begin(), touched.end(), false);
+
+		/* Every collapse of an interior edge removes two triangles */
+		const size_t trianglesToRemove = (indices.size() - targetIndexCount) / 3;
+		size_t trianglesRemoved = 0;
+		unsigned int collapsesDone = 0;
+
+		for (const Collapse& collapse : collapses) {
+			if (trianglesRemoved >= trianglesToRemove) {
+				break;
+			}
+			if (touched[collapse.from] || touched[collapse.to] || collapse.error > maxSquaredError) {
+				continue;
+			}
+
+			const glm::dvec3 target = GetPosition(vertices, collapse.to);
+			bool valid = true;
+			unsigned int sharedNeighbours = 0;
+
+			for (unsigned int k = triangleOffsets[collapse.from]; k < triangleOffsets[collapse.from + 1] && valid; ++k) {
+				const unsigned int* triangle = &indices[3 * (size_t)vertexTriangles[k]];
+				bool hasTo = triangle[0] == collapse.to || triangle[1] == collapse.to || triangle[2] == collapse.to;
+				if (hasTo) {
+					continue;
+				}
+
+				/* Reject collapses flipping or squashing the triangles that survive */
+				glm::dvec3 p[3], q[3];
+				for (int corner = 0; corner < 3; ++corner) {
+					p[corner] = GetPosition(vertices, triangle[corner]);
+					q[corner] = triangle[corner] == collapse.from ? target : p[corner];
+				}
+				glm::dvec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+				glm::dvec3 after = glm::cross(q[1] - q[0], q[2] - q[0]);
+				double lengths = glm::length(before) * glm::length(after);
+				valid = lengths > 0.0 && glm::dot(before, after) >= MIN_NORMAL_COS * lengths;
+			}
+
+			/* Link condition: the two ends may only share the opposite vertices of their two triangles */
+			if (valid) {
+				for (unsigned int k = triangleOffsets[collapse.from]; k < triangleOffsets[collapse.from + 1]; ++k) {
+					const unsigned int* triangle = &indices[3 * (size_t)vertexTriangles[k]];
+					for (int corner = 0; corner < 3; ++corner) {
+						unsigned int neighbour = triangle[corner];
+						if (neighbour == collapse.from || neighbour == collapse.to) {
+							continue;
+						}
+						for (unsigned int l = triangleOffsets[collapse.to]; l < triangleOffsets[collapse.to + 1]; ++l) {
+							const unsigned int* other = &indices[3 * (size_t)vertexTriangles[l]];
+							if (other[0] == neighbour || other[1] == neighbour || other[2] == neighbour) {
+								++sharedNeighbours;
+								break;
+							}
+						}
+					}
+				}
+				/* Each shared neighbour is seen from the two triangles around it */
+				valid = sharedNeighbours <= 4;
+			}
+
+			if (!valid) {
+				continue;
+			}
+
+			/* Freeze the one-ring, so that the collapses of this pass never overlap */
+			for (unsigned int k = triangleOffsets[collapse.from]; k < triangleOffsets[collapse.from + 1]; ++k) {
+				const unsigned int* triangle = &indices[3 * (size_t)vertexTriangles[k]];
+				touched[triangle[0]] = touched[triangle[1]] = touched[triangle[2]] = true;
+			}
+
+			remap[collapse.from] = collapse.to;
+			quadrics[collapse.to] += quadrics[collapse.from];
+			squaredError = std::max(squaredError, collapse.error);
+			trianglesRemoved += 2;
+			++collapsesDone;
+		}
+
+		if (0 == collapsesDone) {
+			break;
+		}
+
+		/* Apply the collapses and drop the triangles left without area */
+		size_t writeIndex = 0;
+		for (size_t i = 0; i < indices.size(); i += 3) {
+			unsigned int a = remap[indices[i]], b = remap[indices[i + 1]], c = remap[indices[i + 2]];
+			if (a != b && b != c && c != a) {
+				indices[writeIndex++] = a;
+				indices[writeIndex++] = b;
+				indices[writeIndex++] = c;
+			}
+		}
+		indices.resize(writeIndex);
+	}
+
+	/* Reorder for the vertex cache and drop the vertices not referenced anymore */
+	destination.vertices = vertices;
+	destination.indices = std::move(indices);
+	const unsigned int indexCount = destination.GetIndexCount();
+	MeshOptimizer::OptimizeVertexCache(destination.indices.data(), indexCount, vertexCount);
+	unsigned int usedVertices = MeshOptimizer::OptimizeVertexFetch(destination.vertices.data(), vertexCount,
+		MeshData::VERTEX_SIZE * sizeof(float), destination.indices.data(), indexCount);
+	destination.vertices.resize((size_t)usedVertices * MeshData::VERTEX_SIZE);
+
+	return (float)std::sqrt(squaredError);
+}
+
+std::vector<MeshLOD> MeshSimplifier::BuildLODChain(const MeshData& source, unsigned int levelsCount)
+{
+	std::vector<MeshLOD> levels;
+	levels.push_back({ source, 0.0f });
+
+	for (unsigned int level = 1; level < levelsCount; ++level) {
+		const MeshLOD& previous = levels.back();
+		const unsigned int previousCount = previous.mesh.GetIndexCount();
+		const unsigned int targetCount = (unsigned int)(previousCount * LOD_REDUCTION);
+
+		/* Starting from the previous level is much cheaper, the errors add up to a bound of the distance from the source */
+		MeshLOD lod;
+		lod.error = previous.error + Simplify(previous.mesh, lod.mesh, targetCount, LOD_MAX_RELATIVE_ERROR);
+		if (0 == lod.mesh.GetIndexCount() || lod.mesh.GetIndexCount() > previousCount * LOD_MIN_REDUCTION) {
+			break;
+		}
+
+		levels.push_back(std::move(lod));
+	}
+
+	return levels;
+}
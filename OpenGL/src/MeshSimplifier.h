@@ -0,0 +1,46 @@
+#pragma once
+
+#include <vector>
+#include "primitives/MeshGenerator.h"
+
+/* One level of a LOD chain, error is the largest distance from the source surface introduced by the simplification */
+struct MeshLOD
+{
+	MeshData mesh;
+	float error;
+};
+
+/*
+	Quadric error metric simplification (Garland and Heckbert), made of half-edge collapses:
+	a vertex always collapses onto one of its neighbours, so the surviving vertices keep their
+	exact normals and uv coordinates. The attribute difference between the two ends is added
+	to the cost, so that edges across attribute changes are collapsed last.
+	Vertices on borders and on attribute seams (several vertices at the same position) never move,
+	which keeps the silhouette of open meshes and avoids cracks along uv seams.
+*/
+class MeshSimplifier
+{
+public:
+	/*
+		Collapses edges until at most targetIndexCount indices are left, or until no collapse is allowed
+		below maxRelativeError, a fraction of the bounding box diagonal. Returns the error reached, as a distance.
+	*/
+	static float Simplify(const MeshData& source, MeshData& destination, unsigned int targetIndexCount, float maxRelativeError = 1.0f);
+
+	/*
+		Level 0 is the source itself, every next level has about half the triangles of the previous one
+		and is built from it. The chain stops earlier when the mesh cannot be simplified any further.
+	*/
+	static std::vector<MeshLOD> BuildLODChain(const MeshData& source, unsigned int levelsCount);
+
+private:
+	static constexpr float LOD_REDUCTION = 0.5f;
+	/* A level that removes fewer triangles than this is not worth keeping */
+	static constexpr float LOD_MIN_REDUCTION = 0.9f;
+	/* Past this error the shape is lost, better stop the chain */
+	static constexpr float LOD_MAX_RELATIVE_ERROR = 0.02f;
+	/* Weight of the normal and uv differences, relative to the size of the mesh */
+	static constexpr double ATTRIBUTE_WEIGHT = 0.01;
+	/* Collapses turning a triangle normal by more than about 80 degrees are rejected */
+	static constexpr double MIN_NORMAL_COS = 0.2;
+};
@@ -0,0 +1,252 @@
+#include "OcclusionCulling.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "JobSystem.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OCCLUSION_CULLING_SSE
+#include <emmintrin.h>
+#endif
+
+OcclusionCulling::OcclusionCulling(unsigned int width, unsigned int height) :
+	m_ViewProj(1.0f), m_OccludersCount(0)
+{
+	/* Whole tiles only, which are also whole SIMD registers */
+	m_TilesX = std::max(1u, (width + TILE_SIZE - 1) / TILE_SIZE);
+	m_TilesY = std::max(1u, (height + TILE_SIZE - 1) / TILE_SIZE);
+	m_Width = m_TilesX * TILE_SIZE;
+	m_Height = m_TilesY * TILE_SIZE;
+
+	m_Depth.assign((size_t)m_Width * m_Height, 1.0f);
+	m_TilesMaxDepth.assign((size_t)m_TilesX * m_TilesY, 1.0f);
+	m_Bands.resize((m_Height + BAND_HEIGHT - 1) / BAND_HEIGHT);
+}
+
+void OcclusionCulling::BeginFrame(const glm::mat4& viewProj)
+{
+	m_ViewProj = viewProj;
+	std::fill(m_Depth.begin(), m_Depth.end(), 1.0f);
+	std::fill(m_TilesMaxDepth.begin(), m_TilesMaxDepth.end(), 1.0f);
+	m_Triangles.clear();
+	for (std::vector<unsigned int>& band : m_Bands) {
+		band.clear();
+	}
+	m_OccludersCount = 0;
+}
+
+void OcclusionCulling::AddOccluder(const MeshData& mesh, const glm::mat4& model)
+{
+	const glm::mat4 mvp = m_ViewProj * model;
+	const unsigned int verticesCount = mesh.GetVertexCount();
+
+	m_ClipVertices.resize(verticesCount);
+	for (unsigned int i = 0; i < verticesCount; ++i) {
+		const float* position = &mesh.vertices[(size_t)i * MeshData::VERTEX_SIZE];
+		m_ClipVertices[i] = mvp * glm::vec4(position[0], position[1], position[2], 1.0f);
+	}
+
+	const float width = (float)m_Width, height = (float)m_Height;
+	for (unsigned int i = 0; i + 2 < mesh.GetIndexCount(); i += 3) {
+		glm::vec3 screen[3];
+		bool projectable = true;
+		for (int v = 0; v < 3; ++v) {
+			const glm::vec4& clip = m_ClipVertices[mesh.indices[i + v]];
+			/* Dropping a triangle can only make less occlusion, no need to clip it */
+			if (clip.w < MIN_W || clip.z < -clip.w) {
+				projectable = false;
+				break;
+			}
+			float inverseW = 1.0f / clip.w;
+			screen[v] = glm::vec3((clip.x * inverseW * 0.5f + 0.5f) * width, (clip.y * inverseW * 0.5f + 0.5f) * height, clip.z * inverseW * 0.5f + 0.5f);
+		}
+		if (!projectable) {
+			continue;
+		}
+
+		/* Twice the signed area, negative for back faces */
+		glm::vec2 e1 = glm::vec2(screen[1]) - glm::vec2(screen[0]);
+		glm::vec2 e2 = glm::vec2(screen[2]) - glm::vec2(screen[0]);
+		float area = e1.x * e2.y - e2.x * e1.y;
+		if (area <= 0.0f) {
+			continue;
+		}
+
+		ScreenTriangle triangle;
+		triangle.minX = std::max(0, (int)std::floor(std::min({ screen[0].x, screen[1].x, screen[2].x })));
+		triangle.maxX = std::min((int)m_Width - 1, (int)std::floor(std::max({ screen[0].x, screen[1].x, screen[2].x })));
+		triangle.minY = std::max(0, (int)std::floor(std::min({ screen[0].y, screen[1].y, screen[2].y })));
+		triangle.maxY = std::min((int)m_Height - 1, (int)std::floor(std::max({ screen[0].y, screen[1].y, screen[2].y })));
+		if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY) {
+			continue;
+		}
+
+		for (int edge = 0; edge < 3; ++edge) {
+			const glm::vec3& from = screen[edge];
+			const glm::vec3& to = screen[(edge + 1) % 3];
+			triangle.edgeA[edge] = from.y - to.y;
+			triangle.edgeB[edge] = to.x - from.x;
+			triangle.edgeC[edge] = -(triangle.edgeA[edge] * from.x + triangle.edgeB[edge] * from.y);
+		}
+
+		/* z / w is linear in screen space */
+		float dz1 = screen[1].z - screen[0].z, dz2 = screen[2].z - screen[0].z;
+		triangle.depthA = (dz1 * e2.y - dz2 * e1.y) / area;
+		triangle.depthB = (dz2 * e1.x - dz1 * e2.x) / area;
+		triangle.depthC = screen[0].z - triangle.depthA * screen[0].x - triangle.depthB * screen[0].y;
+
+		unsigned int index = (unsigned int)m_Triangles.size();
+		m_Triangles.push_back(triangle);
+		for (int band = triangle.minY / (int)BAND_HEIGHT; band <= triangle.maxY / (int)BAND_HEIGHT; ++band) {
+			m_Bands[band].push_back(index);
+		}
+	}
+
+	++m_OccludersCount;
+}
+
+void OcclusionCulling::RasterizeOccluders()
+{
+	/* Bands share no pixel and no tile, no synchronization needed. */
+	JobSystem::Get().ParallelFor((unsigned int)m_Bands.size(), 1, [this](unsigned int begin, unsigned int end) {
+		for (unsigned int band = begin; band < end; ++band) {
+			RasterizeBand(band);
+		}
+	});
+}
+
+void OcclusionCulling::RasterizeBand(unsigned int band)
+{
+	const int bandMinY = band * BAND_HEIGHT;
+	const int bandMaxY = std::min((int)m_Height, bandMinY + (int)BAND_HEIGHT) - 1;
+
+	for (unsigned int index : m_Bands[band]) {
+		const ScreenTriangle& triangle = m_Triangles[index];
+		const int minY = std::max(triangle.minY, bandMinY);
+		const int maxY = std::min(triangle.maxY, bandMaxY);
+		/* Aligned to whole registers, the edge functions discard the extra pixels */
+		const int minX = triangle.minX & ~3;
+		const int maxX = triangle.maxX;
+
+		for (int y = minY; y <= maxY; ++y) {
+			const float centerY = y + 0.5f;
+			float* row = &m_Depth[(size_t)y * m_Width];
+#if defined(OCCLUSION_CULLING_SSE)
+			/* Strictly inside only, so that occluders never grow past their edges */
+			const __m128 offsets = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+			__m128 edgeRow[3], edgeStep[3];
+			for (int edge = 0; edge < 3; ++edge) {
+				edgeRow[edge] = _mm_add_ps(_mm_set1_ps(triangle.edgeB[edge] * centerY + triangle.edgeC[edge]),
+					_mm_mul_ps(_mm_set1_ps(triangle.edgeA[edge]), _mm_add_ps(_mm_set1_ps((float)minX), offsets)));
+				edgeStep[edge] = _mm_set1_ps(4.0f * triangle.edgeA[edge]);
+			}
+			__m128 depth = _mm_add_ps(_mm_set1_ps(triangle.depthB * centerY + triangle.depthC),
+				_mm_mul_ps(_mm_set1_ps(triangle.depthA), _mm_add_ps(_mm_set1_ps((float)minX), offsets)));
+			const __m128 depthStep = _mm_set1_ps(4.0f * triangle.depthA);
+			const __m128 zero = _mm_setzero_ps();
+
+			for (int x = minX; x <= maxX; x += 4) {
+				__m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpgt_ps(edgeRow[0], zero), _mm_cmpgt_ps(edgeRow[1], zero)), _mm_cmpgt_ps(edgeRow[2], zero));
+				__m128 current = _mm_loadu_ps(row + x);
+				__m128 closer = _mm_and_ps(inside, _mm_cmplt_ps(depth, current));
+				_mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(closer, depth), _mm_andnot_ps(closer, current)));
+
+				for (int edge = 0; edge < 3; ++edge) {
+					edgeRow[edge] = _mm_add_ps(edgeRow[edge], edgeStep[edge]);
+				}
+				depth = _mm_add_ps(depth, depthStep);
+			}
+#else
+			for (int x = minX; x <= maxX; ++x) {
+				const float centerX = x + 0.5f;
+				bool inside = true;
+				for (int edge = 0; edge < 3; ++edge) {
+					inside &= triangle.edgeA[edge] * centerX + triangle.edgeB[edge] * centerY + triangle.edgeC[edge] > 0.0f;
+				}
+				float depth = triangle.depthA * centerX + triangle.depthB * centerY + triangle.depthC;
+				if (inside && depth < row[x]) {
+					row[x] = depth;
+				}
+			}
+#endif
+		}
+	}
+
+	/* Farthest depth of each tile of the band */
+	for (unsigned int tileY = bandMinY / TILE_SIZE; tileY * TILE_SIZE <= (unsigned int)bandMaxY; ++tileY) {
+		for (unsigned int tileX = 0; tileX < m_TilesX; ++tileX) {
+			float maxDepth = 0.0f;
+			for (unsigned int y = tileY * TILE_SIZE; y < (tileY + 1) * TILE_SIZE; ++y) {
+				const float* row = &m_Depth[(size_t)y * m_Width + tileX * TILE_SIZE];
+				for (unsigned int x = 0; x < TILE_SIZE; ++x) {
+					maxDepth = std::max(maxDepth, row[x]);
+				}
+			}
+			m_TilesMaxDepth[tileY * m_TilesX + tileX] = maxDepth;
+		}
+	}
+}
+
+bool OcclusionCulling::ProjectBox(const AABB& box, glm::vec2& screenMin, glm::vec2& screenMax, float& minDepth) const
+{
+	screenMin = glm::vec2(std::numeric_limits<float>::max());
+	screenMax = glm::vec2(-std::numeric_limits<float>::max());
+	minDepth = 1.0f;
+
+	for (int corner = 0; corner < 8; ++corner) {
+		glm::vec4 position((corner & 1) ? box.max.x : box.min.x, (corner & 2) ? box.max.y : box.min.y, (corner & 4) ? box.max.z : box.min.z, 1.0f);
+		glm::vec4 clip = m_ViewProj * position;
+		if (clip.w < MIN_W || clip.z < -clip.w) {
+			return false;
+		}
+		float inverseW = 1.0f / clip.w;
+		glm::vec2 screen((clip.x * inverseW * 0.5f + 0.5f) * m_Width, (clip.y * inverseW * 0.5f + 0.5f) * m_Height);
+		screenMin = glm::min(screenMin, screen);
+		screenMax = glm::max(screenMax, screen);
+		minDepth = std::min(minDepth, clip.z * inverseW * 0.5f + 0.5f);
+	}
+	return true;
+}
+
+bool OcclusionCulling::IsVisible(const AABB& box) const
+{
+	glm::vec2 screenMin, screenMax;
+	float minDepth;
+	if (!ProjectBox(box, screenMin, screenMax, minDepth)) {
+		return true;
+	}
+
+	/* Every pixel the box touches */
+	int minX = std::max(0, (int)std::floor(screenMin.x));
+	int maxX = std::min((int)m_Width - 1, (int)std::floor(screenMax.x));
+	int minY = std::max(0, (int)std::floor(screenMin.y));
+	int maxY = std::min((int)m_Height - 1, (int)std::floor(screenMax.y));
+	if (minX > maxX || minY > maxY) {
+		/* Off screen, that is for the frustum culling to say */
+		return true;
+	}
+
+	for (int tileY = minY / (int)TILE_SIZE; tileY <= maxY / (int)TILE_SIZE; ++tileY) {
+		for (int tileX = minX / (int)TILE_SIZE; tileX <= maxX / (int)TILE_SIZE; ++tileX) {
+			/* The whole tile is in front of the box */
+			if (m_TilesMaxDepth[tileY * m_TilesX + tileX] < minDepth) {
+				continue;
+			}
+
+			int fromY = std::max(minY, tileY * (int)TILE_SIZE), toY = std::min(maxY, (tileY + 1) * (int)TILE_SIZE - 1);
+			int fromX = std::max(minX, tileX * (int)TILE_SIZE), toX = std::min(maxX, (tileX + 1) * (int)TILE_SIZE - 1);
+			for (int y = fromY; y <= toY; ++y) {
+				const float* row = &m_Depth[(size_t)y * m_Width];
+				for (int x = fromX; x <= toX; ++x) {
+					if (row[x] >= minDepth) {
+						return true;
+					}
+				}
+			}
+		}
+	}
+
+	return false;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <vector>
+#include "glm/glm.hpp"
+
+#include "BVH.h"
+#include "primitives/MeshGenerator.h"
+
+/*
+	Software occlusion culling: a few big objects close to the camera are rasterized
+	into a small depth buffer on the CPU, then the boxes of the other objects are tested against it
+	before they are drawn. Only what is surely hidden is rejected:
+	occluder triangles crossing the near plane are dropped and occludees crossing it are visible.
+	The screen is split in bands of tiles rasterized by the job system threads, four pixels at a time with SSE2.
+	Each tile keeps the farthest depth of its pixels, most occludees are rejected by the tiles alone.
+*/
+class OcclusionCulling
+{
+public:
+	static constexpr unsigned int WIDTH_DEFAULT = 320;
+	static constexpr unsigned int HEIGHT_DEFAULT = 192;
+
+	OcclusionCulling(unsigned int width = WIDTH_DEFAULT, unsigned int height = HEIGHT_DEFAULT);
+
+	/* Clears the depth buffer and the occluders */
+	void BeginFrame(const glm::mat4& viewProj);
+	/* Occluder triangles must be counter clockwise, back faces are skipped */
+	void AddOccluder(const MeshData& mesh, const glm::mat4& model);
+	void RasterizeOccluders();
+
+	/* False when every pixel covered by the box is in front of its nearest point */
+	bool IsVisible(const AABB& box) const;
+
+	inline unsigned int GetOccludersCount() const { return m_OccludersCount; }
+	inline unsigned int GetTrianglesCount() const { return (unsigned int)m_Triangles.size(); }
+	inline unsigned int GetWidth() const { return m_Width; }
+	inline unsigned int GetHeight() const { return m_Height; }
+	/* Depth in [0, 1] of each pixel, bottom row first */
+	inline const std::vector<float>& GetDepthBuffer() const { return m_Depth; }
+
+private:
+	static constexpr unsigned int TILE_SIZE = 8;
+	static constexpr unsigned int BAND_HEIGHT = 2 * TILE_SIZE;
+	/* Vertices closer than this in clip space w are too near to project */
+	static constexpr float MIN_W = 1e-4f;
+
+	struct ScreenTriangle
+	{
+		/* Edge functions, positive inside */
+		float edgeA[3], edgeB[3], edgeC[3];
+		/* Depth plane: z = depthA * x + depthB * y + depthC */
+		float depthA, depthB, depthC;
+		int minX, maxX, minY, maxY;
+	};
+
+	void RasterizeBand(unsigned int band);
+	/* Screen space box of the projected corners, false when it cannot be trusted */
+	bool ProjectBox(const AABB& box, glm::vec2& screenMin, glm::vec2& screenMax, float& minDepth) const;
+
+	unsigned int m_Width;
+	unsigned int m_Height;
+	unsigned int m_TilesX;
+	unsigned int m_TilesY;
+
+	glm::mat4 m_ViewProj;
+	std::vector<float> m_Depth;
+	std::vector<float> m_TilesMaxDepth;
+
+	std::vector<glm::vec4> m_ClipVertices;
+	std::vector<ScreenTriangle> m_Triangles;
+	/* Triangles overlapping each band */
+	std::vector<std::vector<unsigned int>> m_Bands;
+	unsigned int m_OccludersCount;
+};
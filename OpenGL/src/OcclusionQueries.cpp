@@ -0,0 +1,70 @@
+#include "OcclusionQueries.h"
+
+#include "Renderer.h"
+
+OcclusionQueries::OcclusionQueries()
+{
+}
+
+OcclusionQueries::~OcclusionQueries()
+{
+	this->Resize(0);
+}
+
+void OcclusionQueries::Resize(unsigned int count)
+{
+	if (!m_Queries.empty()) {
+		GLCheckErrorCall(glDeleteQueries((GLsizei)m_Queries.size(), m_Queries.data()));
+	}
+
+	m_Queries.assign(count, 0);
+	m_Pending.assign(count, 0);
+	m_Visible.assign(count, 1);
+	if (count > 0) {
+		GLCheckErrorCall(glGenQueries((GLsizei)count, m_Queries.data()));
+	}
+}
+
+void OcclusionQueries::Poll(unsigned int object)
+{
+	if (!m_Pending[object]) {
+		return;
+	}
+
+	GLint available = 0;
+	GLCheckErrorCall(glGetQueryObjectiv(m_Queries[object], GL_QUERY_RESULT_AVAILABLE, &available));
+	if (!available) {
+		return;
+	}
+
+	GLuint anySamplesPassed = 0;
+	GLCheckErrorCall(glGetQueryObjectuiv(m_Queries[object], GL_QUERY_RESULT, &anySamplesPassed));
+	m_Visible[object] = anySamplesPassed ? 1 : 0;
+	m_Pending[object] = 0;
+}
+
+bool OcclusionQueries::Begin(unsigned int object)
+{
+	if (m_Pending[object]) {
+		return false;
+	}
+
+	GLCheckErrorCall(glBeginQuery(GL_ANY_SAMPLES_PASSED, m_Queries[object]));
+	m_Pending[object] = 1;
+	return true;
+}
+
+void OcclusionQueries::End()
+{
+	GLCheckErrorCall(glEndQuery(GL_ANY_SAMPLES_PASSED));
+}
+
+void OcclusionQueries::BeginConditionalRender(unsigned int object) const
+{
+	GLCheckErrorCall(glBeginConditionalRender(m_Queries[object], GL_QUERY_NO_WAIT));
+}
+
+void OcclusionQueries::EndConditionalRender()
+{
+	GLCheckErrorCall(glEndConditionalRender());
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <vector>
+
+/*
+	One GL_ANY_SAMPLES_PASSED query per object, telling whether any of its pixels passed the depth test.
+	Results are only collected once the GPU has them, until then the object keeps the visibility
+	it had the last time, so asking never stalls the pipeline. Objects start visible.
+*/
+class OcclusionQueries
+{
+public:
+	OcclusionQueries();
+	~OcclusionQueries();
+
+	/* Replaces the queries, the results in flight are dropped */
+	void Resize(unsigned int count);
+
+	/* Collects the result of the object query if it is available */
+	void Poll(unsigned int object);
+	inline bool IsVisible(unsigned int object) const { return m_Visible[object] != 0; }
+
+	/* False when the previous query of the object is still in flight, nothing is started then */
+	bool Begin(unsigned int object);
+	void End();
+
+	/* Draws until EndConditionalRender are discarded when the last query of the object found no samples,
+	   when its result is not there yet they are drawn instead of waiting */
+	void BeginConditionalRender(unsigned int object) const;
+	static void EndConditionalRender();
+
+	inline unsigned int GetCount() const { return (unsigned int)m_Queries.size(); }
+
+private:
+	std::vector<unsigned int> m_Queries;
+	std::vector<unsigned char> m_Pending;
+	std::vector<unsigned char> m_Visible;
+};
@@ -0,0 +1,149 @@
+#include "OffsetAllocator.h"
+
+#include <iostream>
+#include <iterator>
+
+OffsetAllocator::OffsetAllocator(unsigned int capacity) :
+	m_Capacity(capacity), m_Used(0), m_BinsMask(0)
+{
+	if (capacity > 0) {
+		InsertFreeBlock(0, capacity);
+	}
+}
+
+unsigned int OffsetAllocator::Allocate(unsigned int size)
+{
+	if (0 == size) {
+		return INVALID_OFFSET;
+	}
+
+	/* Look for the best fit in the bin of the requested size first */
+	unsigned int bin = BinIndex(size);
+	auto it = m_Bins[bin].lower_bound(std::make_pair(size, 0u));
+	if (m_Bins[bin].end() == it) {
+		/* Any block in an upper bin is big enough, take the smallest one */
+		unsigned int upperBins = (bin + 1 < BINS_COUNT) ? m_BinsMask & (~0u << (bin + 1)) : 0;
+		if (0 == upperBins) {
+			return INVALID_OFFSET;
+		}
+
+		unsigned int upperBin = 0;
+		while (0 == (upperBins & (1u << upperBin))) {
+			++upperBin;
+		}
+		it = m_Bins[upperBin].begin();
+	}
+
+	unsigned int blockSize = it->first;
+	unsigned int blockOffset = it->second;
+	RemoveFreeBlock(blockOffset, blockSize);
+
+	/* Give back what we do not need */
+	if (blockSize > size) {
+		InsertFreeBlock(blockOffset + size, blockSize - size);
+	}
+
+	m_UsedBlocks[blockOffset] = size;
+	m_Used += size;
+
+	return blockOffset;
+}
+
+void OffsetAllocator::Free(unsigned int offset)
+{
+	auto used = m_UsedBlocks.find(offset);
+	if (m_UsedBlocks.end() == used) {
+		std::cout << "OffsetAllocator: trying to free unknown offset " << offset << std::endl;
+		return;
+	}
+
+	unsigned int size = used->second;
+	m_UsedBlocks.erase(used);
+	m_Used -= size;
+
+	/* Merge with the following free block, if adjacent */
+	auto next = m_FreeBlocks.lower_bound(offset);
+	if (m_FreeBlocks.end() != next && offset + size == next->first) {
+		unsigned int nextSize = next->second;
+		RemoveFreeBlock(next->first, nextSize);
+		size += nextSize;
+	}
+
+	/* Merge with the preceding free block, if adjacent */
+	auto prev = m_FreeBlocks.lower_bound(offset);
+	if (m_FreeBlocks.begin() != prev) {
+		--prev;
+		if (prev->first + prev->second == offset) {
+			unsigned int prevOffset = prev->first;
+			unsigned int prevSize = prev->second;
+			RemoveFreeBlock(prevOffset, prevSize);
+			offset = prevOffset;
+			size += prevSize;
+		}
+	}
+
+	InsertFreeBlock(offset, size);
+}
+
+void OffsetAllocator::Grow(unsigned int newCapacity)
+{
+	if (newCapacity <= m_Capacity) {
+		return;
+	}
+
+	unsigned int offset = m_Capacity;
+	unsigned int size = newCapacity - m_Capacity;
+	m_Capacity = newCapacity;
+
+	/* Extend the last free block if it reaches the old end of the space */
+	if (!m_FreeBlocks.empty()) {
+		auto last = std::prev(m_FreeBlocks.end());
+		if (last->first + last->second == offset) {
+			unsigned int lastOffset = last->first;
+			unsigned int lastSize = last->second;
+			RemoveFreeBlock(lastOffset, lastSize);
+			offset = lastOffset;
+			size += lastSize;
+		}
+	}
+
+	InsertFreeBlock(offset, size);
+}
+
+unsigned int OffsetAllocator::GetLargestFreeBlock() const
+{
+	for (int bin = BINS_COUNT - 1; bin >= 0; --bin) {
+		if (!m_Bins[bin].empty()) {
+			return m_Bins[bin].rbegin()->first;
+		}
+	}
+	return 0;
+}
+
+unsigned int OffsetAllocator::BinIndex(unsigned int size)
+{
+	/* floor(log2(size)) */
+	unsigned int bin = 0;
+	while (size >>= 1) {
+		++bin;
+	}
+	return bin;
+}
+
+void OffsetAllocator::InsertFreeBlock(unsigned int offset, unsigned int size)
+{
+	unsigned int bin = BinIndex(size);
+	m_Bins[bin].insert(std::make_pair(size, offset));
+	m_BinsMask |= (1u << bin);
+	m_FreeBlocks[offset] = size;
+}
+
+void OffsetAllocator::RemoveFreeBlock(unsigned int offset, unsigned int size)
+{
+	unsigned int bin = BinIndex(size);
+	m_Bins[bin].erase(std::make_pair(size, offset));
+	if (m_Bins[bin].empty()) {
+		m_BinsMask &= ~(1u << bin);
+	}
+	m_FreeBlocks.erase(offset);
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <map>
+#include <cstddef>
+#include <set>
+#include <utility>
+#include <unordered_map>
+
+/*
+	Allocates ranges of abstract units (vertices, indices, bytes...) out of a linear space.
+	Free ranges are kept in segregated bins, one per power of two, so that a fitting
+	block is found without scanning the whole free list. Freed ranges are coalesced
+	with their neighbours to limit fragmentation.
+*/
+class OffsetAllocator
+{
+public:
+	static constexpr unsigned int INVALID_OFFSET = 0xFFFFFFFF;
+
+	OffsetAllocator(unsigned int capacity);
+
+	unsigned int Allocate(unsigned int size);
+	void Free(unsigned int offset);
+	void Grow(unsigned int newCapacity);
+
+	inline unsigned int GetCapacity() const { return m_Capacity; }
+	inline unsigned int GetUsed() const { return m_Used; }
+	inline size_t GetFreeBlocksCount() const { return m_FreeBlocks.size(); }
+	unsigned int GetLargestFreeBlock() const;
+
+private:
+	static constexpr unsigned int BINS_COUNT = 32;
+
+	static unsigned int BinIndex(unsigned int size);
+
+	void InsertFreeBlock(unsigned int offset, unsigned int size);
+	void RemoveFreeBlock(unsigned int offset, unsigned int size);
+
+	unsigned int m_Capacity;
+	unsigned int m_Used;
+
+	/* Bit i is set when m_Bins[i] is not empty */
+	unsigned int m_BinsMask;
+	/* Each bin keeps (size, offset) pairs sorted by size, to pick the best fit */
+	std::set<std::pair<unsigned int, unsigned int>> m_Bins[BINS_COUNT];
+
+	/* Free ranges sorted by offset (offset -> size), used for coalescing */
+	std::map<unsigned int, unsigned int> m_FreeBlocks;
+	/* Live allocations (offset -> size) */
+	std::unordered_map<unsigned int, unsigned int> m_UsedBlocks;
+};
@@ -0,0 +1,106 @@
+#include "RenderThread.h"
+
+#include <chrono>
+
+#include "Renderer.h"
+
+FrameSnapshot::FrameSnapshot() : m_ClearMask(0)
+{
+}
+
+void FrameSnapshot::Reset()
+{
+	m_ClearMask = 0;
+	for (CommandList& commands : m_CommandLists) {
+		commands.Reset();
+	}
+}
+
+void FrameSnapshot::Execute() const
+{
+	if (m_ClearMask) {
+		GLCheckErrorCall(glClear(m_ClearMask));
+	}
+	for (const CommandList& commands : m_CommandLists) {
+		commands.Execute();
+	}
+	VertexArray::Unbind();
+}
+
+RenderThread::RenderThread(GLFWwindow* window) : m_Window(window), m_FramePending(false), m_Running(true), m_FrameMilliseconds(0.0f)
+{
+	glfwMakeContextCurrent(NULL);
+	m_Thread = std::thread(&RenderThread::Loop, this);
+}
+
+RenderThread::~RenderThread()
+{
+	WaitIdle();
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Running = false;
+	}
+	m_Condition.notify_all();
+	m_Thread.join();
+
+	glfwMakeContextCurrent(m_Window);
+}
+
+void RenderThread::Submit(std::function<void()> frame, std::function<void()> afterSwap)
+{
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	m_Condition.wait(lock, [this]() { return !m_FramePending; });
+	m_Frame = std::move(frame);
+	m_AfterSwap = std::move(afterSwap);
+	m_FramePending = true;
+	lock.unlock();
+	m_Condition.notify_all();
+}
+
+void RenderThread::AcquireContext()
+{
+	WaitIdle();
+	glfwMakeContextCurrent(m_Window);
+}
+
+void RenderThread::ReleaseContext()
+{
+	/* A context can be current on one thread at a time, the render thread takes it with the next frame */
+	glfwMakeContextCurrent(NULL);
+}
+
+void RenderThread::WaitIdle()
+{
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	m_Condition.wait(lock, [this]() { return !m_FramePending; });
+}
+
+void RenderThread::Loop()
+{
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	while (true) {
+		m_Condition.wait(lock, [this]() { return m_FramePending || !m_Running; });
+		if (!m_FramePending) {
+			return;
+		}
+
+		/* The main thread waits for m_FramePending before touching the frame or the context again */
+		lock.unlock();
+		auto start = std::chrono::high_resolution_clock::now();
+		glfwMakeContextCurrent(m_Window);
+		m_Frame();
+		glfwSwapBuffers(m_Window);
+		if (m_AfterSwap) {
+			m_AfterSwap();
+		}
+		glfwMakeContextCurrent(NULL);
+		auto end = std::chrono::high_resolution_clock::now();
+		lock.lock();
+
+		m_FrameMilliseconds = std::chrono::duration<float, std::milli>(end - start).count();
+		m_Frame = nullptr;
+		m_AfterSwap = nullptr;
+		m_FramePending = false;
+		m_Condition.notify_all();
+	}
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <functional>
+#include <condition_variable>
+
+#include "CommandList.h"
+#include <GLFW/glfw3.h>
+
+/*
+	A frame as the update thread left it, replayed by the render thread while the next one is simulated.
+	Camera matrices and every other uniform are copied in the command lists when they are recorded,
+	so later updates cannot change what gets drawn. Reset keeps the memory of the lists.
+*/
+class FrameSnapshot
+{
+public:
+	FrameSnapshot();
+
+	void Reset();
+
+	/* Buffers cleared before the lists run, 0 keeps the previous content */
+	inline void SetClearMask(GLbitfield mask) { m_ClearMask = mask; }
+	/* Replayed in order, each one can be recorded by a different thread */
+	inline std::vector<CommandList>& GetCommandLists() { return m_CommandLists; }
+
+	/* Context thread only */
+	void Execute() const;
+
+private:
+	GLbitfield m_ClearMask;
+	std::vector<CommandList> m_CommandLists;
+};
+
+/*
+	Thread submitting the frames to the driver, so that the main thread can simulate the next frame meanwhile.
+	The context of the window moves between the two threads: the render thread holds it while drawing
+	a submitted frame, the main thread takes it back with AcquireContext for whatever still needs the
+	graphics API there, such as creating resources or scenes drawing themselves.
+	Input and window functions stay on the main thread, as glfw requires.
+*/
+class RenderThread
+{
+public:
+	/* The context of the window must be current on the calling thread, it is released */
+	RenderThread(GLFWwindow* window);
+	/* Waits for the last frame, the context is current on the calling thread again */
+	~RenderThread();
+
+	/*
+		Waits for the previous frame, then runs frame on the render thread and swaps the buffers without waiting.
+		afterSwap, if any, runs right after the swap with the context still current, e.g. to fence the frame.
+	*/
+	void Submit(std::function<void()> frame, std::function<void()> afterSwap = nullptr);
+	/* Waits for the submitted frame and makes the context current on the calling thread, until ReleaseContext */
+	void AcquireContext();
+	void ReleaseContext();
+	void WaitIdle();
+
+	/* Time the render thread took to draw and swap the last frame */
+	inline float GetFrameMilliseconds() const { return m_FrameMilliseconds; }
+
+private:
+	void Loop();
+
+	GLFWwindow* m_Window;
+	std::thread m_Thread;
+	std::mutex m_Mutex;
+	std::condition_variable m_Condition;
+
+	/* Guarded by m_Mutex, the frame stays untouched by the main thread while it is pending */
+	std::function<void()> m_Frame;
+	std::function<void()> m_AfterSwap;
+	bool m_FramePending;
+	bool m_Running;
+	std::atomic<float> m_FrameMilliseconds;
+};
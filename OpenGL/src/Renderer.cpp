@@ -23,6 +23,10 @@ bool GLLogCall(const char* function, const char* file, int line)
 
 #endif
 
+unsigned int Renderer::s_DrawCalls = 0;
+long long Renderer::s_Memory = 0;
+thread_local long long* Renderer::s_MemoryAccount = nullptr;
+
 void Renderer::ClearColorSetDefault()
 {
 	GLCheckErrorCall(glClearColor(0.2f, 0.3f, 0.3f, 1.0f));
@@ -45,5 +49,6 @@ void Renderer::Draw(const VertexArray& va, const IndexBuffer& ib, const Shader&
 	shader.Use();
 
 	/* Draw call */
-	GLCheckErrorCall(glDrawElements(GL_TRIANGLES, ib.GetCount(), GL_UNSIGNED_INT, nullptr));
+	GLCheckErrorCall(glDrawElements(GL_TRIANGLES, ib.GetCount(), ib.GetType(), nullptr));
+	Renderer::AddDrawCalls();
 }
@@ -27,4 +27,40 @@ public:
 	static void ClearColorSetBlack();
 	static void Clear();
 	static void Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader);
+
+	/* Draw calls issued since the last reset, every function calling glDraw* adds its own */
+	static inline void AddDrawCalls(unsigned int count = 1) { s_DrawCalls += count; }
+	static inline unsigned int GetDrawCalls() { return s_DrawCalls; }
+	static inline void ResetDrawCalls() { s_DrawCalls = 0; }
+
+	/* Bytes of the buffers and textures alive, kept up to date by their constructors and destructors */
+	static inline void AddMemory(long long bytes)
+	{
+		s_Memory += bytes;
+		if (s_MemoryAccount) {
+			*s_MemoryAccount += bytes;
+		}
+	}
+	static inline long long GetMemory() { return s_Memory; }
+
+	/*
+		While it lives, what the calling thread allocates and frees is also counted in account, e.g. the memory of one scene.
+		Scopes nest, null counts nothing more than the total.
+	*/
+	class MemoryScope
+	{
+	public:
+		MemoryScope(long long* account) : m_Previous(s_MemoryAccount) { s_MemoryAccount = account; }
+		~MemoryScope() { s_MemoryAccount = m_Previous; }
+		MemoryScope(const MemoryScope&) = delete;
+		MemoryScope& operator=(const MemoryScope&) = delete;
+
+	private:
+		long long* m_Previous;
+	};
+
+private:
+	static unsigned int s_DrawCalls;
+	static long long s_Memory;
+	static thread_local long long* s_MemoryAccount;
 };
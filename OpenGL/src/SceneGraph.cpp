@@ -0,0 +1,115 @@
+#include "SceneGraph.h"
+
+#include <algorithm>
+
+namespace {
+
+	/* Same as translate * mat4_cast(rotation) * scale, without the matrix products */
+	inline glm::mat4 ComposeTransform(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale)
+	{
+		glm::mat3 r = glm::mat3_cast(rotation);
+		return glm::mat4(
+			glm::vec4(r[0] * scale.x, 0.0f),
+			glm::vec4(r[1] * scale.y, 0.0f),
+			glm::vec4(r[2] * scale.z, 0.0f),
+			glm::vec4(position, 1.0f));
+	}
+
+}
+
+SceneGraph::SceneGraph() : m_FirstDirty(NO_PARENT)
+{
+}
+
+unsigned int SceneGraph::CreateNode(unsigned int parent, const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale)
+{
+	unsigned int node = this->GetNodesCount();
+
+	m_Positions.push_back(position);
+	m_Rotations.push_back(rotation);
+	m_Scales.push_back(scale);
+	m_Parents.push_back(parent < node ? parent : NO_PARENT);
+	m_WorldMatrices.push_back(glm::mat4(1.0f));
+	m_Dirty.push_back(0);
+
+	MarkDirty(node);
+	return node;
+}
+
+void SceneGraph::Reserve(unsigned int count)
+{
+	m_Positions.reserve(count);
+	m_Rotations.reserve(count);
+	m_Scales.reserve(count);
+	m_Parents.reserve(count);
+	m_WorldMatrices.reserve(count);
+	m_Dirty.reserve(count);
+}
+
+void SceneGraph::Clear()
+{
+	m_Positions.clear();
+	m_Rotations.clear();
+	m_Scales.clear();
+	m_Parents.clear();
+	m_WorldMatrices.clear();
+	m_Dirty.clear();
+	m_ChangedNodes.clear();
+	m_FirstDirty = NO_PARENT;
+}
+
+void SceneGraph::SetPosition(unsigned int node, const glm::vec3& position)
+{
+	m_Positions[node] = position;
+	MarkDirty(node);
+}
+
+void SceneGraph::SetRotation(unsigned int node, const glm::quat& rotation)
+{
+	m_Rotations[node] = rotation;
+	MarkDirty(node);
+}
+
+void SceneGraph::SetScale(unsigned int node, const glm::vec3& scale)
+{
+	m_Scales[node] = scale;
+	MarkDirty(node);
+}
+
+void SceneGraph::MarkDirty(unsigned int node)
+{
+	m_Dirty[node] = 1;
+	m_FirstDirty = std::min(m_FirstDirty, node);
+}
+
+unsigned int SceneGraph::Update()
+{
+	m_ChangedNodes.clear();
+	if (NO_PARENT == m_FirstDirty) {
+		return 0;
+	}
+
+	/* Parents come first, by the time a node is reached its parent is up to date and its flag tells whether it moved */
+	const unsigned int count = this->GetNodesCount();
+	for (unsigned int node = m_FirstDirty; node < count; ++node) {
+		unsigned int parent = m_Parents[node];
+		if (NO_PARENT != parent && m_Dirty[parent]) {
+			m_Dirty[node] = 1;
+		}
+		if (!m_Dirty[node]) {
+			continue;
+		}
+
+		glm::mat4 local = ComposeTransform(m_Positions[node], m_Rotations[node], m_Scales[node]);
+		m_WorldMatrices[node] = NO_PARENT == parent ? local : m_WorldMatrices[parent] * local;
+		m_ChangedNodes.push_back(node);
+	}
+
+	/* Flags are kept until the end of the pass, children read them */
+	for (unsigned int node : m_ChangedNodes) {
+		m_Dirty[node] = 0;
+	}
+	m_FirstDirty = NO_PARENT;
+
+	return (unsigned int)m_ChangedNodes.size();
+}
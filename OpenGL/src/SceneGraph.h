@@ -0,0 +1,64 @@
+#pragma once
+
+#include <vector>
+#include "glm/glm.hpp"
+#include "glm/gtc/quaternion.hpp"
+
+/*
+	Transform hierarchy stored as flat arrays, one entry per node.
+	A node is always created after its parent, so the arrays are ordered parents first
+	and a single forward pass computes every world matrix from the one of its parent.
+	Setting a local transform only marks the node dirty, Update() recomputes the world matrices
+	of the dirty nodes and of their descendants, and lists them for the renderer.
+	Nothing is done for the nodes that did not change, static objects cost nothing per frame.
+*/
+class SceneGraph
+{
+public:
+	static constexpr unsigned int NO_PARENT = 0xFFFFFFFF;
+
+	SceneGraph();
+
+	/* Returns the index of the new node, parent must already exist */
+	unsigned int CreateNode(unsigned int parent = NO_PARENT,
+		const glm::vec3& position = glm::vec3(0.0f), const glm::quat& rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f), const glm::vec3& scale = glm::vec3(1.0f));
+	void Reserve(unsigned int count);
+	void Clear();
+
+	void SetPosition(unsigned int node, const glm::vec3& position);
+	void SetRotation(unsigned int node, const glm::quat& rotation);
+	void SetScale(unsigned int node, const glm::vec3& scale);
+
+	inline const glm::vec3& GetPosition(unsigned int node) const { return m_Positions[node]; }
+	inline const glm::quat& GetRotation(unsigned int node) const { return m_Rotations[node]; }
+	inline const glm::vec3& GetScale(unsigned int node) const { return m_Scales[node]; }
+	inline unsigned int GetParent(unsigned int node) const { return m_Parents[node]; }
+	inline unsigned int GetNodesCount() const { return (unsigned int)m_Parents.size(); }
+
+	/* Up to date after Update() */
+	inline const glm::mat4& GetWorldMatrix(unsigned int node) const { return m_WorldMatrices[node]; }
+
+	/* Recomputes the world matrices that changed since the last call, returns their count */
+	unsigned int Update();
+
+	/* Nodes whose world matrix changed in the last Update(), in parents first order */
+	inline const std::vector<unsigned int>& GetChangedNodes() const { return m_ChangedNodes; }
+
+private:
+	void MarkDirty(unsigned int node);
+
+	/* Local transforms */
+	std::vector<glm::vec3> m_Positions;
+	std::vector<glm::quat> m_Rotations;
+	std::vector<glm::vec3> m_Scales;
+
+	std::vector<unsigned int> m_Parents;
+	std::vector<glm::mat4> m_WorldMatrices;
+
+	/* Local transform changed since the last update, or world matrix changed during the current one */
+	std::vector<unsigned char> m_Dirty;
+	/* Nodes before this one are clean, NO_PARENT when there is nothing to update */
+	unsigned int m_FirstDirty;
+
+	std::vector<unsigned int> m_ChangedNodes;
+};
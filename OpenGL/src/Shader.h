@@ -24,8 +24,12 @@ static constexpr const char* FRAGMENT_GOURAUD_SHADER_PATH = "res/shaders/gouraud
 
 static constexpr const char* VERTEX_TEXTURE_2D_SHADER_PATH = "res/shaders/texture2D.vert";
 static constexpr const char* VERTEX_TEXTURE_2D_POS_3D_SHADER_PATH = "res/shaders/texture2D_pos3D.vert";
+static constexpr const char* VERTEX_TEXTURE_2D_INSTANCED_SHADER_PATH = "res/shaders/texture2D_instanced.vert";
 static constexpr const char* FRAGMENT_TEXTURE_2D_SHADER_PATH = "res/shaders/texture2D.frag";
 
+static constexpr const char* VERTEX_QUANTIZED_POS_NORM_UMVP_SHADER_PATH = "res/shaders/quantized_pos_norm_umvp.vert";
+static constexpr const char* VERTEX_QUANTIZED_TEXTURE_2D_POS_3D_SHADER_PATH = "res/shaders/quantized_texture2D_pos3D.vert";
+
 static constexpr const char* VERTEX_POS_COL_UV_SHADER_PATH = "res/shaders/pos_col_uv.vert";
 static constexpr const char* FRAGMENT_POS_COL_UV_SHADER_PATH = "res/shaders/pos_col_uv.frag";
 
@@ -35,6 +39,7 @@ static constexpr const char* UNIFORM_VIEW = "u_View";
 static constexpr const char* UNIFORM_PROJ = "u_Proj";
 static constexpr const char* UNIFORM_MODEL_VIEW = "u_ModelView";
 static constexpr const char* UNIFORM_MVP = "u_MVP";
+static constexpr const char* UNIFORM_VIEW_PROJ = "u_ViewProj";
 static constexpr const char* UNIFORM_LIGHT_POSITION = "u_LightPosition";
 static constexpr const char* UNIFORM_LIGHT_COLOR = "u_LightColor";
 static constexpr const char* UNIFORM_OBJECT_COLOR = "u_ObjectColor";
@@ -47,6 +52,8 @@ static constexpr const char* UNIFORM_TEXTURE = "u_Texture";
 static constexpr const char* UNIFORM_TEXTURE1 = "u_Texture1";
 static constexpr const char* UNIFORM_TEXTURE2 = "u_Texture2";
 static constexpr const char* UNIFORM_MIX_LAMBDA = "u_MixLambda";
+static constexpr const char* UNIFORM_DEQUANT_OFFSET = "u_DequantOffset";
+static constexpr const char* UNIFORM_DEQUANT_SCALE = "u_DequantScale";
 
 typedef void (APIENTRYP GLGetObjectivHandler)(GLuint object, GLenum pname, GLint* params);
 typedef void (APIENTRYP GLGetObjectInfoLogHandler)(GLuint object, GLsizei maxLength, GLsizei* length, GLchar* infoLog);
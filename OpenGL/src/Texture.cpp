@@ -5,6 +5,12 @@
 
 static constexpr int RGBA_CHANNELS = 4;
 
+/* The mipmaps add a third to the base level */
+static long long GetTextureMemory(int width, int height)
+{
+	return (long long)width * height * RGBA_CHANNELS * 4 / 3;
+}
+
 Texture::Texture(const std::string& path)
 {
 	/*
@@ -33,6 +39,7 @@ Texture::Texture(const std::string& path)
 	/* Specify a two-dimensional texture image */
 	GLCheckErrorCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_Width, m_Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, localBuffer));
 	GLCheckErrorCall(glGenerateMipmap(GL_TEXTURE_2D));
+	Renderer::AddMemory(GetTextureMemory(m_Width, m_Height));
 
 	this->Unbind();
 	stbi_image_free(localBuffer);
@@ -41,6 +48,9 @@ Texture::Texture(const std::string& path)
 Texture::~Texture()
 {
 	GLCheckErrorCall(glDeleteTextures(1, &m_RendererID));
+	if (m_RendererID) {
+		Renderer::AddMemory(-GetTextureMemory(m_Width, m_Height));
+	}
 }
 
 void Texture::Bind(unsigned int slot /* = 0 */) const
@@ -1,6 +1,29 @@
 #include "VertexArray.h"
 
 #include "Renderer.h"
+#include <GLFW/glfw3.h>
+
+/* ARB_vertex_attrib_binding (core in OpenGL 4.3) is not part of our 3.3 loader, its entry points are fetched at runtime */
+typedef void (APIENTRYP PFNVERTEXATTRIBFORMATPROC)(GLuint attribindex, GLint size, GLenum type, GLboolean normalized, GLuint relativeoffset);
+typedef void (APIENTRYP PFNVERTEXATTRIBBINDINGPROC)(GLuint attribindex, GLuint bindingindex);
+typedef void (APIENTRYP PFNBINDVERTEXBUFFERPROC)(GLuint bindingindex, GLuint buffer, GLintptr offset, GLsizei stride);
+
+static PFNVERTEXATTRIBFORMATPROC s_VertexAttribFormat = nullptr;
+static PFNVERTEXATTRIBBINDINGPROC s_VertexAttribBinding = nullptr;
+static PFNBINDVERTEXBUFFERPROC s_BindVertexBuffer = nullptr;
+
+static bool LoadAttribBinding()
+{
+	if (!glfwExtensionSupported("GL_ARB_vertex_attrib_binding")) {
+		return false;
+	}
+
+	s_VertexAttribFormat = (PFNVERTEXATTRIBFORMATPROC)glfwGetProcAddress("glVertexAttribFormat");
+	s_VertexAttribBinding = (PFNVERTEXATTRIBBINDINGPROC)glfwGetProcAddress("glVertexAttribBinding");
+	s_BindVertexBuffer = (PFNBINDVERTEXBUFFERPROC)glfwGetProcAddress("glBindVertexBuffer");
+
+	return nullptr != s_VertexAttribFormat && nullptr != s_VertexAttribBinding && nullptr != s_BindVertexBuffer;
+}
 
 VertexArray::VertexArray()
 {
@@ -27,6 +50,12 @@ void VertexArray::Unbind()
 }
 
 void VertexArray::AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout)
+{
+	const std::vector<VertexBufferElement>& elements = layout.GetElements();
+	AddBuffer(vb, elements.data(), (unsigned int)elements.size(), layout.GetStride());
+}
+
+void VertexArray::AddBuffer(const VertexBuffer& vb, const VertexBufferElement* elements, unsigned int count, GLsizei stride)
 {
 	this->Bind();
 
@@ -34,9 +63,7 @@ void VertexArray::AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& la
 		vb.Bind();
 	}
 
-	size_t offset = 0;
-	const std::vector<VertexBufferElement>& elements = layout.GetElements();
-	for (unsigned int index = 0; index < elements.size(); ++index) {
+	for (unsigned int index = 0; index < count; ++index) {
 		const VertexBufferElement& element = elements[index];
 
 		/* Enable the new coordinates attribute */
@@ -44,8 +71,50 @@ void VertexArray::AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& la
 
 		/* Define the attribute for the position array */
 		GLCheckErrorCall(glVertexAttribPointer(index, element.count, element.type, element.normalized,
-			layout.GetStride(), reinterpret_cast<const GLvoid*>(offset)));
+			stride, reinterpret_cast<const GLvoid*>(element.offset)));
+	}
+}
+
+void VertexArray::AddInstanceBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout, GLuint firstIndex, size_t offset)
+{
+	this->Bind();
+	vb.Bind();
+
+	const std::vector<VertexBufferElement>& elements = layout.GetElements();
+	for (unsigned int i = 0; i < elements.size(); ++i) {
+		const VertexBufferElement& element = elements[i];
+		GLuint index = firstIndex + i;
 
-		offset += element.size;
+		GLCheckErrorCall(glEnableVertexAttribArray(index));
+		GLCheckErrorCall(glVertexAttribPointer(index, element.count, element.type, element.normalized,
+			layout.GetStride(), reinterpret_cast<const GLvoid*>(offset + element.offset)));
+		GLCheckErrorCall(glVertexAttribDivisor(index, 1));
+	}
+}
+
+void VertexArray::SetFormat(const VertexBufferLayout& layout, GLuint bindingIndex)
+{
+	this->Bind();
+
+	const std::vector<VertexBufferElement>& elements = layout.GetElements();
+	for (unsigned int index = 0; index < elements.size(); ++index) {
+		const VertexBufferElement& element = elements[index];
+
+		GLCheckErrorCall(glEnableVertexAttribArray(index));
+
+		/* Offsets are relative to the vertex, the stride is given with the buffer */
+		GLCheckErrorCall(s_VertexAttribFormat(index, element.count, element.type, element.normalized, (GLuint)element.offset));
+		GLCheckErrorCall(s_VertexAttribBinding(index, bindingIndex));
 	}
 }
+
+void VertexArray::BindVertexBuffer(GLuint bindingIndex, const VertexBuffer& vb, GLsizei stride)
+{
+	GLCheckErrorCall(s_BindVertexBuffer(bindingIndex, vb.GetRendererID(), 0, stride));
+}
+
+bool VertexArray::IsAttribBindingSupported()
+{
+	static const bool s_Supported = LoadAttribBinding();
+	return s_Supported;
+}
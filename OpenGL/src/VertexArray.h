@@ -15,4 +15,29 @@ public:
 	static void Unbind();
 
 	void AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout);
+	/*
+		Attributes advancing once per instance instead of once per vertex, from location firstIndex on.
+		Calling it again with another offset makes the next instanced draw start from a different instance.
+	*/
+	void AddInstanceBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout, GLuint firstIndex, size_t offset = 0);
+
+	/*
+		ARB_vertex_attrib_binding: the attribute format is described once, reading from a binding point,
+		and any vertex buffer with that layout can then be attached to the point with BindVertexBuffer.
+		Only valid when IsAttribBindingSupported returns true.
+	*/
+	void SetFormat(const VertexBufferLayout& layout, GLuint bindingIndex);
+	/* Acts on the vertex array currently bound */
+	static void BindVertexBuffer(GLuint bindingIndex, const VertexBuffer& vb, GLsizei stride);
+	/* Needs a current context, the entry points are loaded on the first call */
+	static bool IsAttribBindingSupported();
+
+	template<typename Format>
+	void AddBuffer(const VertexBuffer& vb)
+	{
+		AddBuffer(vb, Format::ELEMENTS.data(), Format::ATTRIBUTES_COUNT, Format::STRIDE);
+	}
+
+private:
+	void AddBuffer(const VertexBuffer& vb, const VertexBufferElement* elements, unsigned int count, GLsizei stride);
 };
@@ -0,0 +1,148 @@
+#include "VertexArrayCache.h"
+
+#include "Renderer.h"
+
+std::weak_ptr<VertexArrayCache> VertexArrayCache::s_Shared;
+
+VertexArrayCache::VertexArrayCache() :
+	m_AttribBinding(VertexArray::IsAttribBindingSupported()), m_Hits(0), m_Misses(0)
+{
+}
+
+VertexArrayCache::~VertexArrayCache() {}
+
+const VertexArray& VertexArrayCache::Bind(const VertexBufferLayout& layout, const VertexBuffer& vb, const IndexBuffer* ib)
+{
+	const unsigned int vertexBufferID = vb.GetRendererID();
+	const unsigned int keyVertexBufferID = m_AttribBinding ? 0 : vertexBufferID;
+	const unsigned int indexBufferID = nullptr != ib ? ib->GetRendererID() : 0;
+	const size_t layoutHash = HashLayout(layout);
+	const size_t key = HashKey(layoutHash, keyVertexBufferID, indexBufferID);
+
+	Entry* entry = nullptr;
+	auto range = m_Entries.equal_range(key);
+	for (auto it = range.first; it != range.second; ++it) {
+		if (keyVertexBufferID == it->second.keyVertexBufferID && indexBufferID == it->second.indexBufferID &&
+			IsSameLayout(layout, it->second.layout)) {
+			entry = &it->second;
+			break;
+		}
+	}
+
+	if (nullptr != entry) {
+		++m_Hits;
+		entry->vertexArray->Bind();
+	} else {
+		++m_Misses;
+		auto it = m_Entries.emplace(key, Entry{ layout, keyVertexBufferID, indexBufferID, 0, std::make_unique<VertexArray>() });
+		entry = &it->second;
+
+		/* The new VAO is bound on creation */
+		if (m_AttribBinding) {
+			entry->vertexArray->SetFormat(layout, BINDING_INDEX);
+		} else {
+			entry->vertexArray->AddBuffer(vb, layout);
+			entry->boundVertexBufferID = vertexBufferID;
+		}
+
+		/* The element array binding is part of the VAO state */
+		if (nullptr != ib) {
+			ib->Bind();
+		}
+	}
+
+	/* The only state change needed to draw another mesh with the same format */
+	if (entry->boundVertexBufferID != vertexBufferID) {
+		VertexArray::BindVertexBuffer(BINDING_INDEX, vb, layout.GetStride());
+		entry->boundVertexBufferID = vertexBufferID;
+	}
+
+	return *entry->vertexArray;
+}
+
+void VertexArrayCache::Evict(unsigned int bufferID)
+{
+	for (auto it = m_Entries.begin(); it != m_Entries.end();) {
+		Entry& entry = it->second;
+		if (bufferID == entry.keyVertexBufferID || bufferID == entry.indexBufferID) {
+			it = m_Entries.erase(it);
+			continue;
+		}
+
+		/* Attribute binding VAOs stay valid, they just need a buffer attached again */
+		if (bufferID == entry.boundVertexBufferID) {
+			entry.boundVertexBufferID = 0;
+		}
+		++it;
+	}
+}
+
+std::shared_ptr<VertexArrayCache> VertexArrayCache::Get()
+{
+	/* Same lifetime rule as the static mesh heap: the VAOs go away before the OpenGL context */
+	std::shared_ptr<VertexArrayCache> cache = s_Shared.lock();
+	if (!cache) {
+		cache = std::make_shared<VertexArrayCache>();
+		s_Shared = cache;
+	}
+
+	return cache;
+}
+
+void VertexArrayCache::OnBufferDeleted(unsigned int bufferID)
+{
+	std::shared_ptr<VertexArrayCache> cache = s_Shared.lock();
+	if (cache) {
+		cache->Evict(bufferID);
+	}
+}
+
+size_t VertexArrayCache::HashLayout(const VertexBufferLayout& layout)
+{
+	/* FNV-1a over the fields that end up in the attribute pointers, 64 bits wide even where size_t is not */
+	uint64_t hash = 14695981039346656037ull;
+	auto combine = [&hash](uint64_t value) {
+		hash ^= value;
+		hash *= 1099511628211ull;
+	};
+
+	combine((uint64_t)layout.GetStride());
+	for (const VertexBufferElement& element : layout.GetElements()) {
+		combine((uint64_t)element.count);
+		combine((uint64_t)element.type);
+		combine((uint64_t)element.normalized);
+		combine((uint64_t)element.offset);
+	}
+
+	return FoldHash(hash);
+}
+
+bool VertexArrayCache::IsSameLayout(const VertexBufferLayout& a, const VertexBufferLayout& b)
+{
+	const std::vector<VertexBufferElement>& elementsA = a.GetElements();
+	const std::vector<VertexBufferElement>& elementsB = b.GetElements();
+	if (a.GetStride() != b.GetStride() || elementsA.size() != elementsB.size()) {
+		return false;
+	}
+
+	for (size_t i = 0; i < elementsA.size(); ++i) {
+		if (elementsA[i].count != elementsB[i].count || elementsA[i].type != elementsB[i].type ||
+			elementsA[i].normalized != elementsB[i].normalized || elementsA[i].offset != elementsB[i].offset) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+size_t VertexArrayCache::HashKey(size_t layoutHash, unsigned int vertexBufferID, unsigned int indexBufferID)
+{
+	const uint64_t hash = (uint64_t)layoutHash ^ ((uint64_t)vertexBufferID * 0x9E3779B97F4A7C15ull) ^ ((uint64_t)indexBufferID * 0xC2B2AE3D27D4EB4Full);
+	return FoldHash(hash);
+}
+
+size_t VertexArrayCache::FoldHash(uint64_t hash)
+{
+	/* Keeps the high bits in play on 32-bit targets */
+	return (size_t)(hash ^ (hash >> 32));
+}
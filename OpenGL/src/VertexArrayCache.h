@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+#include "VertexBufferLayout.h"
+
+/*
+	Shares vertex array objects among all the users of the same layout and buffers,
+	instead of having every mesh set up its own copy of the same attribute pointers.
+	VAOs are keyed by (layout hash, vertex buffer, index buffer). When ARB_vertex_attrib_binding
+	is available the vertex buffer is not part of the key: the attribute format is set once per VAO,
+	and drawing another buffer with the same format only changes the buffer attached to it.
+*/
+class VertexArrayCache
+{
+public:
+	VertexArrayCache();
+	~VertexArrayCache();
+
+	/* Binds the VAO reading these buffers, creating it on first use, ib may be null */
+	const VertexArray& Bind(const VertexBufferLayout& layout, const VertexBuffer& vb, const IndexBuffer* ib = nullptr);
+
+	/* Drops the VAOs referencing a buffer, since its name can be given to a new buffer */
+	void Evict(unsigned int bufferID);
+
+	inline unsigned int GetVertexArraysCount() const { return (unsigned int)m_Entries.size(); }
+	inline unsigned int GetHits() const { return m_Hits; }
+	inline unsigned int GetMisses() const { return m_Misses; }
+	inline bool UsesAttribBinding() const { return m_AttribBinding; }
+
+	/* Cache shared by the whole application, alive as long as someone holds it */
+	static std::shared_ptr<VertexArrayCache> Get();
+	/* Evicts the buffer from the shared cache, if there is one */
+	static void OnBufferDeleted(unsigned int bufferID);
+
+private:
+	static constexpr GLuint BINDING_INDEX = 0;
+
+	struct Entry
+	{
+		VertexBufferLayout layout;
+		/* 0 when the VAO uses attribute binding and can read any vertex buffer */
+		unsigned int keyVertexBufferID;
+		unsigned int indexBufferID;
+		/* Vertex buffer currently attached to the binding point */
+		unsigned int boundVertexBufferID;
+		std::unique_ptr<VertexArray> vertexArray;
+	};
+
+	static size_t HashLayout(const VertexBufferLayout& layout);
+	static bool IsSameLayout(const VertexBufferLayout& a, const VertexBufferLayout& b);
+	static size_t HashKey(size_t layoutHash, unsigned int vertexBufferID, unsigned int indexBufferID);
+	static size_t FoldHash(uint64_t hash);
+
+	static std::weak_ptr<VertexArrayCache> s_Shared;
+
+	const bool m_AttribBinding;
+	/* Hash of the whole key, entries with the same hash are told apart by comparing the keys */
+	std::unordered_multimap<size_t, Entry> m_Entries;
+
+	unsigned int m_Hits;
+	unsigned int m_Misses;
+};
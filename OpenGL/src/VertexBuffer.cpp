@@ -1,8 +1,9 @@
 #include "VertexBuffer.h"
 
 #include "Renderer.h"
+#include "VertexArrayCache.h"
 
-VertexBuffer::VertexBuffer(const void * data, size_t size)
+VertexBuffer::VertexBuffer(const void * data, size_t size) : m_Size(size)
 {
 	/* Generate Vertex Buffer with modern OpenGL */
 	GLCheckErrorCall(glGenBuffers(1, &m_RendererID));
@@ -10,11 +11,15 @@ VertexBuffer::VertexBuffer(const void * data, size_t size)
 
 	/* Pass the data and specify that it must be drawn */
 	GLCheckErrorCall(glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW));
+	Renderer::AddMemory((long long)size);
 }
 
 VertexBuffer::~VertexBuffer()
 {
+	/* The name may be reused by the next buffer created, cached vertex arrays must not point to it */
+	VertexArrayCache::OnBufferDeleted(m_RendererID);
 	GLCheckErrorCall(glDeleteBuffers(1, &m_RendererID));
+	Renderer::AddMemory(-(long long)m_Size);
 }
 
 void VertexBuffer::Bind() const
@@ -31,3 +36,30 @@ bool VertexBuffer::IsBound() const
 {
 	return 0 != m_RendererID;
 }
+
+void VertexBuffer::SetData(const void* data, size_t offset, size_t size)
+{
+	this->Bind();
+
+	/* Update a subset of the data store, the buffer is not reallocated */
+	GLCheckErrorCall(glBufferSubData(GL_ARRAY_BUFFER, offset, size, data));
+}
+
+void VertexBuffer::Orphan(size_t size)
+{
+	this->Bind();
+
+	GLCheckErrorCall(glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_STREAM_DRAW));
+	Renderer::AddMemory((long long)size - (long long)m_Size);
+	m_Size = size;
+}
+
+void VertexBuffer::CopyFrom(const VertexBuffer& source, size_t size)
+{
+	/* Server side copy, the data never goes back to the client */
+	GLCheckErrorCall(glBindBuffer(GL_COPY_READ_BUFFER, source.m_RendererID));
+	GLCheckErrorCall(glBindBuffer(GL_COPY_WRITE_BUFFER, m_RendererID));
+	GLCheckErrorCall(glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, size));
+	GLCheckErrorCall(glBindBuffer(GL_COPY_READ_BUFFER, 0));
+	GLCheckErrorCall(glBindBuffer(GL_COPY_WRITE_BUFFER, 0));
+}
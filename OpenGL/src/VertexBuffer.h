@@ -1,9 +1,12 @@
 #pragma once
 
+#include <cstddef>
+
 class VertexBuffer
 {
 private:
 	unsigned int m_RendererID;
+	size_t m_Size;
 public:
 	VertexBuffer(const void* data, size_t size);
 	~VertexBuffer();
@@ -11,4 +14,11 @@ public:
 	void Bind() const;
 	static void Unbind();
 	bool IsBound() const;
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline size_t GetSize() const { return m_Size; }
+
+	void SetData(const void* data, size_t offset, size_t size);
+	/* New storage for data streamed every frame, the GPU keeps reading the old one without syncing */
+	void Orphan(size_t size);
+	void CopyFrom(const VertexBuffer& source, size_t size);
 };
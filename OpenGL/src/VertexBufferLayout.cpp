@@ -1,3 +1,6 @@
 #include "VertexBufferLayout.h"
 
 VertexBufferLayout::VertexBufferLayout() : m_Stride(0) {}
+
+VertexBufferLayout::VertexBufferLayout(const VertexBufferElement* elements, unsigned int count, GLsizei stride) :
+	m_Stride(stride), m_Elements(elements, elements + count) {}
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <array>
 #include <vector>
+#include <cstddef>
 #include <glad/glad.h>
 
 struct VertexBufferElement
@@ -9,6 +11,35 @@ struct VertexBufferElement
 	GLenum type;
 	GLboolean normalized;
 	size_t size;
+	size_t offset;
+};
+
+/* Maps a C++ type to the matching OpenGL attribute type, used by VertexBufferLayout::Push */
+template<typename T>
+struct VertexAttributeType
+{
+	static_assert(sizeof(T) == 0, "Appropriate template specialization not found for VertexBufferLayout::Push");
+};
+
+template<>
+struct VertexAttributeType<unsigned char>
+{
+	static constexpr GLenum TYPE = GL_UNSIGNED_BYTE;
+	static constexpr GLboolean NORMALIZED = GL_TRUE;
+};
+
+template<>
+struct VertexAttributeType<unsigned int>
+{
+	static constexpr GLenum TYPE = GL_UNSIGNED_INT;
+	static constexpr GLboolean NORMALIZED = GL_FALSE;
+};
+
+template<>
+struct VertexAttributeType<float>
+{
+	static constexpr GLenum TYPE = GL_FLOAT;
+	static constexpr GLboolean NORMALIZED = GL_FALSE;
 };
 
 class VertexBufferLayout
@@ -19,37 +50,94 @@ private:
 
 public:
 	VertexBufferLayout();
+	VertexBufferLayout(const VertexBufferElement* elements, unsigned int count, GLsizei stride);
 
 	template<typename T>
 	void Push(GLint count)
 	{
-		static_assert(false, "Appropriate template specialization not found for VertexBufferLayout::Push");
+		size_t size = count * sizeof(T);
+		m_Elements.push_back({ count, VertexAttributeType<T>::TYPE, VertexAttributeType<T>::NORMALIZED, size, (size_t)m_Stride });
+		m_Stride += (GLsizei)size;
 	}
 
-	template<>
-	void Push<unsigned char>(GLint count)
+	inline GLsizei GetStride() const { return m_Stride; }
+	inline const std::vector<VertexBufferElement>& GetElements() const { return m_Elements; }
+};
+
+/*
+	Attribute descriptions for VertexFormat.
+	Packed formats trade precision for bandwidth, the shader still sees floats.
+*/
+namespace attrib {
+
+	template<GLint Count, GLenum Type, GLboolean Normalized, size_t ComponentSize>
+	struct Attribute
 	{
-		unsigned int size = count * sizeof(GLubyte);
-		m_Elements.push_back({ count, GL_UNSIGNED_BYTE, GL_TRUE, size });
-		m_Stride += size;
-	}
+		static constexpr GLint COUNT = Count;
+		static constexpr GLenum TYPE = Type;
+		static constexpr GLboolean NORMALIZED = Normalized;
+		static constexpr size_t SIZE = Count * ComponentSize;
+	};
+
+	template<GLint Count> struct Float : Attribute<Count, GL_FLOAT, GL_FALSE, sizeof(GLfloat)> {};
+	template<GLint Count> struct Half : Attribute<Count, GL_HALF_FLOAT, GL_FALSE, sizeof(GLhalf)> {};
+	template<GLint Count> struct UInt : Attribute<Count, GL_UNSIGNED_INT, GL_FALSE, sizeof(GLuint)> {};
+	/* Signed normalized: [-32767, 32767] maps to [-1, 1] */
+	template<GLint Count> struct NormShort : Attribute<Count, GL_SHORT, GL_TRUE, sizeof(GLshort)> {};
+	/* Unsigned normalized: [0, 65535] maps to [0, 1] */
+	template<GLint Count> struct NormUShort : Attribute<Count, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(GLushort)> {};
+	template<GLint Count> struct NormUByte : Attribute<Count, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(GLubyte)> {};
 
-	template<>
-	void Push<unsigned int>(GLint count)
+	/* x, y, z on 10 signed bits and w on 2, all in one 32 bit word: perfect for normals */
+	struct Int2101010Rev
 	{
-		unsigned int size = count * sizeof(GLuint);
-		m_Elements.push_back({ count, GL_UNSIGNED_INT, GL_FALSE, size });
-		m_Stride += size;
-	}
+		static constexpr GLint COUNT = 4;
+		static constexpr GLenum TYPE = GL_INT_2_10_10_10_REV;
+		static constexpr GLboolean NORMALIZED = GL_TRUE;
+		static constexpr size_t SIZE = sizeof(GLuint);
+	};
 
-	template<>
-	void Push<float>(GLint count)
+	/* Offsets are the running sum of the attribute sizes, in declaration order */
+	template<typename... Attributes>
+	constexpr std::array<VertexBufferElement, sizeof...(Attributes)> MakeElements()
 	{
-		unsigned int size = count * sizeof(GLfloat);
-		m_Elements.push_back({ count, GL_FLOAT, GL_FALSE, size });
-		m_Stride += size;
+		std::array<VertexBufferElement, sizeof...(Attributes)> elements = { {
+			{ Attributes::COUNT, Attributes::TYPE, Attributes::NORMALIZED, Attributes::SIZE, 0 }...
+		} };
+
+		size_t offset = 0;
+		for (size_t i = 0; i < elements.size(); ++i) {
+			elements[i].offset = offset;
+			offset += elements[i].size;
+		}
+
+		return elements;
 	}
 
-	inline GLsizei GetStride() const { return m_Stride; }
-	inline const std::vector<VertexBufferElement>& GetElements() const { return m_Elements; }
+}
+
+/*
+	Vertex layout known at compile time: stride and offsets are constant expressions,
+	so no allocation is needed to describe it, e.g.
+		using Format = VertexFormat<attrib::Float<3>, attrib::Int2101010Rev, attrib::Half<2>>;
+*/
+template<typename... Attributes>
+class VertexFormat
+{
+public:
+	static constexpr unsigned int ATTRIBUTES_COUNT = sizeof...(Attributes);
+	static constexpr GLsizei STRIDE = (GLsizei)(Attributes::SIZE + ... + 0);
+
+	static_assert(ATTRIBUTES_COUNT > 0, "VertexFormat needs at least one attribute");
+	/* Misaligned attributes are legal, but many drivers fall back to a slow path for them */
+	static_assert(0 == STRIDE % 4, "VertexFormat stride must be a multiple of 4 bytes");
+
+	static constexpr std::array<VertexBufferElement, ATTRIBUTES_COUNT> ELEMENTS = attrib::MakeElements<Attributes...>();
+
+	static constexpr size_t Offset(unsigned int index) { return ELEMENTS[index].offset; }
+
+	static VertexBufferLayout Layout()
+	{
+		return VertexBufferLayout(ELEMENTS.data(), ATTRIBUTES_COUNT, STRIDE);
+	}
 };
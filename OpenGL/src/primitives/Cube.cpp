@@ -2,27 +2,17 @@
 
 Cube::Cube()
 {
-	/* Generate vertex array object */
-	m_VAO = std::make_unique<VertexArray>();
+	/* All the cubes share the same vertex array and buffers, each one owns just a range of them */
+	m_Heap = GeometryHeap::GetStaticMeshHeap();
 
-	/* Create and bind vertex buffer */
-	m_VertexBuffer = std::make_unique<VertexBuffer>(s_Positions, POSITIONS_SIZE * sizeof(float));
-
-	/* Define a vertex buffer layout */
-	VertexBufferLayout layout;
-	layout.Push<float>(VERTEX_SIZE);
-	layout.Push<float>(NORMAL_SIZE);
-	layout.Push<float>(UV_SIZE);
-
-	/* m_VAO is defined by the pair (m_VertexBuffer, layout) */
-	m_VAO->AddBuffer(*m_VertexBuffer, layout);
+	this->SetMesh(MeshGenerator::CreateCube());
 }
 
 Cube::~Cube() {}
 
-void Cube::Draw()
+void Cube::Draw(unsigned int level)
 {
-	GLCheckErrorCall(glDrawArrays(GL_TRIANGLES, 0, CUBE_VERTICES));
+	m_LODs->Draw(level);
 }
 
 void Cube::SetMVP(const glm::mat4& MVP)
@@ -30,50 +20,12 @@ void Cube::SetMVP(const glm::mat4& MVP)
 	m_Shader->SetUniformMatrix4fv(UNIFORM_MVP, MVP);
 }
 
-const float Cube::s_Positions[] = {
-	/* Vertices */			/* Normals */			/* UV coordinates */
-	-0.5f, -0.5f, -0.5f,	 0.0f,  0.0f, -1.0f,	0.0f, 0.0f,
-	-0.5f,  0.5f, -0.5f,	 0.0f,  0.0f, -1.0f,	0.0f, 1.0f,
-	 0.5f,  0.5f, -0.5f,	 0.0f,  0.0f, -1.0f,	1.0f, 1.0f,
-	 0.5f,  0.5f, -0.5f,	 0.0f,  0.0f, -1.0f,	1.0f, 1.0f,
-	 0.5f, -0.5f, -0.5f,	 0.0f,  0.0f, -1.0f,	1.0f, 0.0f,
-	-0.5f, -0.5f, -0.5f,	 0.0f,  0.0f, -1.0f,	0.0f, 0.0f,
-
-	-0.5f, -0.5f,  0.5f,	 0.0f,  0.0f,  1.0f,	0.0f, 0.0f,
-	 0.5f, -0.5f,  0.5f,	 0.0f,  0.0f,  1.0f,	1.0f, 0.0f,
-	 0.5f,  0.5f,  0.5f,	 0.0f,  0.0f,  1.0f,	1.0f, 1.0f,
-	 0.5f,  0.5f,  0.5f,	 0.0f,  0.0f,  1.0f,	1.0f, 1.0f,
-	-0.5f,  0.5f,  0.5f,	 0.0f,  0.0f,  1.0f,	0.0f, 1.0f,
-	-0.5f, -0.5f,  0.5f,	 0.0f,  0.0f,  1.0f,	0.0f, 0.0f,
-
-	-0.5f,  0.5f,  0.5f,	-1.0f,  0.0f,  0.0f,	1.0f, 0.0f,
-	-0.5f,  0.5f, -0.5f,	-1.0f,  0.0f,  0.0f,	1.0f, 1.0f,
-	-0.5f, -0.5f, -0.5f,	-1.0f,  0.0f,  0.0f,	0.0f, 1.0f,
-	-0.5f, -0.5f, -0.5f,	-1.0f,  0.0f,  0.0f,	0.0f, 1.0f,
-	-0.5f, -0.5f,  0.5f,	-1.0f,  0.0f,  0.0f,	0.0f, 0.0f,
-	-0.5f,  0.5f,  0.5f,	-1.0f,  0.0f,  0.0f,	1.0f, 0.0f,
-
-	 0.5f,  0.5f,  0.5f,	 1.0f,  0.0f,  0.0f,	1.0f, 0.0f,
-	 0.5f, -0.5f,  0.5f,	 1.0f,  0.0f,  0.0f,	0.0f, 0.0f,
-	 0.5f, -0.5f, -0.5f,	 1.0f,  0.0f,  0.0f,	0.0f, 1.0f,
-	 0.5f, -0.5f, -0.5f,	 1.0f,  0.0f,  0.0f,	0.0f, 1.0f,
-	 0.5f,  0.5f, -0.5f,	 1.0f,  0.0f,  0.0f,	1.0f, 1.0f,
-	 0.5f,  0.5f,  0.5f,	 1.0f,  0.0f,  0.0f,	1.0f, 0.0f,
-
-	-0.5f, -0.5f, -0.5f,	 0.0f, -1.0f,  0.0f,	0.0f, 1.0f,
-	 0.5f, -0.5f, -0.5f,	 0.0f, -1.0f,  0.0f,	1.0f, 1.0f,
-	 0.5f, -0.5f,  0.5f,	 0.0f, -1.0f,  0.0f,	1.0f, 0.0f,
-	 0.5f, -0.5f,  0.5f,	 0.0f, -1.0f,  0.0f,	1.0f, 0.0f,
-	-0.5f, -0.5f,  0.5f,	 0.0f, -1.0f,  0.0f,	0.0f, 0.0f,
-	-0.5f, -0.5f, -0.5f,	 0.0f, -1.0f,  0.0f,	0.0f, 1.0f,
-
-	-0.5f,  0.5f, -0.5f,	 0.0f,  1.0f,  0.0f,	0.0f, 1.0f,
-	-0.5f,  0.5f,  0.5f,	 0.0f,  1.0f,  0.0f,	0.0f, 0.0f,
-	 0.5f,  0.5f,  0.5f,	 0.0f,  1.0f,  0.0f,	1.0f, 0.0f,
-	 0.5f,  0.5f,  0.5f,	 0.0f,  1.0f,  0.0f,	1.0f, 0.0f,
-	 0.5f,  0.5f, -0.5f,	 0.0f,  1.0f,  0.0f,	1.0f, 1.0f,
-	-0.5f,  0.5f, -0.5f,	 0.0f,  1.0f,  0.0f,	0.0f, 1.0f
-};
+void Cube::SetMesh(const MeshData& mesh, unsigned int levelsCount)
+{
+	/* Free the old levels first, the new ones can reuse their space in the heap */
+	m_LODs.reset();
+	m_LODs = std::make_unique<LODMesh>(mesh, levelsCount);
+}
 
 TexturedCube::TexturedCube(const char * texturePath)
 {
@@ -95,15 +47,15 @@ TexturedCube::~TexturedCube()
 
 void TexturedCube::Bind()
 {
-	m_VAO->Bind();
+	m_Heap->Bind();
 	m_Shader->Use();
 	m_Texture2D->Bind(0);
 }
 
 void TexturedCube::Unbind()
 {
-	m_VAO->Unbind();
-	m_VertexBuffer->Unbind();
+	GeometryHeap::Unbind();
+	VertexBuffer::Unbind();
 	m_Shader->Unuse();
 	m_Texture2D->Unbind();
 }
@@ -121,14 +73,14 @@ LampCube::~LampCube()
 
 void LampCube::Bind()
 {
-	m_VAO->Bind();
+	m_Heap->Bind();
 	m_Shader->Use();
 }
 
 void LampCube::Unbind()
 {
-	m_VAO->Unbind();
-	m_VertexBuffer->Unbind();
+	GeometryHeap::Unbind();
+	VertexBuffer::Unbind();
 	m_Shader->Unuse();
 }
 
@@ -146,13 +98,11 @@ LightedCube::LightedCube(glm::vec3 ambientColor, glm::vec3 objectColor, glm::vec
 	m_Shader->Use();
 
 	this->SetAmbientColor(ambientColor);
-	this->SetObjectColor(objectColor);
 	this->SetLightColor(lightColor);
 
-	this->SetAmbientStrenght(AMBIENT_STRENGHT_DEFAULT);
-	this->SetDiffuseStrenght(DIFFUSE_STRENGHT_DEFAULT);
-	this->SetSpecularStrenght(SPECULAR_STRENGHT_DEFAULT);
-	this->SetSpecularShininess(SPECULAR_SHININESS_DEFAULT);
+	Material material;
+	material.objectColor = objectColor;
+	this->SetMaterial(material);
 }
 
 LightedCube::~LightedCube()
@@ -162,14 +112,14 @@ LightedCube::~LightedCube()
 
 void LightedCube::Bind()
 {
-	m_VAO->Bind();
+	m_Heap->Bind();
 	m_Shader->Use();
 }
 
 void LightedCube::Unbind()
 {
-	m_VAO->Unbind();
-	m_VertexBuffer->Unbind();
+	GeometryHeap::Unbind();
+	VertexBuffer::Unbind();
 	m_Shader->Unuse();
 }
 
@@ -222,3 +172,12 @@ void LightedCube::SetSpecularShininess(float specularShininess)
 {
 	m_Shader->SetUniform1f(UNIFORM_SPECULAR_SHININESS, specularShininess);
 }
+
+void LightedCube::SetMaterial(const Material& material)
+{
+	this->SetObjectColor(material.objectColor);
+	this->SetAmbientStrenght(material.ambientStrenght);
+	this->SetDiffuseStrenght(material.diffuseStrenght);
+	this->SetSpecularStrenght(material.specularStrenght);
+	this->SetSpecularShininess(material.specularShininess);
+}
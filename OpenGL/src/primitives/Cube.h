@@ -1,8 +1,10 @@
 #pragma once
 
 #include <memory>
-#include "VertexArray.h"
-#include "VertexBuffer.h"
+#include "GeometryHeap.h"
+#include "MeshGenerator.h"
+#include "LODMesh.h"
+#include "Material.h"
 #include "Shader.h"
 #include "Texture.h"
 
@@ -12,23 +14,23 @@ public:
 	Cube();
 	virtual ~Cube();
 
-	void Draw();
+	/* The geometry ranges are freed by the destructor, a copy would free them twice */
+	Cube(const Cube&) = delete;
+	Cube& operator=(const Cube&) = delete;
+
+	/* Levels past the last one available draw the last one */
+	void Draw(unsigned int level = 0);
 	virtual void Bind() = 0;
 	virtual void Unbind() = 0;
 
 	void SetMVP(const glm::mat4& MVP);
+	/* Replaces the geometry, the cube keeps its shader and can be drawn as any other shape */
+	void SetMesh(const MeshData& mesh, unsigned int levelsCount = 1);
+	inline const LODMesh& GetLODs() const { return *m_LODs; }
 
 protected:
-	static constexpr int CUBE_VERTICES = 36;
-	static constexpr int VERTEX_SIZE = 3;
-	static constexpr int NORMAL_SIZE = 3;
-	static constexpr int UV_SIZE = 2;
-	static constexpr unsigned int POSITIONS_SIZE = CUBE_VERTICES * (VERTEX_SIZE + NORMAL_SIZE + UV_SIZE);
-
-	static const float s_Positions[POSITIONS_SIZE];
-
-	std::unique_ptr<VertexArray> m_VAO;
-	std::unique_ptr<VertexBuffer> m_VertexBuffer;
+	std::shared_ptr<GeometryHeap> m_Heap;
+	std::unique_ptr<LODMesh> m_LODs;
 	std::unique_ptr<Shader> m_Shader;
 };
 
@@ -77,10 +79,6 @@ public:
 	void SetDiffuseStrenght(float diffuseStrenght);
 	void SetSpecularStrenght(float specularStrenght);
 	void SetSpecularShininess(float specularShininess);
-
-private:
-	static constexpr float AMBIENT_STRENGHT_DEFAULT = 0.8f;
-	static constexpr float DIFFUSE_STRENGHT_DEFAULT = 1.0f;
-	static constexpr float SPECULAR_STRENGHT_DEFAULT = 0.5f;
-	static constexpr float SPECULAR_SHININESS_DEFAULT = 32.0f;
+	/* Object color and strenghts at once, the shader must be in use */
+	void SetMaterial(const Material& material);
 };
@@ -0,0 +1,259 @@
+#include "MeshGenerator.h"
+
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <unordered_map>
+
+#include "glm/glm.hpp"
+#include "glm/gtc/constants.hpp"
+
+MeshData MeshGenerator::Create(Shape shape, unsigned int tessellation)
+{
+	tessellation = std::max(tessellation, 1u);
+
+	switch (shape) {
+	case CUBE:
+		return CreateCube();
+	case UV_SPHERE:
+		return CreateUVSphere(4 * tessellation, 8 * tessellation);
+	case ICOSPHERE:
+		/* Triangles grow as 4^n, do not let the slider explode */
+		return CreateIcosphere(std::min(tessellation - 1, 7u));
+	case PLANE:
+		return CreatePlane(4 * tessellation, 4 * tessellation);
+	case CYLINDER:
+		return CreateCylinder(8 * tessellation, tessellation);
+	case TORUS:
+		return CreateTorus(12 * tessellation, 6 * tessellation);
+	default:
+		return CreateCube();
+	}
+}
+
+MeshData MeshGenerator::CreateCube()
+{
+	/* Face normal, then the u and v axes of the face, chosen so that u x v = normal */
+	static const glm::vec3 faces[6][3] = {
+		{ glm::vec3( 0.0f,  0.0f, -1.0f), glm::vec3(-1.0f, 0.0f,  0.0f), glm::vec3(0.0f, 1.0f, 0.0f) },
+		{ glm::vec3( 0.0f,  0.0f,  1.0f), glm::vec3( 1.0f, 0.0f,  0.0f), glm::vec3(0.0f, 1.0f, 0.0f) },
+		{ glm::vec3(-1.0f,  0.0f,  0.0f), glm::vec3( 0.0f, 0.0f,  1.0f), glm::vec3(0.0f, 1.0f, 0.0f) },
+		{ glm::vec3( 1.0f,  0.0f,  0.0f), glm::vec3( 0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f) },
+		{ glm::vec3( 0.0f, -1.0f,  0.0f), glm::vec3( 1.0f, 0.0f,  0.0f), glm::vec3(0.0f, 0.0f, 1.0f) },
+		{ glm::vec3( 0.0f,  1.0f,  0.0f), glm::vec3( 1.0f, 0.0f,  0.0f), glm::vec3(0.0f, 0.0f, -1.0f) }
+	};
+
+	MeshData mesh;
+	mesh.vertices.reserve(24 * MeshData::VERTEX_SIZE);
+	mesh.indices.reserve(36);
+
+	for (const glm::vec3* face : faces) {
+		const glm::vec3& normal = face[0];
+		const glm::vec3& u = face[1];
+		const glm::vec3& v = face[2];
+
+		unsigned int baseVertex = mesh.GetVertexCount();
+		for (unsigned int t = 0; t <= 1; ++t) {
+			for (unsigned int s = 0; s <= 1; ++s) {
+				glm::vec3 position = 0.5f * normal + (s - 0.5f) * u + (t - 0.5f) * v;
+				AddVertex(mesh, position.x, position.y, position.z, normal.x, normal.y, normal.z, (float)s, (float)t);
+			}
+		}
+		AddGridIndices(mesh, baseVertex, 1, 1);
+	}
+
+	return mesh;
+}
+
+MeshData MeshGenerator::CreateUVSphere(unsigned int rings, unsigned int segments)
+{
+	rings = std::max(rings, 2u);
+	segments = std::max(segments, 3u);
+
+	MeshData mesh;
+	mesh.vertices.reserve((rings + 1) * (segments + 1) * MeshData::VERTEX_SIZE);
+	mesh.indices.reserve(6 * rings * segments);
+
+	/* Rows go from the south pole to the north one, the seam column is duplicated for the uv */
+	for (unsigned int ring = 0; ring <= rings; ++ring) {
+		float v = (float)ring / rings;
+		float phi = (1.0f - v) * glm::pi<float>();
+		for (unsigned int segment = 0; segment <= segments; ++segment) {
+			float u = (float)segment / segments;
+			float theta = -u * glm::two_pi<float>();
+			glm::vec3 normal(sin(phi) * cos(theta), cos(phi), sin(phi) * sin(theta));
+			AddVertex(mesh, 0.5f * normal.x, 0.5f * normal.y, 0.5f * normal.z, normal.x, normal.y, normal.z, u, v);
+		}
+	}
+	AddGridIndices(mesh, 0, segments, rings);
+
+	return mesh;
+}
+
+MeshData MeshGenerator::CreateIcosphere(unsigned int subdivisions)
+{
+	const float t = (1.0f + sqrt(5.0f)) / 2.0f;
+	std::vector<glm::vec3> positions = {
+		glm::vec3(-1.0f,  t, 0.0f), glm::vec3( 1.0f,  t, 0.0f), glm::vec3(-1.0f, -t, 0.0f), glm::vec3( 1.0f, -t, 0.0f),
+		glm::vec3(0.0f, -1.0f,  t), glm::vec3(0.0f,  1.0f,  t), glm::vec3(0.0f, -1.0f, -t), glm::vec3(0.0f,  1.0f, -t),
+		glm::vec3( t, 0.0f, -1.0f), glm::vec3( t, 0.0f,  1.0f), glm::vec3(-t, 0.0f, -1.0f), glm::vec3(-t, 0.0f,  1.0f)
+	};
+	std::vector<unsigned int> indices = {
+		0, 11, 5,   0, 5, 1,    0, 1, 7,    0, 7, 10,   0, 10, 11,
+		1, 5, 9,    5, 11, 4,   11, 10, 2,  10, 7, 6,   7, 1, 8,
+		3, 9, 4,    3, 4, 2,    3, 2, 6,    3, 6, 8,    3, 8, 9,
+		4, 9, 5,    2, 4, 11,   6, 2, 10,   8, 6, 7,    9, 8, 1
+	};
+
+	for (glm::vec3& position : positions) {
+		position = glm::normalize(position);
+	}
+
+	/* Each edge is split once, the midpoint is shared by the two triangles using the edge */
+	for (unsigned int level = 0; level < subdivisions; ++level) {
+		std::unordered_map<uint64_t, unsigned int> midpoints;
+		auto midpoint = [&positions, &midpoints](unsigned int a, unsigned int b) {
+			uint64_t key = ((uint64_t)std::min(a, b) << 32) | std::max(a, b);
+			auto found = midpoints.find(key);
+			if (midpoints.end() != found) {
+				return found->second;
+			}
+
+			unsigned int index = (unsigned int)positions.size();
+			positions.push_back(glm::normalize(positions[a] + positions[b]));
+			midpoints[key] = index;
+			return index;
+		};
+
+		std::vector<unsigned int> subdivided;
+		subdivided.reserve(4 * indices.size());
+		for (size_t i = 0; i < indices.size(); i += 3) {
+			unsigned int a = indices[i], b = indices[i + 1], c = indices[i + 2];
+			unsigned int ab = midpoint(a, b), bc = midpoint(b, c), ca = midpoint(c, a);
+			subdivided.insert(subdivided.end(), { a, ab, ca, b, bc, ab, c, ca, bc, ab, bc, ca });
+		}
+		indices.swap(subdivided);
+	}
+
+	MeshData mesh;
+	mesh.vertices.reserve(positions.size() * MeshData::VERTEX_SIZE);
+	for (const glm::vec3& normal : positions) {
+		/* Spherical mapping, textures get stretched along the seam */
+		float u = 0.5f + atan2(normal.z, normal.x) / glm::two_pi<float>();
+		float v = 0.5f + asin(normal.y) / glm::pi<float>();
+		AddVertex(mesh, 0.5f * normal.x, 0.5f * normal.y, 0.5f * normal.z, normal.x, normal.y, normal.z, u, v);
+	}
+	mesh.indices = std::move(indices);
+
+	return mesh;
+}
+
+MeshData MeshGenerator::CreatePlane(unsigned int xSegments, unsigned int zSegments)
+{
+	xSegments = std::max(xSegments, 1u);
+	zSegments = std::max(zSegments, 1u);
+
+	MeshData mesh;
+	mesh.vertices.reserve((xSegments + 1) * (zSegments + 1) * MeshData::VERTEX_SIZE);
+	mesh.indices.reserve(6 * xSegments * zSegments);
+
+	/* Rows go towards -Z, so that (+X, -Z) keeps the triangles facing +Y */
+	for (unsigned int row = 0; row <= zSegments; ++row) {
+		float v = (float)row / zSegments;
+		for (unsigned int column = 0; column <= xSegments; ++column) {
+			float u = (float)column / xSegments;
+			AddVertex(mesh, u - 0.5f, 0.0f, 0.5f - v, 0.0f, 1.0f, 0.0f, u, v);
+		}
+	}
+	AddGridIndices(mesh, 0, xSegments, zSegments);
+
+	return mesh;
+}
+
+MeshData MeshGenerator::CreateCylinder(unsigned int segments, unsigned int stacks)
+{
+	segments = std::max(segments, 3u);
+	stacks = std::max(stacks, 1u);
+
+	MeshData mesh;
+
+	/* Side: rows go from the top to the bottom */
+	for (unsigned int stack = 0; stack <= stacks; ++stack) {
+		float v = 1.0f - (float)stack / stacks;
+		for (unsigned int segment = 0; segment <= segments; ++segment) {
+			float u = (float)segment / segments;
+			float theta = u * glm::two_pi<float>();
+			float x = cos(theta), z = sin(theta);
+			AddVertex(mesh, 0.5f * x, v - 0.5f, 0.5f * z, x, 0.0f, z, u, v);
+		}
+	}
+	AddGridIndices(mesh, 0, segments, stacks);
+
+	/* Caps: a fan around the center, with their own vertices for the flat normal */
+	for (float side : { 1.0f, -1.0f }) {
+		unsigned int center = mesh.GetVertexCount();
+		AddVertex(mesh, 0.0f, 0.5f * side, 0.0f, 0.0f, side, 0.0f, 0.5f, 0.5f);
+		for (unsigned int segment = 0; segment < segments; ++segment) {
+			float theta = (float)segment / segments * glm::two_pi<float>();
+			float x = cos(theta), z = sin(theta);
+			AddVertex(mesh, 0.5f * x, 0.5f * side, 0.5f * z, 0.0f, side, 0.0f, 0.5f + 0.5f * x, 0.5f + 0.5f * z);
+		}
+
+		for (unsigned int segment = 0; segment < segments; ++segment) {
+			unsigned int current = center + 1 + segment;
+			unsigned int next = center + 1 + (segment + 1) % segments;
+			if (side > 0.0f) {
+				mesh.indices.insert(mesh.indices.end(), { center, next, current });
+			} else {
+				mesh.indices.insert(mesh.indices.end(), { center, current, next });
+			}
+		}
+	}
+
+	return mesh;
+}
+
+MeshData MeshGenerator::CreateTorus(unsigned int ringSegments, unsigned int tubeSegments, float tubeRadius)
+{
+	ringSegments = std::max(ringSegments, 3u);
+	tubeSegments = std::max(tubeSegments, 3u);
+	const float ringRadius = 0.5f - tubeRadius;
+
+	MeshData mesh;
+	mesh.vertices.reserve((ringSegments + 1) * (tubeSegments + 1) * MeshData::VERTEX_SIZE);
+	mesh.indices.reserve(6 * ringSegments * tubeSegments);
+
+	/* Rows go around the ring, columns around the tube */
+	for (unsigned int ring = 0; ring <= ringSegments; ++ring) {
+		float v = (float)ring / ringSegments;
+		float theta = v * glm::two_pi<float>();
+		for (unsigned int tube = 0; tube <= tubeSegments; ++tube) {
+			float u = (float)tube / tubeSegments;
+			float phi = u * glm::two_pi<float>();
+			glm::vec3 normal(cos(phi) * cos(theta), sin(phi), cos(phi) * sin(theta));
+			glm::vec3 position = ringRadius * glm::vec3(cos(theta), 0.0f, sin(theta)) + tubeRadius * normal;
+			AddVertex(mesh, position.x, position.y, position.z, normal.x, normal.y, normal.z, u, v);
+		}
+	}
+	AddGridIndices(mesh, 0, tubeSegments, ringSegments);
+
+	return mesh;
+}
+
+void MeshGenerator::AddVertex(MeshData& mesh, float x, float y, float z, float nx, float ny, float nz, float u, float v)
+{
+	mesh.vertices.insert(mesh.vertices.end(), { x, y, z, nx, ny, nz, u, v });
+}
+
+void MeshGenerator::AddGridIndices(MeshData& mesh, unsigned int baseVertex, unsigned int columns, unsigned int rows)
+{
+	for (unsigned int row = 0; row < rows; ++row) {
+		for (unsigned int column = 0; column < columns; ++column) {
+			unsigned int a = baseVertex + row * (columns + 1) + column;
+			unsigned int b = a + 1;
+			unsigned int c = a + columns + 1;
+			unsigned int d = c + 1;
+			mesh.indices.insert(mesh.indices.end(), { a, b, c, b, d, c });
+		}
+	}
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vector>
+
+/* Indexed triangle list, vertices are interleaved floats: position (3), normal (3), uv (2) */
+struct MeshData
+{
+	static constexpr unsigned int VERTEX_SIZE = 8;
+
+	std::vector<float> vertices;
+	std::vector<unsigned int> indices;
+
+	inline unsigned int GetVertexCount() const { return (unsigned int)(vertices.size() / VERTEX_SIZE); }
+	inline unsigned int GetIndexCount() const { return (unsigned int)indices.size(); }
+};
+
+/*
+	Procedural primitives, all centered in the origin and fitting the unit cube.
+	Vertices are shared between adjacent triangles, except along hard edges and uv seams.
+	Triangles are counter-clockwise when seen from outside.
+*/
+class MeshGenerator
+{
+public:
+	enum Shape {
+		CUBE,
+		UV_SPHERE,
+		ICOSPHERE,
+		PLANE,
+		CYLINDER,
+		TORUS,
+		SHAPES_COUNT
+	};
+
+	static constexpr const char* SHAPE_NAMES[SHAPES_COUNT] = { "Cube", "UV Sphere", "Icosphere", "Plane", "Cylinder", "Torus" };
+
+	/* Builds a shape from a single level of detail, 1 is the coarsest */
+	static MeshData Create(Shape shape, unsigned int tessellation);
+
+	/* 24 vertices, 4 per face so that normals and uv coordinates stay per face */
+	static MeshData CreateCube();
+	static MeshData CreateUVSphere(unsigned int rings, unsigned int segments);
+	/* Starts from an icosahedron, every subdivision multiplies the triangles by 4 */
+	static MeshData CreateIcosphere(unsigned int subdivisions);
+	/* Lies on the XZ plane, facing +Y */
+	static MeshData CreatePlane(unsigned int xSegments, unsigned int zSegments);
+	static MeshData CreateCylinder(unsigned int segments, unsigned int stacks);
+	static MeshData CreateTorus(unsigned int ringSegments, unsigned int tubeSegments, float tubeRadius = TORUS_TUBE_RADIUS_DEFAULT);
+
+private:
+	static constexpr float TORUS_TUBE_RADIUS_DEFAULT = 0.15f;
+
+	static void AddVertex(MeshData& mesh, float x, float y, float z, float nx, float ny, float nz, float u, float v);
+	/* Two triangles per cell of a (columns + 1) x (rows + 1) vertex grid starting at baseVertex */
+	static void AddGridIndices(MeshData& mesh, unsigned int baseVertex, unsigned int columns, unsigned int rows);
+};
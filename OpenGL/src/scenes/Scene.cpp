@@ -1,24 +1,217 @@
 #include "Scene.h"
 
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+
 namespace scene {
 
-	SceneMenu::SceneMenu(AbstractScene*& currentScenePointer) : m_CurrentScene(currentScenePointer) {}
+	SceneMenu::SceneMenu(AbstractScene*& currentScenePointer) : m_CurrentScene(currentScenePointer),
+		m_CacheBudget(0), m_MenuState(RenderState::Capture()), m_Prewarm(false), m_PrewarmNext(0),
+		m_PrewarmDelay(0), m_ActiveIndex(NO_SCENE) {}
+
+	SceneMenu::~SceneMenu()
+	{
+		SetCacheBudget(0);
+	}
 
 	std::string SceneMenu::GetName() const { return name; }
 
 	void SceneMenu::OnUpdate(float deltaTime) {}
 
-	void SceneMenu::OnRender() {
+	void SceneMenu::OnRender(float alpha) {
 		Renderer::ClearColorSetDefault();
 		Renderer::Clear();
 	}
 
 	void SceneMenu::OnImGuiRender() {
+		PrewarmNext();
+
+		for (size_t i = 0; i < m_Scenes.size(); ++i) {
+			if (ImGui::Button(m_Scenes[i].first.c_str())) {
+				m_CurrentScene = AcquireScene(i);
+			}
+		}
+
+		if (m_CacheBudget > 0) {
+			ImGui::Text("%u kept, %.1f MB", (unsigned int)m_Cache.size(), GetCacheMemory() / (1024.0f * 1024.0f));
+		}
+	}
+
+	AbstractScene* SceneMenu::CreateScene(const std::string& name) const {
 		for (auto& scene : m_Scenes) {
-			if (ImGui::Button(scene.first.c_str())) {
-				m_CurrentScene = scene.second();
+			if (scene.first == name) {
+				return scene.second();
 			}
 		}
+		return nullptr;
+	}
+
+	std::vector<std::string> SceneMenu::GetSceneNames() const {
+		std::vector<std::string> names;
+		for (auto& scene : m_Scenes) {
+			names.push_back(scene.first);
+		}
+		return names;
+	}
+
+	void SceneMenu::ReleaseScene(AbstractScene* scene)
+	{
+		Renderer::MemoryScope memoryScope(GetActiveMemoryAccount());
+		if (NO_SCENE == m_ActiveIndex || 0 == m_CacheBudget) {
+			delete scene;
+			m_ActiveIndex = NO_SCENE;
+			return;
+		}
+
+		Suspend(m_ActiveIndex, scene);
+		m_ActiveIndex = NO_SCENE;
+		EvictOverBudget();
+	}
+
+	long long* SceneMenu::GetActiveMemoryAccount()
+	{
+		return NO_SCENE == m_ActiveIndex ? nullptr : &m_ScenesMemory[m_ActiveIndex];
+	}
+
+	void SceneMenu::SetCacheBudget(long long bytes)
+	{
+		m_CacheBudget = bytes;
+		EvictOverBudget();
+	}
+
+	SceneMenu::RenderState SceneMenu::RenderState::Capture()
+	{
+		RenderState state;
+		GLCheckErrorCall(state.depthTest = glIsEnabled(GL_DEPTH_TEST));
+		GLCheckErrorCall(state.blend = glIsEnabled(GL_BLEND));
+		GLCheckErrorCall(glGetIntegerv(GL_BLEND_SRC_RGB, &state.blendSource));
+		GLCheckErrorCall(glGetIntegerv(GL_BLEND_DST_RGB, &state.blendDestination));
+		GLCheckErrorCall(glGetFloatv(GL_COLOR_CLEAR_VALUE, state.clearColor));
+		GLCheckErrorCall(glGetIntegerv(GL_POLYGON_MODE, state.polygonMode));
+		GLCheckErrorCall(glGetIntegerv(GL_CURRENT_PROGRAM, &state.program));
+		GLCheckErrorCall(glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &state.vertexArray));
+		GLCheckErrorCall(glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &state.arrayBuffer));
+		GLCheckErrorCall(glGetIntegerv(GL_ACTIVE_TEXTURE, &state.activeTexture));
+		for (unsigned int unit = 0; unit < TEXTURE_UNITS; ++unit) {
+			GLCheckErrorCall(glActiveTexture(GL_TEXTURE0 + unit));
+			GLCheckErrorCall(glGetIntegerv(GL_TEXTURE_BINDING_2D, &state.textures2D[unit]));
+		}
+		GLCheckErrorCall(glActiveTexture(state.activeTexture));
+		return state;
+	}
+
+	void SceneMenu::RenderState::Apply() const
+	{
+		if (depthTest) {
+			GLCheckErrorCall(glEnable(GL_DEPTH_TEST));
+		} else {
+			GLCheckErrorCall(glDisable(GL_DEPTH_TEST));
+		}
+		if (blend) {
+			GLCheckErrorCall(glEnable(GL_BLEND));
+		} else {
+			GLCheckErrorCall(glDisable(GL_BLEND));
+		}
+		GLCheckErrorCall(glBlendFunc(blendSource, blendDestination));
+		GLCheckErrorCall(glClearColor(clearColor[0], clearColor[1], clearColor[2], clearColor[3]));
+		GLCheckErrorCall(glPolygonMode(GL_FRONT_AND_BACK, polygonMode[0]));
+		GLCheckErrorCall(glUseProgram(program));
+		GLCheckErrorCall(glBindVertexArray(vertexArray));
+		GLCheckErrorCall(glBindBuffer(GL_ARRAY_BUFFER, arrayBuffer));
+		for (unsigned int unit = 0; unit < TEXTURE_UNITS; ++unit) {
+			GLCheckErrorCall(glActiveTexture(GL_TEXTURE0 + unit));
+			GLCheckErrorCall(glBindTexture(GL_TEXTURE_2D, textures2D[unit]));
+		}
+		GLCheckErrorCall(glActiveTexture(activeTexture));
+	}
+
+	AbstractScene* SceneMenu::AcquireScene(size_t index)
+	{
+		m_ActiveIndex = index;
+		Renderer::MemoryScope memoryScope(&m_ScenesMemory[index]);
+
+		auto cached = std::find_if(m_Cache.begin(), m_Cache.end(), [index](const CachedScene& entry) { return entry.index == index; });
+		if (m_Cache.end() != cached) {
+			AbstractScene* scene = cached->scene;
+			cached->state.Apply();
+			m_Cache.erase(cached);
+			scene->OnResume();
+			return scene;
+		}
+
+		return m_Scenes[index].second();
+	}
+
+	void SceneMenu::Suspend(size_t index, AbstractScene* scene)
+	{
+		Renderer::MemoryScope memoryScope(&m_ScenesMemory[index]);
+		scene->OnSuspend();
+		m_Cache.push_back({ index, scene, RenderState::Capture() });
+		m_MenuState.Apply();
+	}
+
+	bool SceneMenu::EvictOverBudget()
+	{
+		bool evicted = false;
+		while (!m_Cache.empty() && GetCacheMemory() > m_CacheBudget) {
+			/* Destructors undo the state of their scene, it must be the current one */
+			m_Cache.front().state.Apply();
+			{
+				Renderer::MemoryScope memoryScope(&m_ScenesMemory[m_Cache.front().index]);
+				delete m_Cache.front().scene;
+			}
+			m_Cache.erase(m_Cache.begin());
+			m_MenuState.Apply();
+			evicted = true;
+		}
+		return !evicted;
+	}
+
+	void SceneMenu::PrewarmNext()
+	{
+		/* Shaders, textures and buffers need the context, so the scenes are built here rather than on a worker thread */
+		if (!m_Prewarm || 0 == m_CacheBudget) {
+			return;
+		}
+		if (m_PrewarmDelay > 0) {
+			--m_PrewarmDelay;
+			return;
+		}
+
+		while (m_PrewarmNext < m_Scenes.size()) {
+			const size_t index = m_PrewarmNext++;
+			if (m_Cache.end() != std::find_if(m_Cache.begin(), m_Cache.end(), [index](const CachedScene& entry) { return entry.index == index; })) {
+				continue;
+			}
+
+			auto start = std::chrono::high_resolution_clock::now();
+			AbstractScene* scene;
+			{
+				Renderer::MemoryScope memoryScope(&m_ScenesMemory[index]);
+				scene = m_Scenes[index].second();
+			}
+			Suspend(index, scene);
+
+			/* A constructor cannot be split, a slow one is paid back by menu frames without prewarming */
+			float milliseconds = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+			m_PrewarmDelay = (unsigned int)std::max(1.0f, std::ceil(milliseconds / PREWARM_MILLISECONDS_PER_FRAME)) - 1;
+			if (!EvictOverBudget()) {
+				/* Full: the next scenes would only push out the ones just built */
+				m_Prewarm = false;
+			}
+			return;
+		}
+		m_Prewarm = false;
+	}
+
+	long long SceneMenu::GetCacheMemory() const
+	{
+		long long memory = 0;
+		for (const CachedScene& entry : m_Cache) {
+			memory += std::max(0LL, m_ScenesMemory[entry.index]);
+		}
+		return memory;
 	}
 
 }
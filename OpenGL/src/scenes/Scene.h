@@ -1,6 +1,8 @@
 #pragma once
 
 #include <vector>
+#include <deque>
+#include <iostream>
 #include <utility>
 #include <string>
 #include <functional>
@@ -9,6 +11,8 @@
 #include "Renderer.h"
 #include "imgui/imgui.h"
 
+class FrameSnapshot;
+
 namespace scene {
 
 	class AbstractScene
@@ -19,9 +23,29 @@ namespace scene {
 
 		virtual std::string GetName() const = 0;
 
+		/*
+			Called with a fixed step, zero or more times per rendered frame.
+			It must not use the graphics API: with a render thread, the context is busy drawing the previous frame.
+		*/
 		virtual void OnUpdate(float deltaTime) = 0;
-		virtual void OnRender() = 0;
+		/*
+			alpha in [0, 1] tells how far the rendered frame is between the last two updates:
+			state drawn at previous + alpha * (current - previous) moves smoothly whatever the frame rate.
+		*/
+		virtual void OnRender(float alpha) = 0;
+		/*
+			Records the frame instead of drawing it, for the render thread to replay while the next one is updated.
+			Scenes that can only draw themselves return false, OnRender is called in its place.
+		*/
+		virtual bool OnSnapshot(FrameSnapshot& snapshot, float alpha) { return false; }
 		virtual void OnImGuiRender() = 0;
+
+		/*
+			The menu keeps left scenes alive to show them again without rebuilding them.
+			It saves and restores the graphics state itself, scenes only undo and redo what they change elsewhere.
+		*/
+		virtual void OnSuspend() {}
+		virtual void OnResume() {}
 	};
 
 	class SceneMenu : public AbstractScene {
@@ -29,11 +53,12 @@ namespace scene {
 		static constexpr const char* name = "Scene Menu";
 
 		SceneMenu(AbstractScene*& currentTestPointer);
+		~SceneMenu();
 
 		std::string GetName() const override;
 
 		void OnUpdate(float deltaTime) override;
-		void OnRender() override;
+		void OnRender(float alpha) override;
 		void OnImGuiRender() override;
 
 		/* Similar pattern used by std::make_shared to pass varargs to constructor */
@@ -50,11 +75,84 @@ namespace scene {
 #endif
 			std::cout << "Registering Scene --> " << name << std::endl;
 			m_Scenes.push_back(std::make_pair(name, [&args...]() { return new T(std::forward<Args>(args)...); }));
+			m_ScenesMemory.push_back(0);
 		}
 
+		/* Creates the scene registered with this name, null if there is none */
+		AbstractScene* CreateScene(const std::string& name) const;
+		std::vector<std::string> GetSceneNames() const;
+
+		/* Leaves the scene shown by the menu: suspended in the cache if it fits the budget, deleted otherwise */
+		void ReleaseScene(AbstractScene* scene);
+		/* 0 disables the cache, the least recently used scenes are deleted first when over budget */
+		void SetCacheBudget(long long bytes);
+		/*
+			Builds the registered scenes in the cache while the menu is shown, until the budget is full.
+			A scene is built in one go, the next one waits enough frames to keep the average under PREWARM_MILLISECONDS_PER_FRAME.
+		*/
+		inline void SetPrewarm(bool prewarm) { m_Prewarm = prewarm; }
+		/* Account of the scene shown, for a Renderer::MemoryScope around its calls, null while the menu is shown */
+		long long* GetActiveMemoryAccount();
+
 	private:
+		static constexpr size_t NO_SCENE = (size_t)-1;
+		static constexpr float PREWARM_MILLISECONDS_PER_FRAME = 2.0f;
+
+		/* Graphics state that scenes set in their constructors and undo in their destructors */
+		/* Units guaranteed to the fragment shader by OpenGL 3.3 */
+		static constexpr unsigned int TEXTURE_UNITS = 16;
+
+		struct RenderState
+		{
+			GLboolean depthTest;
+			GLboolean blend;
+			GLint blendSource;
+			GLint blendDestination;
+			GLfloat clearColor[4];
+			GLint polygonMode[2];
+			/* Scenes bind their program, VAO and textures once and rely on them staying bound */
+			GLint program;
+			GLint vertexArray;
+			GLint arrayBuffer;
+			GLint activeTexture;
+			GLint textures2D[TEXTURE_UNITS];
+
+			static RenderState Capture();
+			void Apply() const;
+		};
+
+		struct CachedScene
+		{
+			/* Index in m_Scenes */
+			size_t index;
+			AbstractScene* scene;
+			RenderState state;
+		};
+
+		/* Resumed from the cache, or created */
+		AbstractScene* AcquireScene(size_t index);
+		void Suspend(size_t index, AbstractScene* scene);
+		/* Returns false if the cache had to delete scenes to get back under budget */
+		bool EvictOverBudget();
+		void PrewarmNext();
+		long long GetCacheMemory() const;
+
 		AbstractScene*& m_CurrentScene;
 		std::vector<std::pair<std::string, std::function<AbstractScene*()>>> m_Scenes;
+		/* Bytes allocated by each registered scene and not freed yet, the deque keeps them in place for the scopes */
+		std::deque<long long> m_ScenesMemory;
+
+		/* Least recently used first */
+		std::vector<CachedScene> m_Cache;
+		long long m_CacheBudget;
+		RenderState m_MenuState;
+		bool m_Prewarm;
+		size_t m_PrewarmNext;
+		/* Menu frames left before the next scene is prewarmed */
+		unsigned int m_PrewarmDelay;
+
+		/* Index of the scene shown */
+		size_t m_ActiveIndex;
 	};
 
 }
@@ -3,7 +3,7 @@
 namespace scene {
 
 	SceneBasicSquare::SceneBasicSquare() :
-		m_Red(0.0f), m_RedIncrease(0.01f)
+		m_Red(0.0f), m_PreviousRed(0.0f), m_RedIncrease(0.01f)
 	{
 		const unsigned int POSITIONS_SIZE = 8;
 		const GLint VERTEX_SIZE = 2;
@@ -58,6 +58,10 @@ namespace scene {
 	std::string SceneBasicSquare::GetName() const { return name; }
 
 	void SceneBasicSquare::OnUpdate(float deltaTime) {
+		/* One step per update: the color changes at the same speed whatever the frame rate */
+		m_PreviousRed = m_Red;
+		m_Red += m_RedIncrease;
+
 		if (m_Red > 1.0f) {
 			m_Red = 2.0f - m_Red;
 			m_RedIncrease = -0.01f;
@@ -67,17 +71,15 @@ namespace scene {
 		}
 	}
 
-	void SceneBasicSquare::OnRender()
+	void SceneBasicSquare::OnRender(float alpha)
 	{
 		Renderer::Clear();
 
 		m_Shader->Use();
 		/* Set uniform variable */
-		m_Shader->SetUniform4f(UNIFORM_COLOR, m_Red, 0.3f, 0.8f, 1.0f);
+		m_Shader->SetUniform4f(UNIFORM_COLOR, glm::mix(m_PreviousRed, m_Red, alpha), 0.3f, 0.8f, 1.0f);
 
 		Renderer::Draw(*m_VAO, *m_IndexBuffer, *m_Shader);
-
-		m_Red += m_RedIncrease;
 	}
 
 	void SceneBasicSquare::OnImGuiRender() {}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <memory>
 #include "Scene.h"
 
 namespace scene {
@@ -14,11 +15,12 @@ namespace scene {
 		std::string GetName() const override;
 
 		void OnUpdate(float deltaTime) override;
-		void OnRender() override;
+		void OnRender(float alpha) override;
 		void OnImGuiRender() override;
 
 	private:
 		float m_Red;
+		float m_PreviousRed;
 		float m_RedIncrease;
 
 		std::unique_ptr<VertexArray> m_VAO;
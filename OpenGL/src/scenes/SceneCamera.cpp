@@ -1,16 +1,34 @@
 #include "SceneCamera.h"
 
+#include <chrono>
+#include <random>
+
 namespace scene {
 
 	SceneCamera::SceneCamera(Camera* camera, bool* useMainCamera) :
 		p_MainCamera(camera), p_UseMainCamera(useMainCamera),
-		m_CameraSpeed(5.0f)
+		m_CameraSpeed(5.0f), m_RunBenchmark(false), m_BenchmarkMilliseconds(0.0f)
 	{
 		*p_UseMainCamera = true;
 		p_MainCamera->SetCameraSpeed(m_CameraSpeed);
 
 		m_Cube = std::make_unique<TexturedCube>(CRATE_TEXTURE_PATH);
 
+		const glm::vec3 hCenter(-2.0f, 0.0f, 0.0f);
+		const glm::vec3 jCenter(2.0f, 0.0f, 0.0f);
+		unsigned int hNode = m_Graph.CreateNode(SceneGraph::NO_PARENT, hCenter);
+		unsigned int jNode = m_Graph.CreateNode(SceneGraph::NO_PARENT, jCenter);
+		for (int i = 0; i < TOTAL_CUBES; ++i) {
+			bool inH = i < H_CUBES;
+			m_Graph.CreateNode(inH ? hNode : jNode, m_CubesPositions[i] - (inH ? hCenter : jCenter));
+		}
+
+		/* Bounds are filled from the change list of the first update */
+		m_CubesBounds.Reserve(TOTAL_CUBES);
+		for (int i = 0; i < TOTAL_CUBES; ++i) {
+			m_CubesBounds.Add(glm::vec3(0.0f), m_Cube->GetLODs().GetBoundingRadius());
+		}
+
 		/* Enable blending */
 		GLCheckErrorCall(glEnable(GL_BLEND));
 		/* Transparency implementation */
@@ -32,22 +50,66 @@ namespace scene {
 
 	std::string SceneCamera::GetName() const { return name; }
 
+	void SceneCamera::OnSuspend()
+	{
+		*p_UseMainCamera = false;
+		p_MainCamera->ResetToDefaults();
+	}
+
+	void SceneCamera::OnResume()
+	{
+		*p_UseMainCamera = true;
+		p_MainCamera->SetCameraSpeed(m_CameraSpeed);
+	}
+
 	void SceneCamera::OnUpdate(float deltaTime)
 	{
 		p_MainCamera->SetCameraSpeed(m_CameraSpeed);
+
+		if (m_RunBenchmark) {
+			Frustum frustum = p_MainCamera->GetFrustum();
+			auto start = std::chrono::high_resolution_clock::now();
+			FrustumCulling::Cull(frustum, m_BenchmarkSpheres, m_BenchmarkVisible);
+			auto end = std::chrono::high_resolution_clock::now();
+			m_BenchmarkMilliseconds = std::chrono::duration<float, std::milli>(end - start).count();
+		}
+	}
+
+	void SceneCamera::CreateBenchmarkSpheres()
+	{
+		std::mt19937 rng(0);
+		std::uniform_real_distribution<float> randPosition(-0.5f * BENCHMARK_FIELD_SIZE, 0.5f * BENCHMARK_FIELD_SIZE);
+		std::uniform_real_distribution<float> randRadius(0.1f, 2.0f);
+
+		m_BenchmarkSpheres.Clear();
+		m_BenchmarkSpheres.Reserve(BENCHMARK_SPHERES);
+		for (unsigned int i = 0; i < BENCHMARK_SPHERES; ++i) {
+			m_BenchmarkSpheres.Add(glm::vec3(randPosition(rng), randPosition(rng), randPosition(rng)), randRadius(rng));
+		}
+		m_BenchmarkVisible.reserve(BENCHMARK_SPHERES);
 	}
 
-	void SceneCamera::OnRender()
+	void SceneCamera::OnRender(float alpha)
 	{
 		GLCheckErrorCall(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
 
 		m_View = p_MainCamera->GetViewMatrix();
 		m_Proj = p_MainCamera->GetPerspectiveProjMatrix();
 
-		for (int i = 0; i < TOTAL_CUBES; ++i) {
-			m_Model = glm::translate(glm::mat4(1.0f), m_CubesPositions[i]);
+		/* The cubes never move, after the first frame this does nothing */
+		m_Graph.Update();
+		for (unsigned int node : m_Graph.GetChangedNodes()) {
+			if (node >= FIRST_CUBE_NODE) {
+				unsigned int i = node - FIRST_CUBE_NODE;
+				m_CubesBounds.Set(i, glm::vec3(m_Graph.GetWorldMatrix(node)[3]), m_CubesBounds.radius[i]);
+			}
+		}
 
-			m_MVP = m_Proj * m_View * m_Model;
+		/* Only the cubes intersecting the view volume are sent to the GPU */
+		FrustumCulling::Cull(FrustumCulling::ExtractFrustum(m_Proj * m_View), m_CubesBounds, m_VisibleCubes);
+
+		for (unsigned int i : m_VisibleCubes) {
+			m_MVP = m_Proj * m_View * m_Graph.GetWorldMatrix(FIRST_CUBE_NODE + i);
 			m_Cube->SetMVP(m_MVP);
 			m_Cube->Draw();
 		}
@@ -58,6 +120,15 @@ namespace scene {
 		ImGui::Begin("Scene Camera");
 		ImGui::SliderFloat("Camera Speed", &m_CameraSpeed, 2.5f, 10.0f);
 		ImGui::Text("Use WASD and mouse to move and look around,\nUse scroll wheel to zoom");
+		ImGui::Text("Cubes drawn %u, culled %u", (unsigned int)m_VisibleCubes.size(), TOTAL_CUBES - (unsigned int)m_VisibleCubes.size());
+		ImGui::Text("World matrices updated %u", (unsigned int)m_Graph.GetChangedNodes().size());
+		if (ImGui::Checkbox("Culling benchmark (1M spheres)", &m_RunBenchmark) && m_RunBenchmark && 0 == m_BenchmarkSpheres.Size()) {
+			CreateBenchmarkSpheres();
+		}
+		if (m_RunBenchmark) {
+			unsigned int visible = (unsigned int)m_BenchmarkVisible.size();
+			ImGui::Text("%s: %u visible, %u culled in %.3f ms", FrustumCulling::GetInstructionSet(), visible, m_BenchmarkSpheres.Size() - visible, m_BenchmarkMilliseconds);
+		}
 		ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
 		ImGui::End();
 	}
@@ -2,6 +2,8 @@
 
 #include "Scene.h"
 #include "Camera.h"
+#include "FrustumCulling.h"
+#include "SceneGraph.h"
 #include "primitives/Cube.h"
 
 namespace scene {
@@ -16,11 +18,21 @@ namespace scene {
 		std::string GetName() const override;
 
 		void OnUpdate(float deltaTime) override;
-		void OnRender() override;
+		void OnRender(float alpha) override;
 		void OnImGuiRender() override;
+		void OnSuspend() override;
+		void OnResume() override;
 
 	private:
 		static constexpr int TOTAL_CUBES = 13;
+		/* Each letter is a node, its cubes are children placed relative to it */
+		static constexpr int H_CUBES = 7;
+		static constexpr unsigned int FIRST_CUBE_NODE = 2;
+		/* Random spheres culled every frame to measure the culling cost alone */
+		static constexpr unsigned int BENCHMARK_SPHERES = 1000000;
+		static constexpr float BENCHMARK_FIELD_SIZE = 200.0f;
+
+		void CreateBenchmarkSpheres();
 
 		Camera* p_MainCamera;
 		bool* p_UseMainCamera;
@@ -47,7 +59,15 @@ namespace scene {
 			glm::vec3( 3.0f,  1.0f, 0.0f)
 		};
 
-		glm::mat4 m_Model;
+		SceneGraph m_Graph;
+		BoundingSpheres m_CubesBounds;
+		std::vector<unsigned int> m_VisibleCubes;
+
+		bool m_RunBenchmark;
+		BoundingSpheres m_BenchmarkSpheres;
+		std::vector<unsigned int> m_BenchmarkVisible;
+		float m_BenchmarkMilliseconds;
+
 		glm::mat4 m_View;
 		glm::mat4 m_Proj;
 		glm::mat4 m_MVP;
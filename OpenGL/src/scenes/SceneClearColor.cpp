@@ -9,7 +9,7 @@ namespace scene {
 
 	void SceneClearColor::OnUpdate(float deltaTime) {}
 
-	void SceneClearColor::OnRender()
+	void SceneClearColor::OnRender(float alpha)
 	{
 		/* Specify clear values for the color buffers */
 		GLCheckErrorCall(glClearColor(m_ClearColor[0], m_ClearColor[1], m_ClearColor[2], m_ClearColor[3]));
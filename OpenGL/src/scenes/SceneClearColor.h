@@ -14,7 +14,7 @@ namespace scene {
 		std::string GetName() const override;
 
 		void OnUpdate(float deltaTime) override;
-		void OnRender() override;
+		void OnRender(float alpha) override;
 		void OnImGuiRender() override;
 
 	private:
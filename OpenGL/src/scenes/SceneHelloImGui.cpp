@@ -13,7 +13,7 @@ namespace scene {
 
 	void SceneHelloImGui::OnUpdate(float deltaTime) {}
 
-	void SceneHelloImGui::OnRender() {
+	void SceneHelloImGui::OnRender(float alpha) {
 		Renderer::Clear();
 	}
 
@@ -49,7 +49,7 @@ namespace scene {
 
 	void SceneHelloTriangle::OnUpdate(float deltaTime) {}
 
-	void SceneHelloTriangle::OnRender()
+	void SceneHelloTriangle::OnRender(float alpha)
 	{
 		Renderer::Clear();
 
@@ -71,6 +71,7 @@ namespace scene {
 		}
 
 		GLCheckErrorCall(glDrawArrays(GL_TRIANGLES, 0, TRIANGLE_VERTICES));
+		Renderer::AddDrawCalls();
 	}
 
 	void SceneHelloTriangle::OnImGuiRender()
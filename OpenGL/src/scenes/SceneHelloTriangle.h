@@ -1,5 +1,6 @@
 #pragma once
 
+#include <memory>
 #include "Scene.h"
 
 #include <math.h>
@@ -20,7 +21,7 @@ namespace scene {
 		std::string GetName() const override;
 
 		void OnUpdate(float deltaTime) override;
-		void OnRender() override;
+		void OnRender(float alpha) override;
 		void OnImGuiRender() override;
 
 	private:
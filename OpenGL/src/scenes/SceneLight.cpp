@@ -8,7 +8,6 @@ namespace scene {
 		p_MainCamera(camera), p_UseMainCamera(useMainCamera),
 		m_BackgroundColor(glm::vec3(0.1f, 0.2f, 0.2f)),
 		m_LightColor(glm::vec3(1.0f, 1.0f, 1.0f)),
-		m_AmbientStrenght(0.8f), m_DiffuseStrenght(1.0f), m_SpecularStrenght(0.5f), m_SpecularShininess(32.0f),
 		m_UseGouraudShading(false)
 	{
 		*p_UseMainCamera = true;
@@ -18,11 +17,10 @@ namespace scene {
 		m_LampCube->SetLightColor(m_LightColor);
 		m_LampCube->Unbind();
 
-		glm::vec3 objectColor(1.0f, 0.5f, 0.31f);
-		m_LightedCube = std::make_shared<LightedCube>(m_BackgroundColor, objectColor, m_LightColor);
+		m_LightedCube = std::make_shared<LightedCube>(m_BackgroundColor, m_Material.objectColor, m_LightColor);
 		m_LightedCube->Unbind();
 
-		m_GouraudLightedCube = std::make_shared<LightedCube>(m_BackgroundColor, objectColor, m_LightColor,
+		m_GouraudLightedCube = std::make_shared<LightedCube>(m_BackgroundColor, m_Material.objectColor, m_LightColor,
 			VERTEX_GOURAUD_SHADER_PATH, FRAGMENT_GOURAUD_SHADER_PATH);
 		m_GouraudLightedCube->Unbind();
 
@@ -49,9 +47,21 @@ namespace scene {
 
 	std::string SceneLight::GetName() const { return name; }
 
+	void SceneLight::OnSuspend()
+	{
+		*p_UseMainCamera = false;
+		p_MainCamera->ResetToDefaults();
+	}
+
+	void SceneLight::OnResume()
+	{
+		*p_UseMainCamera = true;
+		p_MainCamera->SetConstrainToGround(false);
+	}
+
 	void SceneLight::OnUpdate(float deltaTime) {}
 
-	void SceneLight::OnRender()
+	void SceneLight::OnRender(float alpha)
 	{
 		GLCheckErrorCall(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
 
@@ -93,10 +103,7 @@ namespace scene {
 			p_CurrentLightedCube->SetMVP(m_MVP);
 			p_CurrentLightedCube->SetLightColor(m_LightColor);
 			p_CurrentLightedCube->SetLightPosition(m_LightSourcePosition);
-			p_CurrentLightedCube->SetAmbientStrenght(m_AmbientStrenght);
-			p_CurrentLightedCube->SetDiffuseStrenght(m_DiffuseStrenght);
-			p_CurrentLightedCube->SetSpecularStrenght(m_SpecularStrenght);
-			p_CurrentLightedCube->SetSpecularShininess(m_SpecularShininess);
+			p_CurrentLightedCube->SetMaterial(m_Material);
 
 			p_CurrentLightedCube->Draw();
 			p_CurrentLightedCube->Unbind();
@@ -106,10 +113,11 @@ namespace scene {
 	void SceneLight::OnImGuiRender()
 	{
 		ImGui::Begin("Scene Light");
-		ImGui::SliderFloat("Ambient Strenght", &m_AmbientStrenght, 0.0f, 1.0f);
-		ImGui::SliderFloat("Diffuse Strenght", &m_DiffuseStrenght, 0.0f, 1.0f);
-		ImGui::SliderFloat("Specular Strenght", &m_SpecularStrenght, 0.0f, 1.0f);
-		ImGui::SliderFloat("Specular Shininess", &m_SpecularShininess, 1.0f, 256.0f);
+		ImGui::ColorEdit3("Object Color", &m_Material.objectColor.r);
+		ImGui::SliderFloat("Ambient Strenght", &m_Material.ambientStrenght, 0.0f, 1.0f);
+		ImGui::SliderFloat("Diffuse Strenght", &m_Material.diffuseStrenght, 0.0f, 1.0f);
+		ImGui::SliderFloat("Specular Strenght", &m_Material.specularStrenght, 0.0f, 1.0f);
+		ImGui::SliderFloat("Specular Shininess", &m_Material.specularShininess, 1.0f, 256.0f);
 		ImGui::Checkbox("Use Gouraud shading", &m_UseGouraudShading);
 		ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
 		ImGui::End();
@@ -16,8 +16,10 @@ namespace scene {
 		std::string GetName() const override;
 
 		void OnUpdate(float deltaTime) override;
-		void OnRender() override;
+		void OnRender(float alpha) override;
 		void OnImGuiRender() override;
+		void OnSuspend() override;
+		void OnResume() override;
 
 	private:
 		Camera* p_MainCamera;
@@ -32,10 +34,7 @@ namespace scene {
 		std::shared_ptr<LightedCube> m_GouraudLightedCube;
 		LightedCube* p_CurrentLightedCube;
 
-		float m_AmbientStrenght;
-		float m_DiffuseStrenght;
-		float m_SpecularStrenght;
-		float m_SpecularShininess;
+		Material m_Material;
 		bool m_UseGouraudShading;
 
 		glm::mat4 m_Model;
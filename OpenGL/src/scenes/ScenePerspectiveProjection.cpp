@@ -1,25 +1,40 @@
 #include "ScenePerspectiveProjection.h"
 
+#include <chrono>
 #include <random>
+#include <cstring>
+#include <numeric>
+#include <algorithm>
+#include <sstream>
+#include <iomanip>
 #include <GLFW/glfw3.h>
 
+#include "MeshImporter.h"
+
 namespace scene {
 
-	ScenePerspectiveProjection::ScenePerspectiveProjection(int windowWidth, int windowHeight) :
-		m_ASPECT_RATIO((float)windowWidth / (float)windowHeight),
-		m_ModelScale(1.0f), m_CameraTranslateZ(10.0f), m_FOV(45.0f), m_ZBufferClearValue(1.0f)
+	ScenePerspectiveProjection::ScenePerspectiveProjection(int windowWidth, int windowHeight, const glm::vec2* cursorPosition) :
+		m_ASPECT_RATIO((float)windowWidth / (float)windowHeight), m_WindowWidth(windowWidth), m_WindowHeight(windowHeight),
+		m_CubesCount(CUBES_DEFAULT), m_UpdateMilliseconds(0.0f), m_DeltaTime(0.0f),
+		m_RefittedNodes(0), m_CullWithBVH(false), m_CullMilliseconds(0.0f),
+		m_UseOcclusionCulling(false), m_OccludedCubes(0), m_OcclusionMilliseconds(0.0f),
+		m_UseOcclusionQueries(false), m_SkippedDraws(0), m_ConditionalDraws(0),
+		p_CursorPosition(cursorPosition), m_PickedCube(BVH::INVALID_OBJECT), m_PickedDistance(0.0f),
+		m_ModelScale(1.0f), m_CameraTranslateZ(10.0f), m_FOV(45.0f), m_ZBufferClearValue(1.0f),
+		m_Shape(MeshGenerator::CUBE), m_Tessellation(4), m_UseLODs(true), m_UseCulling(true), m_DrawnTriangles(0)
 	{
 		cube = std::make_unique<TexturedCube>(CRATE_TEXTURE_PATH);
+		m_BoxProxy = std::make_unique<LampCube>();
+		memset(m_ModelPath, 0, sizeof(m_ModelPath));
 
-		std::random_device rd;
-		std::mt19937 rng(rd());
-		std::uniform_real_distribution<float> randTranslation(-15.0f, 15.0f);
-		std::uniform_real_distribution<float> randRotation(-1.0f, 1.0f);
+		CreateCubes(m_CubesCount);
 
-		for (int i = 0; i < TOTAL_CUBES; ++i) {
-			m_CubesPositions[i] = glm::vec3(randTranslation(rng), randTranslation(rng), -abs(randTranslation(rng)));
-			m_CubesRotations[i] = glm::vec3(randRotation(rng), randRotation(rng), randRotation(rng));
-		}
+		JobGraph::Job previousRotations = m_UpdateGraph.Add([this]() { SavePreviousRotations(); });
+		JobGraph::Job integrate = m_UpdateGraph.Add([this]() { m_Cubes.Integrate(m_DeltaTime); });
+		JobGraph::Job bounds = m_UpdateGraph.Add([this]() { m_Cubes.UpdateBounds(m_MeshesRadii); });
+		JobGraph::Job bvh = m_UpdateGraph.Add([this]() { UpdateBVH(); });
+		m_UpdateGraph.AddDependency(previousRotations, integrate);
+		m_UpdateGraph.AddDependency(bounds, bvh);
 
 		/* Enable blending */
 		GLCheckErrorCall(glEnable(GL_BLEND));
@@ -39,9 +54,209 @@ namespace scene {
 
 	std::string ScenePerspectiveProjection::GetName() const { return name; }
 
-	void ScenePerspectiveProjection::OnUpdate(float deltaTime) {}
+	void ScenePerspectiveProjection::CreateCubes(unsigned int count)
+	{
+		std::random_device rd;
+		std::mt19937 rng(rd());
+		std::uniform_real_distribution<float> randTranslation(-15.0f, 15.0f);
+		std::uniform_real_distribution<float> randRotation(-1.0f, 1.0f);
+
+		m_Cubes.Clear();
+		m_Cubes.Reserve(count);
+		for (unsigned int i = 0; i < count; ++i) {
+			glm::vec3 position(randTranslation(rng), randTranslation(rng), -abs(randTranslation(rng)));
+			EntityStore::Entity entity = m_Cubes.Create(position, glm::quat(1.0f, 0.0f, 0.0f, 0.0f), m_ModelScale);
+
+			glm::vec3 axis = glm::normalize(glm::vec3(randRotation(rng), randRotation(rng), randRotation(rng)));
+			m_Cubes.SetAngularVelocity(m_Cubes.GetIndex(entity), glm::radians((i % CUBES_DEFAULT + 1) * 17.0f) * axis);
+		}
+		m_CubesLevels.assign(count, 0);
+		m_OcclusionQueries.Resize(count);
+
+		/* Everything mirroring the store follows it now, the cubes can be drawn before the next update */
+		m_MeshesRadii.assign(1, cube->GetLODs().GetBoundingRadius());
+		SavePreviousRotations();
+		ComputeWorldMatrices(1.0f);
+		m_Cubes.UpdateBounds(m_MeshesRadii);
+		UpdateBVH();
+	}
+
+	void ScenePerspectiveProjection::SavePreviousRotations()
+	{
+		const unsigned int count = m_Cubes.GetCount();
+		m_PreviousRotations.resize(count);
+		for (unsigned int i = 0; i < count; ++i) {
+			m_PreviousRotations[i] = m_Cubes.GetRotation(i);
+		}
+	}
+
+	void ScenePerspectiveProjection::ComputeWorldMatrices(float alpha)
+	{
+		const unsigned int count = m_Cubes.GetCount();
+		m_WorldMatrices.resize(count);
+		JobSystem::Get().ParallelFor(count, MIN_CUBES_PER_JOB, [this, alpha](unsigned int begin, unsigned int end) {
+			for (unsigned int i = begin; i < end; ++i) {
+				glm::quat rotation = glm::slerp(m_PreviousRotations[i], m_Cubes.GetRotation(i), alpha);
+				m_WorldMatrices[i] = glm::scale(glm::translate(glm::mat4(1.0f), m_Cubes.GetPosition(i)) * glm::mat4_cast(rotation), glm::vec3(m_Cubes.scale[i]));
+			}
+		});
+	}
+
+	void ScenePerspectiveProjection::OnUpdate(float deltaTime)
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+
+		/* Every loop runs over the dense arrays, no per cube object to visit */
+		m_MeshesRadii.assign(1, cube->GetLODs().GetBoundingRadius());
+		m_DeltaTime = deltaTime;
+		JobSystem::Get().Run(m_UpdateGraph);
+
+		auto end = std::chrono::high_resolution_clock::now();
+		m_UpdateMilliseconds = std::chrono::duration<float, std::milli>(end - start).count();
+	}
+
+	void ScenePerspectiveProjection::UpdateBVH()
+	{
+		const unsigned int count = m_Cubes.GetCount();
+		const BoundingSpheres& bounds = m_Cubes.bounds;
+
+		if (m_BVH.GetObjectsCount() != count) {
+			m_CubesBoxes.resize(count);
+			for (unsigned int i = 0; i < count; ++i) {
+				m_CubesBoxes[i] = AABB::FromSphere(glm::vec3(bounds.centerX[i], bounds.centerY[i], bounds.centerZ[i]), bounds.radius[i]);
+			}
+			m_BVH.Build(m_CubesBoxes);
+			m_RefittedNodes = m_BVH.GetNodesCount();
+			return;
+		}
+
+		/* Rotations do not move the spheres, boxes change with the scale and the mesh only */
+		for (unsigned int i = 0; i < count; ++i) {
+			AABB box = AABB::FromSphere(glm::vec3(bounds.centerX[i], bounds.centerY[i], bounds.centerZ[i]), bounds.radius[i]);
+			if (!(box == m_CubesBoxes[i])) {
+				m_CubesBoxes[i] = box;
+				m_BVH.SetBox(i, box);
+			}
+		}
+		m_RefittedNodes = m_BVH.Refit();
+	}
+
+	void ScenePerspectiveProjection::PickCube()
+	{
+		/* Cursor to normalized device coordinates, glfw y goes down */
+		float x = 2.0f * p_CursorPosition->x / m_WindowWidth - 1.0f;
+		float y = 1.0f - 2.0f * p_CursorPosition->y / m_WindowHeight;
+
+		glm::mat4 inverseViewProj = glm::inverse(m_Proj * m_View);
+		glm::vec4 nearPoint = inverseViewProj * glm::vec4(x, y, -1.0f, 1.0f);
+		glm::vec4 farPoint = inverseViewProj * glm::vec4(x, y, 1.0f, 1.0f);
+		glm::vec3 origin = glm::vec3(nearPoint) / nearPoint.w;
+		glm::vec3 direction = glm::vec3(farPoint) / farPoint.w - origin;
+
+		m_PickedDistance = glm::length(direction);
+		direction /= m_PickedDistance;
+		m_PickedCube = m_BVH.RayCast(origin, direction, m_PickedDistance);
+	}
 
-	void ScenePerspectiveProjection::OnRender()
+	void ScenePerspectiveProjection::CullOccluded()
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+
+		m_CubesByDistance.clear();
+		for (unsigned int i : m_VisibleCubes) {
+			glm::vec3 viewCenter = glm::vec3(m_View * glm::vec4(m_Cubes.GetPosition(i), 1.0f));
+			m_CubesByDistance.push_back({ -viewCenter.z, i });
+		}
+		std::sort(m_CubesByDistance.begin(), m_CubesByDistance.end());
+
+		const MeshData& occluder = cube->GetLODs().GetOccluder();
+		m_OcclusionCulling.BeginFrame(m_Proj * m_View);
+		for (const auto& cubeByDistance : m_CubesByDistance) {
+			if (m_OcclusionCulling.GetOccludersCount() == MAX_OCCLUDERS) {
+				break;
+			}
+			unsigned int i = cubeByDistance.second;
+			glm::vec3 viewCenter = glm::vec3(m_View * glm::vec4(m_Cubes.GetPosition(i), 1.0f));
+			if (LODMesh::ComputeScreenSize(m_Proj, viewCenter, m_Cubes.bounds.radius[i]) >= OCCLUDER_MIN_SCREEN_SIZE) {
+				m_OcclusionCulling.AddOccluder(occluder, m_WorldMatrices[i]);
+			}
+		}
+		m_OcclusionCulling.RasterizeOccluders();
+
+		/* Occluders pass too, their boxes contain their own surface */
+		auto hidden = [this](unsigned int i) { return !m_OcclusionCulling.IsVisible(m_CubesBoxes[i]); };
+		auto end = std::remove_if(m_VisibleCubes.begin(), m_VisibleCubes.end(), hidden);
+		m_OccludedCubes = (unsigned int)(m_VisibleCubes.end() - end);
+		m_VisibleCubes.erase(end, m_VisibleCubes.end());
+
+		m_OcclusionMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+
+	void ScenePerspectiveProjection::RunBVHBenchmark()
+	{
+		std::mt19937 rng(0);
+		std::uniform_real_distribution<float> randPosition(-500.0f, 500.0f);
+		std::uniform_real_distribution<float> randRadius(0.5f, 2.0f);
+
+		std::vector<AABB> boxes(BENCHMARK_OBJECTS);
+		for (AABB& box : boxes) {
+			box = AABB::FromSphere(glm::vec3(randPosition(rng), randPosition(rng), randPosition(rng)), randRadius(rng));
+		}
+
+		auto elapsed = [](std::chrono::high_resolution_clock::time_point start) {
+			return std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+		};
+		std::ostringstream report;
+		report << std::fixed << std::setprecision(2) << BENCHMARK_OBJECTS << " boxes\n";
+
+		BVH bvh;
+		auto start = std::chrono::high_resolution_clock::now();
+		bvh.Build(boxes, false);
+		report << "Build 1 thread: " << elapsed(start) << " ms\n";
+		start = std::chrono::high_resolution_clock::now();
+		bvh.Build(boxes);
+		report << "Build " << JobSystem::Get().GetThreadsCount() << " threads: " << elapsed(start) << " ms, "
+			<< bvh.GetNodesCount() << " nodes, depth " << bvh.GetDepth() << "\n";
+
+		/* 1% of the objects move */
+		for (unsigned int i = 0; i < BENCHMARK_OBJECTS; i += 100) {
+			boxes[i].min += glm::vec3(1.0f);
+			boxes[i].max += glm::vec3(1.0f);
+			bvh.SetBox(i, boxes[i]);
+		}
+		start = std::chrono::high_resolution_clock::now();
+		unsigned int refitted = bvh.Refit();
+		report << "Refit 1%: " << elapsed(start) << " ms, " << refitted << " nodes\n";
+
+		std::vector<unsigned int> result;
+		start = std::chrono::high_resolution_clock::now();
+		unsigned int hits = 0;
+		for (unsigned int i = 0; i < BENCHMARK_QUERIES; ++i) {
+			glm::vec3 origin(randPosition(rng), randPosition(rng), randPosition(rng));
+			glm::vec3 direction = glm::normalize(glm::vec3(randPosition(rng), randPosition(rng), randPosition(rng)));
+			float distance = 1000.0f;
+			hits += BVH::INVALID_OBJECT != bvh.RayCast(origin, direction, distance) ? 1 : 0;
+		}
+		report << BENCHMARK_QUERIES << " ray casts: " << elapsed(start) << " ms, " << hits << " hits\n";
+
+		start = std::chrono::high_resolution_clock::now();
+		unsigned int found = 0;
+		for (unsigned int i = 0; i < BENCHMARK_QUERIES; ++i) {
+			found += bvh.QueryRange(glm::vec3(randPosition(rng), randPosition(rng), randPosition(rng)), 10.0f, result);
+		}
+		report << BENCHMARK_QUERIES << " range queries: " << elapsed(start) << " ms, " << found << " found\n";
+
+		Frustum frustum = FrustumCulling::ExtractFrustum(
+			glm::perspective(glm::radians(45.0f), m_ASPECT_RATIO, 0.1f, 500.0f) * glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f)));
+		start = std::chrono::high_resolution_clock::now();
+		unsigned int visible = bvh.QueryFrustum(frustum, result);
+		report << "Frustum query: " << elapsed(start) << " ms, " << visible << " visible";
+
+		m_BenchmarkReport = report.str();
+		std::cout << "BVH benchmark\n" << m_BenchmarkReport << std::endl;
+	}
+
+	void ScenePerspectiveProjection::OnRender(float alpha)
 	{
 		GLCheckErrorCall(glClearDepth(m_ZBufferClearValue));
 		GLCheckErrorCall(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
@@ -52,24 +267,170 @@ namespace scene {
 		/* N.B. Depth testing does not work if zNear is set to 0.0f ! */
 		m_Proj = glm::perspective<float>(glm::radians(m_FOV), m_ASPECT_RATIO, 0.1f, 100.0f);
 
-		for (int i = 0; i < TOTAL_CUBES; ++i) {
-			m_Model = glm::translate(glm::mat4(1.0f), m_CubesPositions[i]);
-			m_Model = glm::rotate(m_Model, (float)glfwGetTime() * glm::radians((i + 1) * 17.0f), m_CubesRotations[i]);
-			m_Model = glm::scale(m_Model, glm::vec3(m_ModelScale, m_ModelScale, m_ModelScale));
+		/* Cubes are shown between the last two updates, they keep spinning smoothly when frames come faster than updates */
+		ComputeWorldMatrices(alpha);
+
+		const LODMesh& lods = cube->GetLODs();
+		m_DrawnTriangles = 0;
+		cube->Bind();
+
+		PickCube();
 
-			m_MVP = m_Proj * m_View * m_Model;
-			cube->SetMVP(m_MVP);
-			cube->Draw();
+		if (m_UseCulling) {
+			auto start = std::chrono::high_resolution_clock::now();
+			Frustum frustum = FrustumCulling::ExtractFrustum(m_Proj * m_View);
+			if (m_CullWithBVH) {
+				m_BVH.QueryFrustum(frustum, m_VisibleCubes);
+			} else {
+				FrustumCulling::Cull(frustum, m_Cubes.bounds, m_VisibleCubes);
+			}
+			auto end = std::chrono::high_resolution_clock::now();
+			m_CullMilliseconds = std::chrono::duration<float, std::milli>(end - start).count();
+		} else {
+			m_VisibleCubes.resize(m_Cubes.GetCount());
+			std::iota(m_VisibleCubes.begin(), m_VisibleCubes.end(), 0);
+		}
+
+		m_OccludedCubes = 0;
+		if (m_UseOcclusionCulling) {
+			CullOccluded();
+		}
+
+		if (m_UseOcclusionQueries) {
+			DrawWithOcclusionQueries(lods);
+		} else {
+			for (unsigned int i : m_VisibleCubes) {
+				DrawCube(i, lods);
+			}
+		}
+	}
+
+	void ScenePerspectiveProjection::DrawCube(unsigned int index, const LODMesh& lods)
+	{
+		/* Farther cubes get coarser meshes, no need for more triangles than pixels */
+		if (m_UseLODs) {
+			glm::vec3 viewCenter = glm::vec3(m_View * glm::vec4(m_Cubes.GetPosition(index), 1.0f));
+			float screenSize = LODMesh::ComputeScreenSize(m_Proj, viewCenter, m_Cubes.bounds.radius[index]);
+			m_CubesLevels[index] = lods.SelectLevel(screenSize, m_CubesLevels[index]);
+		} else {
+			m_CubesLevels[index] = 0;
+		}
+		m_DrawnTriangles += lods.GetIndexCount(m_CubesLevels[index]) / 3;
+
+		m_MVP = m_Proj * m_View * m_WorldMatrices[index];
+		cube->SetMVP(m_MVP);
+		cube->Draw(m_CubesLevels[index]);
+	}
+
+	void ScenePerspectiveProjection::DrawWithOcclusionQueries(const LODMesh& lods)
+	{
+		m_HiddenCubes.clear();
+		m_SkippedDraws = 0;
+		m_ConditionalDraws = 0;
+
+		/* Cubes visible the last time are drawn first, querying their own pixels tells when they get hidden */
+		for (unsigned int i : m_VisibleCubes) {
+			m_OcclusionQueries.Poll(i);
+			if (!m_OcclusionQueries.IsVisible(i)) {
+				m_HiddenCubes.push_back(i);
+				continue;
+			}
+			bool queried = m_OcclusionQueries.Begin(i);
+			DrawCube(i, lods);
+			if (queried) {
+				m_OcclusionQueries.End();
+			}
+		}
+
+		if (m_HiddenCubes.empty()) {
+			return;
+		}
+
+		/* The others only test their boxes against the depth of the visible ones, without writing anything */
+		m_BoxProxy->Bind();
+		GLCheckErrorCall(glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE));
+		GLCheckErrorCall(glDepthMask(GL_FALSE));
+		auto end = m_HiddenCubes.begin();
+		for (unsigned int i : m_HiddenCubes) {
+			/* Still waiting for the previous box, the cube stays hidden */
+			if (!m_OcclusionQueries.Begin(i)) {
+				++m_SkippedDraws;
+				continue;
+			}
+			const AABB& box = m_CubesBoxes[i];
+			m_BoxProxy->SetMVP(m_Proj * m_View * glm::scale(glm::translate(glm::mat4(1.0f), box.GetCenter()), box.max - box.min));
+			m_BoxProxy->Draw();
+			m_OcclusionQueries.End();
+			*end++ = i;
+		}
+		m_HiddenCubes.erase(end, m_HiddenCubes.end());
+		GLCheckErrorCall(glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE));
+		GLCheckErrorCall(glDepthMask(GL_TRUE));
+
+		/* Box results are usually ready by now, the GPU discards the cubes still hidden and shows the others this frame */
+		cube->Bind();
+		for (unsigned int i : m_HiddenCubes) {
+			m_OcclusionQueries.BeginConditionalRender(i);
+			DrawCube(i, lods);
+			OcclusionQueries::EndConditionalRender();
+			++m_ConditionalDraws;
 		}
 	}
 
 	void ScenePerspectiveProjection::OnImGuiRender()
 	{
 		ImGui::Begin("Scene Perspective Projection");
-		ImGui::SliderFloat("Model Scale", &m_ModelScale, 1.0f, 10.0f);
+		if (ImGui::SliderFloat("Model Scale", &m_ModelScale, 1.0f, 10.0f)) {
+			m_Cubes.scale.assign(m_Cubes.GetCount(), m_ModelScale);
+		}
+		if (ImGui::SliderInt("Cubes", &m_CubesCount, 1, MAX_CUBES)) {
+			CreateCubes(m_CubesCount);
+		}
 		ImGui::SliderFloat("Camera Translate Z", &m_CameraTranslateZ, 10.0f, 100.0f);
 		ImGui::SliderFloat("Camera FOV", &m_FOV, 45.0f, 145.0f);
 		ImGui::SliderFloat("Z-buffer clear value", &m_ZBufferClearValue, 0.0f, 1.0f);
+		bool shapeChanged = ImGui::Combo("Shape", &m_Shape, MeshGenerator::SHAPE_NAMES, MeshGenerator::SHAPES_COUNT);
+		shapeChanged |= ImGui::SliderInt("Tessellation", &m_Tessellation, 1, 16);
+		if (shapeChanged) {
+			cube->SetMesh(MeshGenerator::Create((MeshGenerator::Shape)m_Shape, m_Tessellation), LODMesh::LEVELS_DEFAULT);
+		}
+		ImGui::InputText("Model (.obj, .gltf)", m_ModelPath, sizeof(m_ModelPath));
+		if (ImGui::Button("Load model")) {
+			MeshData model;
+			if (MeshImporter::Load(m_ModelPath, model)) {
+				MeshImporter::FitToUnitCube(model);
+				cube->SetMesh(model, LODMesh::LEVELS_DEFAULT);
+			}
+		}
+		ImGui::Checkbox("Levels of detail", &m_UseLODs);
+		ImGui::Checkbox("Frustum culling", &m_UseCulling);
+		ImGui::Text("Cubes drawn %u, culled %u", (unsigned int)m_VisibleCubes.size(), m_Cubes.GetCount() - (unsigned int)m_VisibleCubes.size());
+		ImGui::Text("Cubes update %.3f ms, BVH nodes refitted %u", m_UpdateMilliseconds, m_RefittedNodes);
+		ImGui::Checkbox("Cull with the BVH", &m_CullWithBVH);
+		ImGui::Text("Culling %.3f ms", m_CullMilliseconds);
+		ImGui::Checkbox("Occlusion culling (CPU)", &m_UseOcclusionCulling);
+		if (m_UseOcclusionCulling) {
+			ImGui::Text("Occluded %u, %u occluders, %u triangles, %.3f ms", m_OccludedCubes,
+				m_OcclusionCulling.GetOccludersCount(), m_OcclusionCulling.GetTrianglesCount(), m_OcclusionMilliseconds);
+		}
+		ImGui::Checkbox("Occlusion queries (GPU)", &m_UseOcclusionQueries);
+		if (m_UseOcclusionQueries) {
+			ImGui::Text("Hidden last frame: %u draws skipped, %u left to the GPU", m_SkippedDraws, m_ConditionalDraws);
+		}
+		if (BVH::INVALID_OBJECT != m_PickedCube) {
+			ImGui::Text("Under the cursor: cube %u at %.2f", m_PickedCube, m_PickedDistance);
+		} else {
+			ImGui::Text("Under the cursor: nothing");
+		}
+		if (ImGui::Button("BVH benchmark (1M boxes)")) {
+			RunBVHBenchmark();
+		}
+		ImGui::TextUnformatted(m_BenchmarkReport.c_str());
+		const LODMesh& lods = cube->GetLODs();
+		for (unsigned int level = 0; level < lods.GetLevelsCount(); ++level) {
+			ImGui::Text("LOD %u: %u triangles, error %.4f", level, lods.GetIndexCount(level) / 3, lods.GetError(level));
+		}
+		ImGui::Text("Triangles drawn %u, %u at full detail", m_DrawnTriangles, m_Cubes.GetCount() * lods.GetIndexCount(0) / 3);
 		ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
 		ImGui::End();
 	}
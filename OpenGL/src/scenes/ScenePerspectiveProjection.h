@@ -1,8 +1,15 @@
 #pragma once
 
 #include <memory>
+#include <string>
 #include "Scene.h"
 #include "primitives/Cube.h"
+#include "FrustumCulling.h"
+#include "EntityStore.h"
+#include "BVH.h"
+#include "OcclusionCulling.h"
+#include "OcclusionQueries.h"
+#include "JobSystem.h"
 
 namespace scene {
 
@@ -11,24 +18,82 @@ namespace scene {
 	public:
 		static constexpr const char* name = "Perspective Projection";
 
-		ScenePerspectiveProjection(int windowWidth, int windowHeight);
+		ScenePerspectiveProjection(int windowWidth, int windowHeight, const glm::vec2* cursorPosition);
 		~ScenePerspectiveProjection();
 
 		std::string GetName() const override;
 
 		void OnUpdate(float deltaTime) override;
-		void OnRender() override;
+		void OnRender(float alpha) override;
 		void OnImGuiRender() override;
 
 	private:
-		static constexpr int TOTAL_CUBES = 10;
+		static constexpr int CUBES_DEFAULT = 10;
+		static constexpr int MAX_CUBES = 10000;
+		static constexpr unsigned int BENCHMARK_OBJECTS = 1000000;
+		static constexpr unsigned int BENCHMARK_QUERIES = 1000;
+		/* The nearest big cubes hide the others, small ones are not worth rasterizing */
+		static constexpr unsigned int MAX_OCCLUDERS = 32;
+		static constexpr float OCCLUDER_MIN_SCREEN_SIZE = 0.05f;
+		static constexpr unsigned int MIN_CUBES_PER_JOB = 256;
 		const float m_ASPECT_RATIO;
+		const int m_WindowWidth;
+		const int m_WindowHeight;
+
+		void CreateCubes(unsigned int count);
+		void UpdateBVH();
+		void SavePreviousRotations();
+		/* World matrices with the rotations alpha of the way from the previous update to the last one */
+		void ComputeWorldMatrices(float alpha);
+		void PickCube();
+		/* Removes from m_VisibleCubes the cubes hidden behind the nearest ones */
+		void CullOccluded();
+		void DrawCube(unsigned int index, const LODMesh& lods);
+		/* Draws m_VisibleCubes skipping the ones the GPU found hidden, without waiting for it */
+		void DrawWithOcclusionQueries(const LODMesh& lods);
+		void RunBVHBenchmark();
 
 		std::unique_ptr<Cube> cube;
+		/* Unit cube drawn in place of the bounding boxes of the hidden cubes */
+		std::unique_ptr<Cube> m_BoxProxy;
+
+		/* Transforms and bounds of the cubes, all of them use mesh 0 */
+		EntityStore m_Cubes;
+		std::vector<float> m_MeshesRadii;
+		std::vector<glm::quat> m_PreviousRotations;
+		std::vector<glm::mat4> m_WorldMatrices;
+		std::vector<unsigned int> m_CubesLevels;
+		std::vector<unsigned int> m_VisibleCubes;
+		int m_CubesCount;
+		float m_UpdateMilliseconds;
+		/* Rotations and bounds do not depend on each other, the two chains run on different threads */
+		JobGraph m_UpdateGraph;
+		float m_DeltaTime;
+
+		/* Boxes of the bounding spheres, only the ones that changed are refitted */
+		BVH m_BVH;
+		std::vector<AABB> m_CubesBoxes;
+		unsigned int m_RefittedNodes;
+		bool m_CullWithBVH;
+		float m_CullMilliseconds;
+
+		OcclusionCulling m_OcclusionCulling;
+		std::vector<std::pair<float, unsigned int>> m_CubesByDistance;
+		bool m_UseOcclusionCulling;
+		unsigned int m_OccludedCubes;
+		float m_OcclusionMilliseconds;
+
+		OcclusionQueries m_OcclusionQueries;
+		std::vector<unsigned int> m_HiddenCubes;
+		bool m_UseOcclusionQueries;
+		unsigned int m_SkippedDraws;
+		unsigned int m_ConditionalDraws;
+
+		const glm::vec2* p_CursorPosition;
+		unsigned int m_PickedCube;
+		float m_PickedDistance;
+		std::string m_BenchmarkReport;
 
-		glm::vec3 m_CubesPositions[TOTAL_CUBES];
-		glm::vec3 m_CubesRotations[TOTAL_CUBES];
-		glm::mat4 m_Model;
 		glm::mat4 m_View;
 		glm::mat4 m_Proj;
 		glm::mat4 m_MVP;
@@ -37,6 +102,14 @@ namespace scene {
 		float m_CameraTranslateZ;
 		float m_FOV;
 		float m_ZBufferClearValue;
+
+		int m_Shape;
+		int m_Tessellation;
+		char m_ModelPath[256];
+
+		bool m_UseLODs;
+		bool m_UseCulling;
+		unsigned int m_DrawnTriangles;
 	};
 
 }
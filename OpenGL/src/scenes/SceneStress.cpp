@@ -0,0 +1,616 @@
+#include "SceneStress.h"
+
+#include <cmath>
+#include <chrono>
+#include <random>
+#include <cstdio>
+#include <algorithm>
+#include <sstream>
+#include <iomanip>
+
+namespace scene {
+
+	SceneStress::SceneStress(int windowWidth, int windowHeight) :
+		m_ASPECT_RATIO((float)windowWidth / (float)windowHeight), m_ObjectsPerBatch(1), m_CommandListsSize(0), m_RecordMilliseconds(0.0f),
+		m_SnapshotMilliseconds(0.0f), m_SnapshotRecorded(false),
+		m_HistoryOffset(0), m_UpdateMilliseconds(0.0f), m_ThreadsCount((int)JobSystem::Get().GetActiveThreads()),
+		m_Time(0.0f), m_PreviousTime(0.0f), m_TransformsTime(0.0f),
+		m_ObjectsSlider((float)OBJECTS_DEFAULT), m_ObjectsCount(OBJECTS_DEFAULT), m_Shape(MeshGenerator::CUBE), m_Tessellation(1),
+		m_TexturesCount(1), m_Strategy(NAIVE), m_Animate(true), m_DrawCalls(0), m_TextureBinds(0), m_BoundTexture(-1)
+	{
+		std::fill(m_CPUHistory, m_CPUHistory + HISTORY_SIZE, 0.0f);
+		std::fill(m_GPUHistory, m_GPUHistory + HISTORY_SIZE, 0.0f);
+
+		/* Same interleaved layout as MeshData */
+		m_Layout.Push<float>(3);
+		m_Layout.Push<float>(3);
+		m_Layout.Push<float>(2);
+
+		/* A mat4 attribute takes four locations, one per column */
+		for (unsigned int column = 0; column < 4; ++column) {
+			m_InstanceLayout.Push<float>(4);
+		}
+
+		m_Shader = std::make_unique<Shader>(VERTEX_TEXTURE_2D_POS_3D_SHADER_PATH, FRAGMENT_TEXTURE_2D_SHADER_PATH);
+		m_Shader->Use();
+		m_Shader->SetUniform1i(UNIFORM_TEXTURE, 0);
+		m_InstancedShader = std::make_unique<Shader>(VERTEX_TEXTURE_2D_INSTANCED_SHADER_PATH, FRAGMENT_TEXTURE_2D_SHADER_PATH);
+		m_InstancedShader->Use();
+		m_InstancedShader->SetUniform1i(UNIFORM_TEXTURE, 0);
+		Shader::Unuse();
+
+		for (const char* texturePath : { CRATE_TEXTURE_PATH, DICE_TEXTURE_PATH, AWESOME_FACE_TEXTURE_PATH }) {
+			m_Textures.push_back(std::make_unique<Texture>(texturePath));
+		}
+
+		CreateMesh();
+		CreateObjects();
+
+		/* Enable depth testing */
+		GLCheckErrorCall(glEnable(GL_DEPTH_TEST));
+
+		GLCheckErrorCall(glClearColor(0.10f, 0.10f, 0.15f, 1.00f));
+	}
+
+	SceneStress::~SceneStress()
+	{
+		VertexArray::Unbind();
+		Texture::Unbind();
+		GLCheckErrorCall(glDisable(GL_DEPTH_TEST));
+	}
+
+	std::string SceneStress::GetName() const { return name; }
+
+	void SceneStress::CreateMesh()
+	{
+		m_Mesh = MeshGenerator::Create((MeshGenerator::Shape)m_Shape, m_Tessellation);
+		const unsigned int vertexCount = m_Mesh.GetVertexCount();
+
+		/* The index buffer is recorded in the vertex array bound while creating it */
+		m_VertexArray = std::make_unique<VertexArray>();
+		m_VertexBuffer = std::make_unique<VertexBuffer>(m_Mesh.vertices.data(), m_Mesh.vertices.size() * sizeof(float));
+		m_VertexArray->AddBuffer(*m_VertexBuffer, m_Layout);
+		m_IndexBuffer = std::make_unique<IndexBuffer>(m_Mesh.indices.data(), m_Mesh.GetIndexCount());
+		if (m_InstanceBuffer) {
+			m_VertexArray->AddInstanceBuffer(*m_InstanceBuffer, m_InstanceLayout, INSTANCE_ATTRIBUTE);
+		}
+
+		/* The indices of a batch never change: the mesh ones repeated, each copy shifted past the previous vertices */
+		m_ObjectsPerBatch = std::max(1u, BATCH_VERTICES / vertexCount);
+		std::vector<unsigned int> batchIndices;
+		batchIndices.reserve(m_ObjectsPerBatch * m_Mesh.GetIndexCount());
+		for (unsigned int object = 0; object < m_ObjectsPerBatch; ++object) {
+			for (unsigned int index : m_Mesh.indices) {
+				batchIndices.push_back(object * vertexCount + index);
+			}
+		}
+		m_BatchVertices.resize(m_ObjectsPerBatch * m_Mesh.vertices.size());
+
+		m_BatchVertexArray = std::make_unique<VertexArray>();
+		m_BatchVertexBuffer = std::make_unique<VertexBuffer>(nullptr, m_BatchVertices.size() * sizeof(float));
+		m_BatchVertexArray->AddBuffer(*m_BatchVertexBuffer, m_Layout);
+		m_BatchIndexBuffer = std::make_unique<IndexBuffer>(batchIndices.data(), (unsigned int)batchIndices.size());
+
+		VertexArray::Unbind();
+		VertexBuffer::Unbind();
+
+		CreateCommands();
+	}
+
+	void SceneStress::CreateObjects()
+	{
+		const unsigned int count = (unsigned int)m_ObjectsCount;
+		const int side = (int)std::ceil(std::cbrt((float)count));
+		const float halfSide = 0.5f * (side - 1);
+
+		/* Same seed every time, so that a given count always gives the same scene to measure */
+		std::mt19937 rng(0);
+		std::uniform_real_distribution<float> randAxis(-1.0f, 1.0f);
+		std::uniform_real_distribution<float> randSpeed(0.5f, 2.0f);
+
+		m_Positions.resize(count);
+		m_Axes.resize(count);
+		m_Speeds.resize(count);
+		m_Models.resize(count);
+		for (unsigned int i = 0; i < count; ++i) {
+			int x = i % side;
+			int y = (i / side) % side;
+			int z = i / (side * side);
+			m_Positions[i] = OBJECTS_SPACING * glm::vec3(x - halfSide, y - halfSide, z - halfSide);
+			m_Axes[i] = glm::normalize(glm::vec3(randAxis(rng), randAxis(rng), randAxis(rng)) + glm::vec3(0.0f, 0.01f, 0.0f));
+			m_Speeds[i] = randSpeed(rng);
+		}
+		UpdateTransforms(m_TransformsTime);
+
+		m_InstanceBuffer = std::make_unique<VertexBuffer>(nullptr, count * sizeof(glm::mat4));
+		m_VertexArray->AddInstanceBuffer(*m_InstanceBuffer, m_InstanceLayout, INSTANCE_ATTRIBUTE);
+		VertexArray::Unbind();
+		VertexBuffer::Unbind();
+
+		/* Far enough to see the whole grid */
+		float extent = side * OBJECTS_SPACING;
+		m_View = glm::lookAt(glm::vec3(0.4f, 0.6f, 1.0f) * (extent + 2.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		m_Proj = glm::perspective<float>(glm::radians(45.0f), m_ASPECT_RATIO, 0.1f, 4.0f * (extent + 2.0f));
+
+		CreateCommands();
+	}
+
+	void SceneStress::CreateCommands()
+	{
+		if (!IndirectBuffer::IsSupported()) {
+			return;
+		}
+
+		/* baseInstance selects the model matrix of the object, the commands change only with the mesh and the count */
+		m_Commands.resize(m_Models.size());
+		for (unsigned int i = 0; i < m_Commands.size(); ++i) {
+			m_Commands[i] = { m_Mesh.GetIndexCount(), 1, 0, 0, i };
+		}
+		m_IndirectBuffer = std::make_unique<IndirectBuffer>(m_Commands.data(), (unsigned int)m_Commands.size());
+		IndirectBuffer::Unbind();
+	}
+
+	void SceneStress::UpdateTransforms(float time)
+	{
+		JobSystem::Get().ParallelFor((unsigned int)m_Models.size(), MIN_OBJECTS_PER_JOB, [this, time](unsigned int begin, unsigned int end) {
+			for (unsigned int i = begin; i < end; ++i) {
+				m_Models[i] = glm::rotate(glm::translate(glm::mat4(1.0f), m_Positions[i]), time * m_Speeds[i], m_Axes[i]);
+			}
+		});
+		m_TransformsTime = time;
+	}
+
+	void SceneStress::InterpolateTransforms(float alpha)
+	{
+		/* Objects are shown between the last two updates, they keep spinning smoothly when frames come faster than updates */
+		const float time = glm::mix(m_PreviousTime, m_Time, alpha);
+		if (time == m_TransformsTime) {
+			return;
+		}
+
+		auto start = std::chrono::high_resolution_clock::now();
+		UpdateTransforms(time);
+		auto end = std::chrono::high_resolution_clock::now();
+		m_UpdateMilliseconds = std::chrono::duration<float, std::milli>(end - start).count();
+	}
+
+	void SceneStress::MeasureScaling()
+	{
+		JobSystem& jobSystem = JobSystem::Get();
+		const unsigned int activeThreads = jobSystem.GetActiveThreads();
+
+		std::ostringstream report;
+		report << std::fixed << std::setprecision(3);
+		float singleThreadMilliseconds = 0.0f;
+		for (unsigned int threads = 1; threads <= jobSystem.GetThreadsCount(); ++threads) {
+			jobSystem.SetActiveThreads(threads);
+			auto start = std::chrono::high_resolution_clock::now();
+			for (unsigned int i = 0; i < SCALING_ITERATIONS; ++i) {
+				UpdateTransforms(m_TransformsTime);
+			}
+			auto end = std::chrono::high_resolution_clock::now();
+			float milliseconds = std::chrono::duration<float, std::milli>(end - start).count() / SCALING_ITERATIONS;
+			if (1 == threads) {
+				singleThreadMilliseconds = milliseconds;
+			}
+			report << threads << " threads: " << milliseconds << " ms, speedup " << singleThreadMilliseconds / milliseconds << "x\n";
+		}
+		jobSystem.SetActiveThreads(activeThreads);
+
+		m_ScalingReport = report.str();
+		std::cout << "Transforms update scaling, " << m_Models.size() << " objects\n" << m_ScalingReport << std::endl;
+	}
+
+	void SceneStress::UploadTransforms()
+	{
+		const size_t size = m_Models.size() * sizeof(glm::mat4);
+		m_InstanceBuffer->Orphan(size);
+		m_InstanceBuffer->SetData(m_Models.data(), 0, size);
+	}
+
+	unsigned int SceneStress::GetGroupFirst(int texture) const
+	{
+		return (unsigned int)((unsigned long long)m_Models.size() * texture / m_TexturesCount);
+	}
+
+	void SceneStress::BindTexture(int texture)
+	{
+		if (m_BoundTexture != texture) {
+			m_Textures[texture]->Bind(0);
+			m_BoundTexture = texture;
+			++m_TextureBinds;
+		}
+	}
+
+	void SceneStress::OnUpdate(float deltaTime)
+	{
+		/* The transforms are computed when a frame needs them, at the time it shows */
+		m_PreviousTime = m_Time;
+		if (m_Animate) {
+			m_Time += deltaTime;
+		}
+	}
+
+	void SceneStress::OnRender(float alpha)
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+
+		InterpolateTransforms(alpha);
+
+		GLCheckErrorCall(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
+
+		m_ViewProj = m_Proj * m_View;
+		m_DrawCalls = 0;
+		m_TextureBinds = 0;
+		m_BoundTexture = -1;
+
+		m_GPUTimer.Begin();
+		switch (m_Strategy) {
+		case NAIVE:
+			DrawNaive();
+			break;
+		case INSTANCED:
+			DrawInstanced();
+			break;
+		case BATCHED:
+			DrawBatched();
+			break;
+		case MULTI_DRAW_INDIRECT:
+			DrawMultiDrawIndirect();
+			break;
+		case COMMAND_LISTS:
+			DrawCommandLists();
+			break;
+		}
+		m_GPUTimer.End();
+
+		VertexArray::Unbind();
+
+		/* CPU time is the transforms update plus the submission, the GPU one comes from a few frames ago */
+		auto end = std::chrono::high_resolution_clock::now();
+		m_CPUHistory[m_HistoryOffset] = std::chrono::duration<float, std::milli>(end - start).count();
+		m_GPUHistory[m_HistoryOffset] = m_GPUTimer.GetElapsedMilliseconds();
+		m_HistoryOffset = (m_HistoryOffset + 1) % HISTORY_SIZE;
+	}
+
+	void SceneStress::DrawNaive()
+	{
+		m_Shader->Use();
+		m_VertexArray->Bind();
+
+		for (int texture = 0; texture < m_TexturesCount; ++texture) {
+			BindTexture(texture);
+			for (unsigned int i = GetGroupFirst(texture); i < GetGroupFirst(texture + 1); ++i) {
+				m_Shader->SetUniformMatrix4fv(UNIFORM_MVP, m_ViewProj * m_Models[i]);
+				GLCheckErrorCall(glDrawElements(GL_TRIANGLES, m_IndexBuffer->GetCount(), m_IndexBuffer->GetType(), nullptr));
+				Renderer::AddDrawCalls();
+				++m_DrawCalls;
+			}
+		}
+	}
+
+	void SceneStress::DrawInstanced()
+	{
+		UploadTransforms();
+
+		m_InstancedShader->Use();
+		m_InstancedShader->SetUniformMatrix4fv(UNIFORM_VIEW_PROJ, m_ViewProj);
+		m_VertexArray->Bind();
+
+		for (int texture = 0; texture < m_TexturesCount; ++texture) {
+			unsigned int first = GetGroupFirst(texture);
+			unsigned int count = GetGroupFirst(texture + 1) - first;
+			if (0 == count) {
+				continue;
+			}
+
+			/* No base instance in OpenGL 3.3: the group starts where the attributes point */
+			BindTexture(texture);
+			m_VertexArray->AddInstanceBuffer(*m_InstanceBuffer, m_InstanceLayout, INSTANCE_ATTRIBUTE, first * sizeof(glm::mat4));
+			GLCheckErrorCall(glDrawElementsInstanced(GL_TRIANGLES, m_IndexBuffer->GetCount(), m_IndexBuffer->GetType(), nullptr, (GLsizei)count));
+			Renderer::AddDrawCalls();
+			++m_DrawCalls;
+		}
+	}
+
+	void SceneStress::TransformBatch(unsigned int first, unsigned int objects)
+	{
+		const unsigned int vertexCount = m_Mesh.GetVertexCount();
+		const unsigned int floatsPerObject = vertexCount * MeshData::VERTEX_SIZE;
+		const float* source = m_Mesh.vertices.data();
+
+		/* Each object has its own slice of the batch, they can be filled in parallel */
+		JobSystem::Get().ParallelFor(objects, MIN_OBJECTS_PER_JOB / vertexCount + 1, [&](unsigned int begin, unsigned int end) {
+			float* destination = m_BatchVertices.data() + begin * floatsPerObject;
+			for (unsigned int object = begin; object < end; ++object) {
+				const glm::mat4& model = m_Models[first + object];
+				const glm::mat3 normalMatrix(model);
+				for (unsigned int v = 0; v < vertexCount; ++v) {
+					const float* vertex = source + v * MeshData::VERTEX_SIZE;
+					glm::vec3 position = glm::vec3(model * glm::vec4(vertex[0], vertex[1], vertex[2], 1.0f));
+					glm::vec3 normal = normalMatrix * glm::vec3(vertex[3], vertex[4], vertex[5]);
+					destination[0] = position.x;
+					destination[1] = position.y;
+					destination[2] = position.z;
+					destination[3] = normal.x;
+					destination[4] = normal.y;
+					destination[5] = normal.z;
+					destination[6] = vertex[6];
+					destination[7] = vertex[7];
+					destination += MeshData::VERTEX_SIZE;
+				}
+			}
+		});
+	}
+
+	void SceneStress::DrawBatched()
+	{
+		const unsigned int floatsPerObject = m_Mesh.GetVertexCount() * MeshData::VERTEX_SIZE;
+
+		/* Vertices are already in world space */
+		m_Shader->Use();
+		m_Shader->SetUniformMatrix4fv(UNIFORM_MVP, m_ViewProj);
+		m_BatchVertexArray->Bind();
+
+		for (int texture = 0; texture < m_TexturesCount; ++texture) {
+			BindTexture(texture);
+			const unsigned int groupEnd = GetGroupFirst(texture + 1);
+			for (unsigned int first = GetGroupFirst(texture); first < groupEnd; first += m_ObjectsPerBatch) {
+				const unsigned int objects = std::min(m_ObjectsPerBatch, groupEnd - first);
+				TransformBatch(first, objects);
+
+				m_BatchVertexBuffer->Orphan(m_BatchVertices.size() * sizeof(float));
+				m_BatchVertexBuffer->SetData(m_BatchVertices.data(), 0, objects * floatsPerObject * sizeof(float));
+				GLCheckErrorCall(glDrawElements(GL_TRIANGLES, objects * m_Mesh.GetIndexCount(), m_BatchIndexBuffer->GetType(), nullptr));
+				Renderer::AddDrawCalls();
+				++m_DrawCalls;
+			}
+		}
+	}
+
+	void SceneStress::DrawMultiDrawIndirect()
+	{
+		if (!IndirectBuffer::IsSupported()) {
+			DrawInstanced();
+			return;
+		}
+
+		UploadTransforms();
+
+		m_InstancedShader->Use();
+		m_InstancedShader->SetUniformMatrix4fv(UNIFORM_VIEW_PROJ, m_ViewProj);
+		m_VertexArray->Bind();
+		m_VertexArray->AddInstanceBuffer(*m_InstanceBuffer, m_InstanceLayout, INSTANCE_ATTRIBUTE);
+
+		/* One call per texture, each object is a command */
+		for (int texture = 0; texture < m_TexturesCount; ++texture) {
+			unsigned int first = GetGroupFirst(texture);
+			unsigned int count = GetGroupFirst(texture + 1) - first;
+			if (0 == count) {
+				continue;
+			}
+
+			BindTexture(texture);
+			m_IndirectBuffer->MultiDraw(GL_TRIANGLES, m_IndexBuffer->GetType(), first, count);
+			++m_DrawCalls;
+		}
+		IndirectBuffer::Unbind();
+	}
+
+	void SceneStress::DrawCommandLists()
+	{
+		RecordCommandLists(m_CommandLists);
+
+		/* The context thread only translates the commands */
+		for (const CommandList& commands : m_CommandLists) {
+			commands.Execute();
+		}
+	}
+
+	void SceneStress::RecordCommandLists(std::vector<CommandList>& lists)
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+
+		const unsigned int objectsCount = (unsigned int)m_Models.size();
+		lists.resize(JobSystem::Get().GetThreadsCount() * COMMAND_LISTS_PER_THREAD);
+		const unsigned int listsCount = (unsigned int)lists.size();
+
+		/* Same work as the naive path, the matrix products and the commands are prepared on all the threads */
+		JobSystem::Get().ParallelFor(listsCount, 1, [this, &lists, objectsCount, listsCount](unsigned int begin, unsigned int end) {
+			for (unsigned int list = begin; list < end; ++list) {
+				CommandList& commands = lists[list];
+				commands.Reset();
+
+				const unsigned int first = (unsigned int)((unsigned long long)objectsCount * list / listsCount);
+				const unsigned int last = (unsigned int)((unsigned long long)objectsCount * (list + 1) / listsCount);
+				if (first == last) {
+					continue;
+				}
+
+				commands.BindShader(*m_Shader);
+				commands.BindVertexArray(*m_VertexArray);
+				for (int texture = 0; texture < m_TexturesCount; ++texture) {
+					const unsigned int groupFirst = std::max(first, GetGroupFirst(texture));
+					const unsigned int groupEnd = std::min(last, GetGroupFirst(texture + 1));
+					if (groupFirst < groupEnd) {
+						commands.BindTexture(*m_Textures[texture]);
+					}
+					for (unsigned int i = groupFirst; i < groupEnd; ++i) {
+						commands.SetUniformMatrix4(UNIFORM_MVP, m_ViewProj * m_Models[i]);
+						commands.DrawIndexed(*m_IndexBuffer);
+					}
+				}
+			}
+		});
+
+		auto end = std::chrono::high_resolution_clock::now();
+		m_RecordMilliseconds = std::chrono::duration<float, std::milli>(end - start).count();
+
+		m_CommandListsSize = 0;
+		for (const CommandList& commands : lists) {
+			m_DrawCalls += commands.GetDrawsCount();
+			m_TextureBinds += commands.GetTextureBindsCount();
+			m_CommandListsSize += commands.GetSize();
+		}
+	}
+
+	void SceneStress::RecordInstanced(CommandList& commands)
+	{
+		if (m_Models.empty()) {
+			return;
+		}
+
+		commands.SetBufferData(*m_InstanceBuffer, &m_Models[0][0][0], m_Models.size() * 16);
+		commands.BindShader(*m_InstancedShader);
+		commands.SetUniformMatrix4(UNIFORM_VIEW_PROJ, m_ViewProj);
+		commands.BindVertexArray(*m_VertexArray);
+
+		for (int texture = 0; texture < m_TexturesCount; ++texture) {
+			unsigned int first = GetGroupFirst(texture);
+			unsigned int count = GetGroupFirst(texture + 1) - first;
+			if (0 == count) {
+				continue;
+			}
+
+			commands.BindTexture(*m_Textures[texture]);
+			commands.BindInstanceBuffer(*m_VertexArray, *m_InstanceBuffer, m_InstanceLayout, INSTANCE_ATTRIBUTE, first * sizeof(glm::mat4));
+			commands.DrawIndexed(*m_IndexBuffer, 0, 0, count);
+		}
+
+		m_DrawCalls += commands.GetDrawsCount();
+		m_TextureBinds += commands.GetTextureBindsCount();
+	}
+
+	bool SceneStress::RecordBatched(CommandList& commands)
+	{
+		const unsigned int floatsPerObject = m_Mesh.GetVertexCount() * MeshData::VERTEX_SIZE;
+		if (m_Models.size() * floatsPerObject > MAX_SNAPSHOT_BATCH_FLOATS) {
+			return false;
+		}
+
+		commands.BindShader(*m_Shader);
+		commands.SetUniformMatrix4(UNIFORM_MVP, m_ViewProj);
+		commands.BindVertexArray(*m_BatchVertexArray);
+
+		for (int texture = 0; texture < m_TexturesCount; ++texture) {
+			commands.BindTexture(*m_Textures[texture]);
+			const unsigned int groupEnd = GetGroupFirst(texture + 1);
+			for (unsigned int first = GetGroupFirst(texture); first < groupEnd; first += m_ObjectsPerBatch) {
+				const unsigned int objects = std::min(m_ObjectsPerBatch, groupEnd - first);
+				TransformBatch(first, objects);
+				commands.SetBufferData(*m_BatchVertexBuffer, m_BatchVertices.data(), (size_t)objects * floatsPerObject);
+				commands.DrawIndexed(*m_BatchIndexBuffer, objects * m_Mesh.GetIndexCount());
+			}
+		}
+
+		m_DrawCalls += commands.GetDrawsCount();
+		m_TextureBinds += commands.GetTextureBindsCount();
+		return true;
+	}
+
+	bool SceneStress::OnSnapshot(FrameSnapshot& snapshot, float alpha)
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+
+		InterpolateTransforms(alpha);
+
+		m_ViewProj = m_Proj * m_View;
+		m_DrawCalls = 0;
+		m_TextureBinds = 0;
+
+		/* The render thread can only replay commands, each strategy records the same draws it would issue */
+		std::vector<CommandList>& lists = snapshot.GetCommandLists();
+		if (NAIVE != m_Strategy && COMMAND_LISTS != m_Strategy) {
+			lists.resize(1);
+			lists[0].Reset();
+		}
+		switch (m_Strategy) {
+		case INSTANCED:
+			RecordInstanced(lists[0]);
+			break;
+		case BATCHED:
+			if (!RecordBatched(lists[0])) {
+				/* Too many vertices to copy, drawn on the main thread */
+				lists[0].Reset();
+				return false;
+			}
+			break;
+		case MULTI_DRAW_INDIRECT:
+			/* Indirect draws are not recorded, drawn on the main thread unless they fall back to instancing */
+			if (m_IndirectBuffer) {
+				return false;
+			}
+			RecordInstanced(lists[0]);
+			break;
+		default:
+			RecordCommandLists(lists);
+			break;
+		}
+		snapshot.SetClearMask(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		/* The GPU time is not measured, the context belongs to the render thread meanwhile */
+		auto end = std::chrono::high_resolution_clock::now();
+		m_SnapshotMilliseconds = std::chrono::duration<float, std::milli>(end - start).count();
+		m_SnapshotRecorded = true;
+		return true;
+	}
+
+	void SceneStress::OnImGuiRender()
+	{
+		/* Once per frame, a snapshot may be recorded again after the interface changed something */
+		if (m_SnapshotRecorded) {
+			m_CPUHistory[m_HistoryOffset] = m_SnapshotMilliseconds;
+			m_GPUHistory[m_HistoryOffset] = 0.0f;
+			m_HistoryOffset = (m_HistoryOffset + 1) % HISTORY_SIZE;
+			m_SnapshotRecorded = false;
+		}
+
+		ImGui::Begin("Scene Stress Test");
+		/* The power curve gives as much of the slider to the first thousand objects as to the rest */
+		if (ImGui::SliderFloat("Objects", &m_ObjectsSlider, 1.0f, (float)MAX_OBJECTS, "%.0f", 5.0f)) {
+			m_ObjectsCount = std::max(1, (int)m_ObjectsSlider);
+			CreateObjects();
+		}
+		bool meshChanged = ImGui::Combo("Mesh", &m_Shape, MeshGenerator::SHAPE_NAMES, MeshGenerator::SHAPES_COUNT);
+		meshChanged |= ImGui::SliderInt("Tessellation", &m_Tessellation, 1, 16);
+		if (meshChanged) {
+			CreateMesh();
+		}
+		ImGui::SliderInt("Textures", &m_TexturesCount, 1, MAX_TEXTURES);
+		ImGui::Combo("Draw strategy", &m_Strategy, STRATEGY_NAMES, STRATEGIES_COUNT);
+		if (MULTI_DRAW_INDIRECT == m_Strategy && !IndirectBuffer::IsSupported()) {
+			ImGui::Text("ARB_multi_draw_indirect not supported, drawing instanced");
+		}
+		ImGui::Checkbox("Animate", &m_Animate);
+		if (ImGui::SliderInt("Threads", &m_ThreadsCount, 1, (int)JobSystem::Get().GetThreadsCount())) {
+			JobSystem::Get().SetActiveThreads((unsigned int)m_ThreadsCount);
+		}
+		if (ImGui::Button("Measure threads scaling")) {
+			MeasureScaling();
+		}
+		ImGui::TextUnformatted(m_ScalingReport.c_str());
+		ImGui::Text("%d objects, %u triangles each", m_ObjectsCount, m_Mesh.GetIndexCount() / 3);
+		ImGui::Text("%u draw calls, %u texture binds", m_DrawCalls, m_TextureBinds);
+		ImGui::Text("Transforms update %.3f ms", m_UpdateMilliseconds);
+		if (COMMAND_LISTS == m_Strategy || m_SnapshotMilliseconds > 0.0f) {
+			ImGui::Text("%u command lists, %.2f MB, recorded in %.3f ms", (unsigned int)m_CommandLists.size(),
+				m_CommandListsSize / (1024.0f * 1024.0f), m_RecordMilliseconds);
+		}
+
+		/* Both graphs share the scale, so that they can be compared at a glance */
+		float maxMilliseconds = 1.0f;
+		for (int i = 0; i < HISTORY_SIZE; ++i) {
+			maxMilliseconds = std::max(maxMilliseconds, std::max(m_CPUHistory[i], m_GPUHistory[i]));
+		}
+		const int last = (m_HistoryOffset + HISTORY_SIZE - 1) % HISTORY_SIZE;
+		char overlay[32];
+		snprintf(overlay, sizeof(overlay), "CPU %.3f ms", m_CPUHistory[last]);
+		ImGui::PlotLines("CPU", m_CPUHistory, HISTORY_SIZE, m_HistoryOffset, overlay, 0.0f, maxMilliseconds, ImVec2(0.0f, 80.0f));
+		snprintf(overlay, sizeof(overlay), "GPU %.3f ms", m_GPUHistory[last]);
+		ImGui::PlotLines("GPU", m_GPUHistory, HISTORY_SIZE, m_HistoryOffset, overlay, 0.0f, maxMilliseconds, ImVec2(0.0f, 80.0f));
+
+		ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+		ImGui::End();
+	}
+
+}
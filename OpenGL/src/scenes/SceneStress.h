@@ -0,0 +1,158 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "Scene.h"
+#include "GPUTimer.h"
+#include "Texture.h"
+#include "IndirectBuffer.h"
+#include "JobSystem.h"
+#include "CommandList.h"
+#include "RenderThread.h"
+#include "primitives/MeshGenerator.h"
+
+namespace scene {
+
+	/*
+		Puts real load on the renderer: up to a million spinning objects drawn with one of several strategies,
+		so the CPU and GPU cost of each draw path can be compared side by side on the same frame.
+	*/
+	class SceneStress : public AbstractScene
+	{
+	public:
+		static constexpr const char* name = "Stress Test";
+
+		enum Strategy {
+			NAIVE,
+			INSTANCED,
+			BATCHED,
+			MULTI_DRAW_INDIRECT,
+			COMMAND_LISTS,
+			STRATEGIES_COUNT
+		};
+
+		static constexpr const char* STRATEGY_NAMES[STRATEGIES_COUNT] = { "Naive, one draw per object", "Instanced", "Batched on the CPU", "Multi-draw indirect",
+			"Command lists, one draw per object recorded in parallel" };
+
+		SceneStress(int windowWidth, int windowHeight);
+		~SceneStress();
+
+		std::string GetName() const override;
+
+		void OnUpdate(float deltaTime) override;
+		void OnRender(float alpha) override;
+		bool OnSnapshot(FrameSnapshot& snapshot, float alpha) override;
+		void OnImGuiRender() override;
+
+	private:
+		static constexpr int MAX_OBJECTS = 1000000;
+		static constexpr int OBJECTS_DEFAULT = 1000;
+		/* Objects are split in contiguous groups, one per texture, each group is a texture bind */
+		static constexpr int MAX_TEXTURES = 3;
+		static constexpr float OBJECTS_SPACING = 2.0f;
+		/* Vertices transformed on the CPU before each batched draw */
+		static constexpr unsigned int BATCH_VERTICES = 64 * 1024;
+		/* Model matrix columns start at this location in the instanced shader */
+		static constexpr GLuint INSTANCE_ATTRIBUTE = 3;
+		static constexpr int HISTORY_SIZE = 240;
+		/* Smaller ranges cost more in scheduling than they save */
+		static constexpr unsigned int MIN_OBJECTS_PER_JOB = 256;
+		static constexpr unsigned int SCALING_ITERATIONS = 10;
+		/* A few lists per thread, so that the fast threads can steal the recording of the slow ones */
+		static constexpr unsigned int COMMAND_LISTS_PER_THREAD = 4;
+		/* A snapshot keeps a copy of all the batched vertices, past this many floats the batches are drawn on the main thread */
+		static constexpr size_t MAX_SNAPSHOT_BATCH_FLOATS = 16 * 1024 * 1024;
+
+		void CreateMesh();
+		void CreateObjects();
+		void CreateCommands();
+		void UpdateTransforms(float time);
+		/* Transforms alpha of the way from the previous update to the last one, if they are not there already */
+		void InterpolateTransforms(float alpha);
+		void UploadTransforms();
+		/* Times the transforms update with 1 to all the job system threads */
+		void MeasureScaling();
+
+		void DrawNaive();
+		void DrawInstanced();
+		void DrawBatched();
+		/* Fills m_BatchVertices with the objects [first, first + objects) in world space */
+		void TransformBatch(unsigned int first, unsigned int objects);
+		void DrawMultiDrawIndirect();
+		void DrawCommandLists();
+		/* One draw per object like the naive path, lists filled in parallel */
+		void RecordCommandLists(std::vector<CommandList>& lists);
+		/* Same draws as DrawInstanced and DrawBatched, the transforms or the vertices are copied in the list */
+		void RecordInstanced(CommandList& commands);
+		bool RecordBatched(CommandList& commands);
+
+		/* First object using the texture, texture == m_TexturesCount gives the objects count */
+		unsigned int GetGroupFirst(int texture) const;
+		void BindTexture(int texture);
+
+		const float m_ASPECT_RATIO;
+
+		MeshData m_Mesh;
+		VertexBufferLayout m_Layout;
+		VertexBufferLayout m_InstanceLayout;
+		std::unique_ptr<VertexBuffer> m_VertexBuffer;
+		std::unique_ptr<IndexBuffer> m_IndexBuffer;
+		std::unique_ptr<VertexBuffer> m_InstanceBuffer;
+		std::unique_ptr<VertexArray> m_VertexArray;
+
+		/* Many copies of the mesh at once, already in world space */
+		std::vector<float> m_BatchVertices;
+		unsigned int m_ObjectsPerBatch;
+		std::unique_ptr<VertexBuffer> m_BatchVertexBuffer;
+		std::unique_ptr<IndexBuffer> m_BatchIndexBuffer;
+		std::unique_ptr<VertexArray> m_BatchVertexArray;
+
+		std::vector<DrawElementsIndirectCommand> m_Commands;
+		std::unique_ptr<IndirectBuffer> m_IndirectBuffer;
+
+		/* Replayed in order, list i holds the draws of the i-th slice of the objects */
+		std::vector<CommandList> m_CommandLists;
+		size_t m_CommandListsSize;
+		float m_RecordMilliseconds;
+		/* Set when recording for the render thread, the frame time is the update plus the recording */
+		float m_SnapshotMilliseconds;
+		bool m_SnapshotRecorded;
+
+		std::unique_ptr<Shader> m_Shader;
+		std::unique_ptr<Shader> m_InstancedShader;
+		std::vector<std::unique_ptr<Texture>> m_Textures;
+
+		std::vector<glm::vec3> m_Positions;
+		std::vector<glm::vec3> m_Axes;
+		std::vector<float> m_Speeds;
+		std::vector<glm::mat4> m_Models;
+
+		GPUTimer m_GPUTimer;
+		float m_CPUHistory[HISTORY_SIZE];
+		float m_GPUHistory[HISTORY_SIZE];
+		int m_HistoryOffset;
+		float m_UpdateMilliseconds;
+		int m_ThreadsCount;
+		std::string m_ScalingReport;
+
+		/* Simulated time of the last two updates, and the one m_Models were computed at */
+		float m_Time;
+		float m_PreviousTime;
+		float m_TransformsTime;
+		float m_ObjectsSlider;
+		int m_ObjectsCount;
+		int m_Shape;
+		int m_Tessellation;
+		int m_TexturesCount;
+		int m_Strategy;
+		bool m_Animate;
+		unsigned int m_DrawCalls;
+		unsigned int m_TextureBinds;
+		int m_BoundTexture;
+
+		glm::mat4 m_View;
+		glm::mat4 m_Proj;
+		glm::mat4 m_ViewProj;
+	};
+
+}
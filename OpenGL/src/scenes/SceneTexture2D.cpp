@@ -89,7 +89,7 @@ namespace scene {
 
 	void SceneTexture2D::OnUpdate(float deltaTime) {}
 
-	void SceneTexture2D::OnRender()
+	void SceneTexture2D::OnRender(float alpha)
 	{
 		Renderer::Clear();
 		m_Shader->Use();
@@ -0,0 +1,164 @@
+#include "SceneVertexQuantization.h"
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <GLFW/glfw3.h>
+
+#include "glm/gtc/packing.hpp"
+#include "MeshOptimizer.h"
+#include "primitives/MeshGenerator.h"
+
+namespace scene {
+
+	SceneVertexQuantization::SceneVertexQuantization(int windowWidth, int windowHeight) :
+		m_ASPECT_RATIO((float)windowWidth / (float)windowHeight),
+		m_MaxPositionError(0.0f), m_MaxNormalErrorDegrees(0.0f),
+		m_CopiesPerSide(4), m_AlternateLayouts(true), m_UseQuantized(true), m_RenderQuantizedThisFrame(false)
+	{
+		/* MeshData has the interleaved layout expected by MeshQuantizer */
+		MeshData sphere = MeshGenerator::CreateUVSphere(SPHERE_RINGS, SPHERE_SEGMENTS);
+		std::vector<float>& vertices = sphere.vertices;
+		std::vector<unsigned int>& indices = sphere.indices;
+
+		/* Both layouts get the same optimized index order, so only the vertex format differs */
+		m_VertexCount = MeshOptimizer::Optimize(vertices.data(), (unsigned int)(vertices.size() / MeshQuantizer::SOURCE_VERTEX_SIZE),
+			MeshQuantizer::SOURCE_VERTEX_SIZE * sizeof(float), indices.data(), (unsigned int)indices.size());
+		vertices.resize(m_VertexCount * MeshQuantizer::SOURCE_VERTEX_SIZE);
+
+		QuantizedMesh quantized = MeshQuantizer::Quantize(vertices.data(), m_VertexCount, indices.data(), (unsigned int)indices.size());
+
+		/* Measure what we lost in the compression */
+		for (unsigned int i = 0; i < m_VertexCount; ++i) {
+			const float* source = &vertices[i * MeshQuantizer::SOURCE_VERTEX_SIZE];
+			const QuantizedVertex& vertex = quantized.vertices[i];
+
+			glm::vec3 position = quantized.transform.offset + quantized.transform.scale *
+				glm::vec3(glm::unpackSnorm1x16(vertex.position[0]), glm::unpackSnorm1x16(vertex.position[1]), glm::unpackSnorm1x16(vertex.position[2]));
+			m_MaxPositionError = std::max(m_MaxPositionError, glm::length(position - glm::vec3(source[0], source[1], source[2])));
+
+			glm::vec3 normal = MeshQuantizer::DecodeOctahedral(glm::vec2(glm::unpackSnorm1x16(vertex.normal[0]), glm::unpackSnorm1x16(vertex.normal[1])));
+			float cosAngle = std::clamp(glm::dot(normal, glm::vec3(source[3], source[4], source[5])), -1.0f, 1.0f);
+			m_MaxNormalErrorDegrees = std::max(m_MaxNormalErrorDegrees, glm::degrees(std::acos(cosAngle)));
+		}
+
+		/* Float layout: 32 bytes per vertex */
+		m_FloatVertexBuffer = std::make_unique<VertexBuffer>(vertices.data(), vertices.size() * sizeof(float));
+		m_FloatLayout.Push<float>(3);
+		m_FloatLayout.Push<float>(3);
+		m_FloatLayout.Push<float>(2);
+
+		/* Quantized layout: 16 bytes per vertex */
+		m_QuantizedVertexBuffer = std::make_unique<VertexBuffer>(quantized.vertices.data(), quantized.vertices.size() * sizeof(QuantizedVertex));
+		m_QuantizedLayout = QuantizedVertex::Format::Layout();
+
+		/* Shared by both layouts, the cache attaches it to each VAO; no VAO must be bound while creating it */
+		m_VertexArrayCache = VertexArrayCache::Get();
+		VertexArray::Unbind();
+		m_IndexBuffer = std::make_unique<IndexBuffer>(indices.data(), (unsigned int)indices.size());
+
+		glm::vec3 objectColor(1.0f, 0.5f, 0.31f);
+		glm::vec3 ambientColor(0.1f, 0.2f, 0.2f);
+		glm::vec3 lightColor(1.0f, 1.0f, 1.0f);
+
+		m_FloatShader = std::make_unique<Shader>(VERTEX_POS_NORM_UMVP_SHADER_PATH, FRAGMENT_BASIC_LIGHTED_SHADER_PATH);
+		m_QuantizedShader = std::make_unique<Shader>(VERTEX_QUANTIZED_POS_NORM_UMVP_SHADER_PATH, FRAGMENT_BASIC_LIGHTED_SHADER_PATH);
+		for (Shader* shader : { m_FloatShader.get(), m_QuantizedShader.get() }) {
+			shader->Use();
+			shader->SetUniform3f(UNIFORM_OBJECT_COLOR, objectColor.r, objectColor.g, objectColor.b);
+			shader->SetUniform3f(UNIFORM_AMBIENT_COLOR, ambientColor.r, ambientColor.g, ambientColor.b);
+			shader->SetUniform3f(UNIFORM_LIGHT_COLOR, lightColor.r, lightColor.g, lightColor.b);
+			shader->SetUniform3f(UNIFORM_LIGHT_POSITION, 0.0f, 10.0f, 10.0f);
+			shader->SetUniform1f(UNIFORM_AMBIENT_STRENGHT, 0.8f);
+			shader->SetUniform1f(UNIFORM_DIFFUSE_STRENGHT, 1.0f);
+			shader->SetUniform1f(UNIFORM_SPECULAR_STRENGHT, 0.5f);
+			shader->SetUniform1f(UNIFORM_SPECULAR_SHININESS, 32.0f);
+		}
+		m_QuantizedShader->Use();
+		MeshQuantizer::SetDequantizationUniforms(*m_QuantizedShader, quantized.transform);
+
+		VertexArray::Unbind();
+		VertexBuffer::Unbind();
+		Shader::Unuse();
+
+		/* Enable depth testing */
+		GLCheckErrorCall(glEnable(GL_DEPTH_TEST));
+		/* Choose background color */
+		GLCheckErrorCall(glClearColor(0.1f, 0.2f, 0.2f, 1.0f));
+	}
+
+	SceneVertexQuantization::~SceneVertexQuantization()
+	{
+		GLCheckErrorCall(glDisable(GL_DEPTH_TEST));
+	}
+
+	std::string SceneVertexQuantization::GetName() const { return name; }
+
+	void SceneVertexQuantization::OnUpdate(float deltaTime) {}
+
+	void SceneVertexQuantization::OnRender(float alpha)
+	{
+		/* Alternating frame by frame gives both measures under the same load, updates may run any number of times per frame */
+		m_RenderQuantizedThisFrame = m_AlternateLayouts ? !m_RenderQuantizedThisFrame : m_UseQuantized;
+
+		GLCheckErrorCall(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
+
+		m_View = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -1.5f * m_CopiesPerSide));
+		m_Proj = glm::perspective<float>(glm::radians(45.0f), m_ASPECT_RATIO, 0.1f, 100.0f);
+
+		if (m_RenderQuantizedThisFrame) {
+			DrawCopies(m_QuantizedLayout, *m_QuantizedVertexBuffer, *m_QuantizedShader, m_QuantizedTimer);
+		} else {
+			DrawCopies(m_FloatLayout, *m_FloatVertexBuffer, *m_FloatShader, m_FloatTimer);
+		}
+	}
+
+	void SceneVertexQuantization::DrawCopies(const VertexBufferLayout& layout, const VertexBuffer& vb, Shader& shader, GPUTimer& timer)
+	{
+		const VertexArray& va = m_VertexArrayCache->Bind(layout, vb, m_IndexBuffer.get());
+
+		float rotation = (float)glfwGetTime() * glm::radians(20.0f);
+		float halfSide = 0.5f * (m_CopiesPerSide - 1);
+
+		shader.Use();
+		shader.SetUniformMatrix4fv(UNIFORM_VIEW, m_View);
+
+		timer.Begin();
+		for (int y = 0; y < m_CopiesPerSide; ++y) {
+			for (int x = 0; x < m_CopiesPerSide; ++x) {
+				m_Model = glm::translate(glm::mat4(1.0f), glm::vec3(x - halfSide, y - halfSide, 0.0f));
+				m_Model = glm::rotate(m_Model, rotation, glm::vec3(0.0f, 1.0f, 0.0f));
+				m_ModelView = m_View * m_Model;
+				m_MVP = m_Proj * m_ModelView;
+
+				shader.SetUniformMatrix4fv(UNIFORM_MODEL_VIEW, m_ModelView);
+				shader.SetUniformMatrix4fv(UNIFORM_MVP, m_MVP);
+				Renderer::Draw(va, *m_IndexBuffer, shader);
+			}
+		}
+		timer.End();
+	}
+
+	void SceneVertexQuantization::OnImGuiRender()
+	{
+		const float floatMB = m_VertexCount * 8 * sizeof(float) / (1024.0f * 1024.0f);
+		const float quantizedMB = m_VertexCount * sizeof(QuantizedVertex) / (1024.0f * 1024.0f);
+		const int copies = m_CopiesPerSide * m_CopiesPerSide;
+
+		ImGui::Begin("Scene Vertex Quantization");
+		ImGui::SliderInt("Spheres per side", &m_CopiesPerSide, 1, MAX_COPIES_PER_SIDE);
+		ImGui::Checkbox("Alternate layouts every frame", &m_AlternateLayouts);
+		if (!m_AlternateLayouts) {
+			ImGui::Checkbox("Use quantized vertices", &m_UseQuantized);
+		}
+		ImGui::Text("%u vertices per sphere, %d spheres", m_VertexCount, copies);
+		ImGui::Text("Float:     %2d B/vertex, %6.2f MB, GPU %.3f ms", (int)(8 * sizeof(float)), floatMB, m_FloatTimer.GetElapsedMilliseconds());
+		ImGui::Text("Quantized: %2d B/vertex, %6.2f MB, GPU %.3f ms", (int)sizeof(QuantizedVertex), quantizedMB, m_QuantizedTimer.GetElapsedMilliseconds());
+		ImGui::Text("Max position error %.2e, max normal error %.3f deg", m_MaxPositionError, m_MaxNormalErrorDegrees);
+		ImGui::Text("Cached VAOs %u (%s), hits %u, misses %u", m_VertexArrayCache->GetVertexArraysCount(),
+			m_VertexArrayCache->UsesAttribBinding() ? "attrib binding" : "attrib pointers", m_VertexArrayCache->GetHits(), m_VertexArrayCache->GetMisses());
+		ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+		ImGui::End();
+	}
+
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <memory>
+#include "Scene.h"
+#include "GPUTimer.h"
+#include "MeshQuantizer.h"
+#include "VertexArrayCache.h"
+
+namespace scene {
+
+	/* Compares the vertex fetch cost of the float layout against the quantized one */
+	class SceneVertexQuantization : public AbstractScene
+	{
+	public:
+		static constexpr const char* name = "Vertex Quantization";
+
+		SceneVertexQuantization(int windowWidth, int windowHeight);
+		~SceneVertexQuantization();
+
+		std::string GetName() const override;
+
+		void OnUpdate(float deltaTime) override;
+		void OnRender(float alpha) override;
+		void OnImGuiRender() override;
+
+	private:
+		static constexpr unsigned int SPHERE_RINGS = 256;
+		static constexpr unsigned int SPHERE_SEGMENTS = 512;
+		static constexpr int MAX_COPIES_PER_SIDE = 12;
+
+		void DrawCopies(const VertexBufferLayout& layout, const VertexBuffer& vb, Shader& shader, GPUTimer& timer);
+
+		const float m_ASPECT_RATIO;
+
+		std::shared_ptr<VertexArrayCache> m_VertexArrayCache;
+
+		VertexBufferLayout m_FloatLayout;
+		std::unique_ptr<VertexBuffer> m_FloatVertexBuffer;
+		std::unique_ptr<Shader> m_FloatShader;
+
+		VertexBufferLayout m_QuantizedLayout;
+		std::unique_ptr<VertexBuffer> m_QuantizedVertexBuffer;
+		std::unique_ptr<Shader> m_QuantizedShader;
+
+		std::unique_ptr<IndexBuffer> m_IndexBuffer;
+
+		GPUTimer m_FloatTimer;
+		GPUTimer m_QuantizedTimer;
+
+		unsigned int m_VertexCount;
+		float m_MaxPositionError;
+		float m_MaxNormalErrorDegrees;
+
+		int m_CopiesPerSide;
+		bool m_AlternateLayouts;
+		bool m_UseQuantized;
+		bool m_RenderQuantizedThisFrame;
+
+		glm::mat4 m_Model;
+		glm::mat4 m_View;
+		glm::mat4 m_Proj;
+		glm::mat4 m_ModelView;
+		glm::mat4 m_MVP;
+	};
+
+}
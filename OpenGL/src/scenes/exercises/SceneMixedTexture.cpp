@@ -63,7 +63,7 @@ namespace scene {
 
 	void SceneMixedTexture::OnUpdate(float deltaTime) {}
 
-	void SceneMixedTexture::OnRender()
+	void SceneMixedTexture::OnRender(float alpha)
 	{
 		Renderer::Clear();
 		m_Shader->SetUniform1f(UNIFORM_MIX_LAMBDA, m_MixLambda);
@@ -55,7 +55,7 @@ namespace scene {
 
 	void SceneTwoTriangles::OnUpdate(float deltaTime) {}
 
-	void SceneTwoTriangles::OnRender()
+	void SceneTwoTriangles::OnRender(float alpha)
 	{
 		Renderer::Clear();
 
@@ -72,6 +72,7 @@ namespace scene {
 		m_VAO2->Bind();
 		m_Shader2->Use();
 		GLCheckErrorCall(glDrawArrays(GL_TRIANGLES, 0, TRIANGLE_VERTICES));
+		Renderer::AddDrawCalls(2);
 	}
 
 	void SceneTwoTriangles::OnImGuiRender()